@@ -0,0 +1,259 @@
+/* Copyright IBM Corp. 2026 */
+
+/** @file
+ * Header-only C++17 wrapper for qclib.
+ *
+ * The data type of each attribute is known at compile time, so retrieving an
+ * attribute with the wrong getter is a compile error rather than a runtime
+ * error. Attribute reads are resolved into tokens once per layer (see
+ * qc_resolve()) and served by qc_read_int(), qc_read_float() and
+ * qc_read_string() afterwards. Example:
+ *
+ * \code
+ * qc::handle hdl;
+ *
+ * for (const qc::layer &layer : hdl)
+ *	if (auto ifls = layer.get<qc_num_ifl_total>())
+ *		std::cout << layer.get<qc_layer_name>().value_or("") << ": " << *ifls << "\n";
+ * \endcode
+ *
+ * Errors on opening a configuration are reported as exceptions of type
+ * qc::error. As tokens are cached in the handle, a handle must not be used
+ * by multiple threads concurrently.
+ */
+
+#ifndef QC_HPP
+#define QC_HPP
+
+#include <array>
+#include <cerrno>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+extern "C" {
+#include "query_capacity.h"
+#include "query_capacity_attrs.h"
+}
+
+namespace qc {
+
+/** Attribute traits: value type, name and scale of attribute \c Id */
+template <enum qc_attr_id Id> struct attr;
+
+#define QC_HPP_TYPE_INT		int
+#define QC_HPP_TYPE_FLOAT	float
+#define QC_HPP_TYPE_STRING	std::string_view
+#define QC_ATTR(ID, NAME, TYPE, SCALE, SRCS) \
+	template <> struct attr<ID> { \
+		using type = QC_HPP_TYPE_##TYPE; \
+		static constexpr std::string_view name = NAME; \
+		static constexpr int scale = SCALE; \
+	};
+QC_ATTRS
+#undef QC_ATTR
+#undef QC_HPP_TYPE_INT
+#undef QC_HPP_TYPE_FLOAT
+#undef QC_HPP_TYPE_STRING
+
+/** Value type of attribute \c Id, i.e. \c int, \c float or \c std::string_view */
+template <enum qc_attr_id Id> using attr_t = typename attr<Id>::type;
+
+/** Error opening or importing a configuration, carrying the return code of the C API */
+class error : public std::runtime_error {
+public:
+	error(const std::string &what, int rc) : std::runtime_error(what + ", rc=" + std::to_string(rc)), rc_(rc) {}
+	/** Return code of the failing C API function */
+	int rc() const noexcept { return rc_; }
+
+private:
+	int rc_;
+};
+
+class handle;
+
+/** A layer of a configuration. Only valid as long as the respective handle exists. */
+class layer {
+public:
+	layer(const handle *hdl, int index) : hdl_(hdl), index_(index) {}
+
+	/** Layer number, 0 being the CEC layer */
+	int index() const noexcept { return index_; }
+
+	/** Returns attribute \c Id, or \c std::nullopt if it is not set or does not exist in this layer */
+	template <enum qc_attr_id Id> std::optional<attr_t<Id>> get() const;
+
+	/** Layer type, see enum #qc_layer_types */
+	int type() const { return get<qc_layer_type_num>().value_or(0); }
+
+	/** Layer category, see enum #qc_layer_categories */
+	int category() const { return get<qc_layer_category_num>().value_or(0); }
+
+private:
+	const handle *hdl_;
+	int index_;
+};
+
+/** Owns a configuration handle, closing it on destruction */
+class handle {
+public:
+	/** Opens the configuration of the running system, see qc_open() */
+	handle() {
+		int rc;
+
+		hdl_ = qc_open(&rc);
+		if (!hdl_ || rc < 0)
+			throw error("qc_open() failed", rc);
+		init();
+	}
+
+	/** Opens a configuration from raw data, see qc_open_from_buffers() */
+	explicit handle(const struct qc_buffers &bufs) {
+		int rc;
+
+		hdl_ = qc_open_from_buffers(&bufs, &rc);
+		if (!hdl_ || rc < 0)
+			throw error("qc_open_from_buffers() failed", rc);
+		init();
+	}
+
+	/** Takes ownership of \p hdl as returned e.g. by qc_import_binary() or qc_import_json() */
+	explicit handle(void *hdl) : hdl_(hdl) {
+		if (!hdl_)
+			throw error("Invalid handle", -EINVAL);
+		init();
+	}
+
+	handle(const handle &) = delete;
+	handle &operator=(const handle &) = delete;
+	handle(handle &&other) noexcept
+		: hdl_(other.hdl_), num_layers_(other.num_layers_), tokens_(std::move(other.tokens_)) {
+		other.hdl_ = nullptr;
+		other.num_layers_ = 0;
+	}
+	handle &operator=(handle &&other) noexcept {
+		if (this != &other) {
+			close();
+			hdl_ = other.hdl_;
+			num_layers_ = other.num_layers_;
+			tokens_ = std::move(other.tokens_);
+			other.hdl_ = nullptr;
+			other.num_layers_ = 0;
+		}
+		return *this;
+	}
+	~handle() { close(); }
+
+	/** The handle for use with the C API */
+	void *get() const noexcept { return hdl_; }
+
+	/** Number of layers, see qc_get_num_layers() */
+	int num_layers() const noexcept { return num_layers_; }
+
+	/** Layer \p i, with 0 being the CEC layer */
+	qc::layer operator[](int i) const { return qc::layer(this, i); }
+
+	/** Topmost layer, i.e. the one the caller is running in */
+	qc::layer top() const { return qc::layer(this, num_layers_ - 1); }
+
+	/** Iterates over all layers, starting with the CEC layer */
+	class iterator {
+	public:
+		iterator(const handle *hdl, int i) : hdl_(hdl), i_(i) {}
+		qc::layer operator*() const { return qc::layer(hdl_, i_); }
+		iterator &operator++() { ++i_; return *this; }
+		bool operator!=(const iterator &other) const { return i_ != other.i_; }
+
+	private:
+		const handle *hdl_;
+		int i_;
+	};
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, num_layers_); }
+
+private:
+	friend class qc::layer;
+
+	// Token values that qc_resolve() never returns, as the topmost bits hold the type
+	static constexpr unsigned long long unresolved = ~0ULL;
+	static constexpr unsigned long long undefined = ~1ULL;
+
+	void init() {
+		int rc;
+
+		num_layers_ = qc_get_num_layers(hdl_, &rc);
+		if (rc < 0) {
+			close();
+			throw error("qc_get_num_layers() failed", rc);
+		}
+		tokens_.resize(num_layers_);
+		for (auto &t : tokens_)
+			t.fill(unresolved);
+	}
+
+	void close() noexcept {
+		if (hdl_)
+			qc_close(hdl_);
+		hdl_ = nullptr;
+	}
+
+	// Returns the token for attribute 'id' in layer 'i', resolving it on first use
+	unsigned long long token(int i, enum qc_attr_id id) const {
+		unsigned long long &t = tokens_[i][id];
+
+		if (t == unresolved && qc_resolve(hdl_, i, id, &t))
+			t = undefined;
+
+		return t;
+	}
+
+	void *hdl_;
+	int num_layers_ = 0;
+	mutable std::vector<std::array<unsigned long long, qc_secure + 1>> tokens_;
+};
+
+template <enum qc_attr_id Id> std::optional<attr_t<Id>> layer::get() const {
+	unsigned long long t;
+
+	if (index_ < 0 || index_ >= hdl_->num_layers() || (t = hdl_->token(index_, Id)) == handle::undefined)
+		return std::nullopt;
+	if constexpr (std::is_same_v<attr_t<Id>, int>) {
+		int val;
+
+		if (qc_read_int(hdl_->get(), t, &val) > 0)
+			return val;
+	} else if constexpr (std::is_same_v<attr_t<Id>, float>) {
+		float val;
+
+		if (qc_read_float(hdl_->get(), t, &val) > 0)
+			return val;
+	} else {
+		const char *val;
+
+		if (qc_read_string(hdl_->get(), t, &val) > 0)
+			return std::string_view(val);
+	}
+
+	return std::nullopt;
+}
+
+/** Returns attribute \c Id of layer \p l, see layer::get() */
+template <enum qc_attr_id Id> std::optional<attr_t<Id>> get(const layer &l) {
+	return l.get<Id>();
+}
+
+/** Returns attribute \c Id of layer \p l in its unit, e.g. in cores for capping values */
+template <enum qc_attr_id Id> std::optional<double> get_scaled(const layer &l) {
+	static_assert(!std::is_same_v<attr_t<Id>, std::string_view>, "String attributes have no scale");
+	if (auto val = l.get<Id>())
+		return static_cast<double>(*val) / attr<Id>::scale;
+
+	return std::nullopt;
+}
+
+} // namespace qc
+
+#endif
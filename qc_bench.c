@@ -0,0 +1,562 @@
+/* Copyright IBM Corp. 2026 */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "qc_tools.h"
+
+
+/* Output format: A comment line starting with '#', followed by one line per
+   measurement of the form "<dump>\t<metric>\t<value>". Metrics ending in '_ns'
+   are latencies, metrics ending in '_ps' are latencies per call of functions too
+   fast to time individually, metrics ending in '_per_s' are throughputs, and all
+   others are counts per iteration. Lines are
+   only ever added, hence results of different builds can be compared with
+   option '-c'. */
+#define BENCH_FORMAT		1
+#define BENCH_MAX_LINE		256
+#define BENCH_NOISE_NS		1000	// latency changes below are never flagged
+#define BENCH_NOISE_PS		1000	// dto. for per-call latencies in picoseconds
+#define BENCH_BATCH		100	// calls per sample of the getter benchmarks
+
+static const char *phase_names[QC_PHASE_NUM] = {
+	"open", "sysinfo_open", "sysinfo_process", "sysinfo_dump", "sysinfo_close",
+	"hypfs_open", "hypfs_process", "hypfs_dump", "hypfs_close",
+	"sthyi_open", "sthyi_process", "sthyi_dump", "sthyi_close",
+	"sysfs_open", "sysfs_process", "sysfs_dump", "sysfs_close",
+	"lgm_check", "post_processing", "consistency_check"
+};
+
+enum bench_steps {
+	STEP_OPEN,
+	STEP_READ,
+	STEP_CLOSE,
+	STEP_TOTAL,
+	STEP_NUM
+};
+
+static const char *step_names[STEP_NUM] = {"open", "read", "close", "total"};
+
+static const char *type_names[] = {
+	[QC_ATTR_TYPE_INT] = "int", [QC_ATTR_TYPE_FLOAT] = "float", [QC_ATTR_TYPE_STRING] = "string"
+};
+
+// Positions of the attributes measured by the getter benchmarks
+enum bench_positions {
+	POS_FIRST,	// first attribute of a type that is set in the layer
+	POS_LAST,	// last attribute of a type that is set in the layer
+	POS_UNDEF,	// attribute of a type that does not exist in the layer
+	POS_NUM
+};
+
+static const char *pos_names[POS_NUM] = {"first", "last", "undef"};
+
+// Reads every attribute of every layer, as e.g. zname --all does. Returns the number of values found.
+static int read_attrs(void *hdl, const int *types) {
+	int layers, layer, id, rc, found = 0, ival;
+	const char *sval;
+	float fval;
+
+	layers = qc_get_num_layers(hdl, &rc);
+	for (layer = 0; layer < layers; ++layer) {
+		for (id = 0; id <= qc_secure; ++id) {
+			switch (types[id]) {
+			case QC_ATTR_TYPE_INT:
+				rc = qc_get_attribute_int(hdl, id, layer, &ival);
+				break;
+			case QC_ATTR_TYPE_FLOAT:
+				rc = qc_get_attribute_float(hdl, id, layer, &fval);
+				break;
+			default:
+				rc = qc_get_attribute_string(hdl, id, layer, &sval);
+			}
+			if (rc > 0)
+				found++;
+		}
+	}
+
+	return found;
+}
+
+// Returns the time of BENCH_BATCH calls of the getter for attribute 'id' of type 'type' in
+// 'layer', i.e. the latency per call in picoseconds
+static unsigned long long time_getter(void *hdl, int type, int id, int layer) {
+	unsigned long long start;
+	const char *sval;
+	int i, ival;
+	float fval;
+
+	start = now();
+	for (i = 0; i < BENCH_BATCH; ++i) {
+		switch (type) {
+		case QC_ATTR_TYPE_INT:
+			qc_get_attribute_int(hdl, id, layer, &ival);
+			break;
+		case QC_ATTR_TYPE_FLOAT:
+			qc_get_attribute_float(hdl, id, layer, &fval);
+			break;
+		default:
+			qc_get_attribute_string(hdl, id, layer, &sval);
+		}
+	}
+
+	return (now() - start) * 1000 / BENCH_BATCH;
+}
+
+// Same as time_getter(), but for qc_get_num_layers()
+static unsigned long long time_num_layers(void *hdl) {
+	unsigned long long start;
+	int i, rc;
+
+	start = now();
+	for (i = 0; i < BENCH_BATCH; ++i)
+		qc_get_num_layers(hdl, &rc);
+
+	return (now() - start) * 1000 / BENCH_BATCH;
+}
+
+// Returns the time of a single qc_export_json_ex() into 'buf', which is the same as qc_export_json()
+// without the I/O
+static unsigned long long time_export_json(void *hdl, char *buf, size_t size) {
+	struct qc_json_target target;
+	unsigned long long start;
+
+	memset(&target, 0, sizeof(target));
+	target.type = QC_JSON_TARGET_BUFFER;
+	target.buf = buf;
+	target.size = size;
+	start = now();
+	qc_export_json_ex(hdl, &target, 0);
+
+	return now() - start;
+}
+
+// Finds the attributes of type 'type' to measure in 'layer' as indexed by enum bench_positions, or -1 if n/a
+static void find_positions(void *hdl, int layer, int type, const int *types, int *pos) {
+	int ids[qc_secure + 1], ltypes[qc_secure + 1], present[qc_secure + 1];
+	int i, n;
+
+	memset(present, 0, sizeof(present));
+	for (i = 0; i < POS_NUM; ++i)
+		pos[i] = -1;
+	n = qc_get_layer_attrs(hdl, layer, (enum qc_attr_id *)ids, ltypes, qc_secure + 1);
+	for (i = 0; i < n && i <= qc_secure; ++i) {
+		present[ids[i]] = 1;
+		if ((ltypes[i] & ~QC_ATTR_SET) != type || !(ltypes[i] & QC_ATTR_SET))
+			continue;
+		if (pos[POS_FIRST] < 0)
+			pos[POS_FIRST] = ids[i];
+		pos[POS_LAST] = ids[i];
+	}
+	for (i = 0; i <= qc_secure && pos[POS_UNDEF] < 0; ++i)
+		if (types[i] == type && !present[i])
+			pos[POS_UNDEF] = i;
+}
+
+/* Benchmarks the getters for the handle of dump directory 'dir' with QC_DEBUG set to 'debug',
+   writing the latencies per call to 'out'. Measures the first and the top layer, and the
+   attributes as indexed by enum bench_positions, since lookups are linear in both.
+   Returns 0 on success. */
+static int bench_getters(FILE *out, const char *dump, struct qc_buffers *b, const int *types,
+			 int iterations, int warmup, int debug) {
+	int i, l, t, p, rc = 1, layers[2], pos[POS_NUM];
+	const char *prefix = debug ? "debug." : "";
+	unsigned long long *samples;
+	struct qc_json_target target;
+	char *json = NULL;
+	void *hdl = NULL;
+
+	if ((samples = calloc(iterations, sizeof(unsigned long long))) == NULL)
+		return 1;
+	// the log file is set up in qc_open_from_buffers(), and closed in qc_close() once QC_DEBUG is 0
+	setenv("QC_DEBUG_FILE", "/dev/null", 1);
+	setenv("QC_DEBUG", debug ? "1" : "0", 1);
+	hdl = qc_open_from_buffers(b, &rc);
+	if (!hdl || rc) {
+		fprintf(stderr, "Error: qc_open_from_buffers() failed for '%s', rc=%d\n", dump, rc);
+		rc = 1;
+		goto out;
+	}
+	layers[0] = 0;
+	layers[1] = qc_get_num_layers(hdl, &rc) - 1;
+	for (l = 0; l < 2; ++l) {
+		for (t = QC_ATTR_TYPE_INT; t <= QC_ATTR_TYPE_STRING; ++t) {
+			find_positions(hdl, layers[l], t, types, pos);
+			for (p = 0; p < POS_NUM; ++p) {
+				if (pos[p] < 0)
+					continue;
+				for (i = -warmup; i < iterations; ++i)
+					samples[i < 0 ? 0 : i] = time_getter(hdl, t, pos[p], layers[l]);
+				fprintf(out, "%s\t%sgetter.%s.%s.%s.p50_ps\t%llu\n", dump, prefix, type_names[t],
+					l ? "top" : "bottom", pos_names[p], percentile(samples, iterations, 500));
+			}
+		}
+	}
+	for (i = -warmup; i < iterations; ++i)
+		samples[i < 0 ? 0 : i] = time_num_layers(hdl);
+	fprintf(out, "%s\t%snum_layers.p50_ps\t%llu\n", dump, prefix, percentile(samples, iterations, 500));
+
+	memset(&target, 0, sizeof(target));
+	target.type = QC_JSON_TARGET_BUFFER;
+	if (qc_export_json_ex(hdl, &target, 0) != -ENOSPC || (json = malloc(target.len + 1)) == NULL) {
+		fprintf(stderr, "Error: Failed to determine JSON size for '%s'\n", dump);
+		rc = 1;
+		goto out;
+	}
+	for (i = -warmup; i < iterations; ++i)
+		samples[i < 0 ? 0 : i] = time_export_json(hdl, json, target.len + 1);
+	fprintf(out, "%s\t%sexport_json.p50_ns\t%llu\n", dump, prefix, percentile(samples, iterations, 500));
+	fprintf(out, "%s\t%sexport_json.p99_ns\t%llu\n", dump, prefix, percentile(samples, iterations, 990));
+	rc = 0;
+
+out:
+	setenv("QC_DEBUG", "0", 1);
+	qc_close(hdl);
+	unsetenv("QC_DEBUG");
+	unsetenv("QC_DEBUG_FILE");
+	free(json);
+	free(samples);
+
+	return rc;
+}
+
+/* Benchmarks qc_import_json() on the JSON export of the handle for 'b', writing the latencies and the
+   throughput in attributes per second at the median latency to 'out'. Returns 0 on success. */
+static int bench_import_json(FILE *out, const char *dump, struct qc_buffers *b, int iterations, int warmup) {
+	int ids[qc_secure + 1], types[qc_secure + 1];
+	int i, j, n, layers, rc = 1, attrs = 0;
+	unsigned long long *samples, start;
+	struct qc_json_target target;
+	void *hdl, *hdl2;
+	char *json = NULL;
+
+	if ((samples = calloc(iterations, sizeof(unsigned long long))) == NULL)
+		return 1;
+	hdl = qc_open_from_buffers(b, &rc);
+	if (!hdl || rc) {
+		fprintf(stderr, "Error: qc_open_from_buffers() failed for '%s', rc=%d\n", dump, rc);
+		rc = 1;
+		goto out;
+	}
+	layers = qc_get_num_layers(hdl, &rc);
+	for (i = 0; i < layers; ++i) {
+		n = qc_get_layer_attrs(hdl, i, (enum qc_attr_id *)ids, types, qc_secure + 1);
+		for (j = 0; j < n && j <= qc_secure; ++j)
+			attrs += (types[j] & QC_ATTR_SET) != 0;
+	}
+	memset(&target, 0, sizeof(target));
+	target.type = QC_JSON_TARGET_BUFFER;
+	if (qc_export_json_ex(hdl, &target, 0) != -ENOSPC || (json = malloc(target.len + 1)) == NULL) {
+		fprintf(stderr, "Error: Failed to determine JSON size for '%s'\n", dump);
+		rc = 1;
+		goto out;
+	}
+	target.buf = json;
+	target.size = target.len + 1;
+	if (qc_export_json_ex(hdl, &target, 0)) {
+		fprintf(stderr, "Error: Failed to export JSON for '%s'\n", dump);
+		rc = 1;
+		goto out;
+	}
+	for (i = -warmup; i < iterations; ++i) {
+		start = now();
+		hdl2 = qc_import_json(json, target.len, &rc);
+		samples[i < 0 ? 0 : i] = now() - start;
+		qc_close(hdl2);
+		if (!hdl2 || rc) {
+			fprintf(stderr, "Error: qc_import_json() failed for '%s', rc=%d\n", dump, rc);
+			rc = 1;
+			goto out;
+		}
+	}
+	fprintf(out, "%s\tjson_import.p50_ns\t%llu\n", dump, percentile(samples, iterations, 500));
+	fprintf(out, "%s\tjson_import.p99_ns\t%llu\n", dump, percentile(samples, iterations, 990));
+	fprintf(out, "%s\tjson_import.attrs\t%d\n", dump, attrs);
+	fprintf(out, "%s\tjson_import.attrs_per_s\t%llu\n", dump,
+		attrs * 1000000000ULL / (percentile(samples, iterations, 500) ? : 1));
+	rc = 0;
+
+out:
+	qc_close(hdl);
+	free(json);
+	free(samples);
+
+	return rc;
+}
+
+// Prints the I/O statistics in 'sum' per iteration
+static void print_counts(FILE *out, const char *dump, const char *step, const struct qc_stats *sum,
+			 int iterations) {
+	fprintf(out, "%s\t%s.allocations\t%llu\n", dump, step, sum->allocations / iterations);
+	fprintf(out, "%s\t%s.syscalls\t%llu\n", dump, step, sum->syscalls / iterations);
+	fprintf(out, "%s\t%s.bytes_read\t%llu\n", dump, step, sum->bytes_read / iterations);
+}
+
+// Benchmarks dump directory 'dir', writing the results to 'out'. Returns 0 on success.
+static int bench_dump(FILE *out, const char *dir, int iterations, int warmup, int getters) {
+	unsigned long long *samples[STEP_NUM], *phases[QC_PHASE_NUM], t[STEP_NUM + 1];
+	struct qc_stats stats, g[STEP_NUM + 1], sum[STEP_NUM];
+	int i, j, rc = 1, types[qc_secure + 1], layers = 0;
+	struct qc_attr_info info;
+	const char *dump;
+	struct qc_buffers b;
+	void *hdl;
+
+	if ((dump = strrchr(dir, '/')) != NULL && dump[1])
+		dump++;
+	else
+		dump = dir;
+	if (read_buffers(dir, &b))
+		return 1;
+	for (i = 0; i <= qc_secure; ++i)
+		types[i] = qc_attr_get_info(i, &info) ? -1 : info.type;
+	memset(samples, 0, sizeof(samples));
+	memset(phases, 0, sizeof(phases));
+	memset(sum, 0, sizeof(sum));
+	for (i = 0; i < STEP_NUM; ++i)
+		if ((samples[i] = calloc(iterations, sizeof(unsigned long long))) == NULL)
+			goto out;
+	for (i = 0; i < QC_PHASE_NUM; ++i)
+		if ((phases[i] = calloc(iterations, sizeof(unsigned long long))) == NULL)
+			goto out;
+
+	for (i = -warmup; i < iterations; ++i) {
+		qc_get_global_stats(&g[STEP_OPEN]);
+		t[STEP_OPEN] = now();
+		hdl = qc_open_from_buffers(&b, &rc);
+		t[STEP_READ] = now();
+		if (!hdl || rc) {
+			fprintf(stderr, "Error: qc_open_from_buffers() failed for '%s', rc=%d\n", dir, rc);
+			rc = 1;
+			goto out;
+		}
+		qc_get_global_stats(&g[STEP_READ]);
+		read_attrs(hdl, types);
+		t[STEP_CLOSE] = now();
+		qc_get_global_stats(&g[STEP_CLOSE]);
+		if (qc_get_stats(hdl, &stats))
+			memset(&stats, 0, sizeof(stats));
+		layers = qc_get_num_layers(hdl, &rc);
+		qc_close(hdl);
+		t[STEP_TOTAL] = now();
+		qc_get_global_stats(&g[STEP_TOTAL]);
+		if (i < 0)
+			continue;
+		for (j = STEP_OPEN; j < STEP_TOTAL; ++j) {
+			samples[j][i] = t[j + 1] - t[j];
+			sum[j].allocations += g[j + 1].allocations - g[j].allocations;
+			sum[j].syscalls += g[j + 1].syscalls - g[j].syscalls;
+			sum[j].bytes_read += g[j + 1].bytes_read - g[j].bytes_read;
+		}
+		samples[STEP_TOTAL][i] = t[STEP_TOTAL] - t[STEP_OPEN];
+		for (j = 0; j < QC_PHASE_NUM; ++j)
+			phases[j][i] = stats.phase_count[j] ? stats.phase_ns[j] : ~0ULL;
+	}
+
+	fprintf(out, "%s\tlayers\t%d\n", dump, layers);
+	for (i = 0; i < STEP_NUM; ++i) {
+		fprintf(out, "%s\t%s.p50_ns\t%llu\n", dump, step_names[i], percentile(samples[i], iterations, 500));
+		fprintf(out, "%s\t%s.p99_ns\t%llu\n", dump, step_names[i], percentile(samples[i], iterations, 990));
+		if (i < STEP_TOTAL)
+			print_counts(out, dump, step_names[i], &sum[i], iterations);
+	}
+	for (i = 0; i < QC_PHASE_NUM; ++i) {
+		// phases that did not run are sorted to the end and skipped
+		if (percentile(phases[i], iterations, 500) == ~0ULL)
+			continue;
+		fprintf(out, "%s\tphase.%s.p50_ns\t%llu\n", dump, phase_names[i], percentile(phases[i], iterations, 500));
+		fprintf(out, "%s\tphase.%s.p99_ns\t%llu\n", dump, phase_names[i], percentile(phases[i], iterations, 990));
+	}
+	if (bench_import_json(out, dump, &b, iterations, warmup))
+		goto out;
+	// with QC_DEBUG, calls are two orders of magnitude slower, hence use fewer samples
+	if (getters && (bench_getters(out, dump, &b, types, iterations, warmup, 0) ||
+			bench_getters(out, dump, &b, types, (iterations + 9) / 10, warmup / 10, 1)))
+		goto out;
+	rc = 0;
+
+out:
+	for (i = 0; i < STEP_NUM; ++i)
+		free(samples[i]);
+	for (i = 0; i < QC_PHASE_NUM; ++i)
+		free(phases[i]);
+	free_buffers(&b);
+
+	return rc;
+}
+
+struct result {
+	char	*key;		// "<dump>\t<metric>"
+	unsigned long long val;
+};
+
+// Reads result file 'path' into 'res'. Returns the number of results, or <0 on error.
+static int read_results(const char *path, struct result **res) {
+	char line[BENCH_MAX_LINE], *tab;
+	struct result *r = NULL, *tmp;
+	int n = 0;
+	FILE *f;
+
+	*res = NULL;
+	if ((f = fopen(path, "r")) == NULL) {
+		fprintf(stderr, "Error: Failed to open '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f)) {
+		if (line[0] == '#' || (tab = strrchr(line, '\t')) == NULL || tab == strchr(line, '\t'))
+			continue;
+		if ((tmp = realloc(r, (n + 1) * sizeof(*r))) == NULL)
+			break;
+		r = tmp;
+		*tab = '\0';
+		r[n].val = strtoull(tab + 1, NULL, 10);
+		if ((r[n].key = strdup(line)) == NULL)
+			break;
+		n++;
+	}
+	fclose(f);
+	*res = r;
+
+	return n;
+}
+
+static void free_results(struct result *res, int n) {
+	int i;
+
+	for (i = 0; i < n; ++i)
+		free(res[i].key);
+	free(res);
+}
+
+/* Compares the results in 'new_path' against 'old_path'. Latencies regress if they
+   grew by more than 'threshold' percent and BENCH_NOISE_NS, counts regress if they
+   grew at all.
+   Returns the number of regressions, or <0 on error. */
+static int compare(const char *old_path, const char *new_path, int threshold) {
+	struct result *old, *new;
+	int n_old, n_new, i, j, rate, regressions = 0;
+	unsigned long long noise;
+	const char *flag, *unit;
+	double delta;
+
+	if ((n_old = read_results(old_path, &old)) < 0)
+		return -1;
+	if ((n_new = read_results(new_path, &new)) < 0) {
+		free_results(old, n_old);
+		return -1;
+	}
+	printf("%-60s %12s %12s %8s\n", "# dump/metric", "old", "new", "delta");
+	for (i = 0; i < n_new; ++i) {
+		for (j = 0; j < n_old && strcmp(old[j].key, new[i].key); ++j);
+		if (j == n_old)
+			continue;
+		delta = old[j].val ? 100.0 * ((double)new[i].val - old[j].val) / old[j].val : 0;
+		unit = strlen(new[i].key) > 3 ? new[i].key + strlen(new[i].key) - 3 : "";
+		noise = !strcmp(unit, "_ns") ? BENCH_NOISE_NS : (!strcmp(unit, "_ps") ? BENCH_NOISE_PS : 0);
+		rate = strlen(new[i].key) > 6 && !strcmp(new[i].key + strlen(new[i].key) - 6, "_per_s");
+		flag = "";
+		if ((rate && -delta > threshold) ||
+		    (noise && delta > threshold && new[i].val > old[j].val && new[i].val - old[j].val > noise) ||
+		    (!noise && !rate && new[i].val > old[j].val)) {
+			flag = "  REGRESSION";
+			regressions++;
+		}
+		*strchr(new[i].key, '\t') = '/';
+		printf("%-60s %12llu %12llu %+7.1f%%%s\n", new[i].key, old[j].val, new[i].val, delta, flag);
+	}
+	printf("# %d regression(s), latency threshold %d%%\n", regressions, threshold);
+	free_results(old, n_old);
+	free_results(new, n_new);
+
+	return regressions;
+}
+
+static void print_help() {
+	printf("\n");
+	printf("Usage: qc_bench [-h] [-g] [-n <num>] [-w <num>] [-o <file>] <dump>...\n");
+	printf("       qc_bench -c <old> [-t <pct>] <new>\n");
+	printf("\n");
+	printf("Measure qc_open_from_buffers(), reading all attributes and qc_close() on each of the\n");
+	printf("specified dump directories, and report latencies and I/O statistics per phase.\n");
+	printf("Also measure qc_import_json() on the JSON export of each dump.\n");
+	printf("\n");
+	printf("  -c, --compare    Compare results in file <new> against <old>, and exit with\n");
+	printf("                   return code 2 if there are regressions.\n");
+	printf("  -g, --getters    Also measure the latency per call of the attribute getters,\n");
+	printf("                   qc_get_num_layers() and qc_export_json(), with QC_DEBUG off\n");
+	printf("                   and on. Uses 10%% of the iterations with QC_DEBUG on.\n");
+	printf("  -h, --help       Print usage information and exit\n");
+	printf("  -n, --iterations Number of measured iterations per dump. Defaults to 1000.\n");
+	printf("  -o, --output     Write results to <file> instead of stdout.\n");
+	printf("  -t, --threshold  Flag latencies that grew by more than <pct> percent.\n");
+	printf("                   Defaults to 10.\n");
+	printf("  -w, --warmup     Number of iterations per dump before measuring. Defaults to\n");
+	printf("                   10%% of the measured iterations.\n");
+	printf("\n");
+}
+
+int main(int argc, char **argv) {
+	static struct option long_options[] = {
+		{ "compare",    required_argument, NULL, 'c'},
+		{ "getters",    no_argument,       NULL, 'g'},
+		{ "help",       no_argument,       NULL, 'h'},
+		{ "iterations", required_argument, NULL, 'n'},
+		{ "output",     required_argument, NULL, 'o'},
+		{ "threshold",  required_argument, NULL, 't'},
+		{ "warmup",     required_argument, NULL, 'w'},
+		{ 0,            0,                 0,    0  }
+	};
+	int i, c, iterations = 1000, warmup = -1, threshold = 10, getters = 0, rc = 0;
+	const char *output = NULL, *old = NULL;
+	FILE *out = stdout;
+
+	while ((c = getopt_long(argc, argv, "c:ghn:o:t:w:", long_options, NULL)) != EOF) {
+		switch (c) {
+		case 'c': old = optarg;
+			  break;
+		case 'g': getters = 1;
+			  break;
+		case 'h': print_help();
+			  return 0;
+		case 'n': iterations = atoi(optarg);
+			  break;
+		case 'o': output = optarg;
+			  break;
+		case 't': threshold = atoi(optarg);
+			  break;
+		case 'w': warmup = atoi(optarg);
+			  break;
+		default:  print_help();
+			  return 1;
+		}
+	}
+	if (optind >= argc || iterations <= 0 || (old && optind + 1 != argc)) {
+		print_help();
+		return 1;
+	}
+	if (old) {
+		rc = compare(old, argv[optind], threshold);
+		return rc < 0 ? 1 : (rc > 0 ? 2 : 0);
+	}
+	if (warmup < 0)
+		warmup = iterations / 10;
+	if (output && (out = fopen(output, "w")) == NULL) {
+		fprintf(stderr, "Error: Failed to open '%s': %s\n", output, strerror(errno));
+		return 1;
+	}
+	fprintf(out, "# qc_bench format %d, %d iterations, %d warmup\n", BENCH_FORMAT, iterations, warmup);
+	for (i = optind; i < argc; ++i)
+		if (bench_dump(out, argv[i], iterations, warmup, getters))
+			rc = 1;
+	if (out != stdout)
+		fclose(out);
+
+	return rc;
+}
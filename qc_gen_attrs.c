@@ -0,0 +1,116 @@
+/* Copyright IBM Corp. 2026 */
+
+/*
+ * Generates a collision-free ("perfect") hash for the attribute names in
+ * query_capacity_attrs.h, as well as for the names of the respective
+ * values in enum qc_attr_id, using the hash-and-displace scheme:
+ * Names are distributed into buckets by a first hash, then each bucket
+ * gets a displacement, i.e. a seed for a second hash that maps all of its
+ * names to yet unused slots. A lookup thus takes two hashes and one
+ * string comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "query_capacity_int.h"
+#include "query_capacity_attrs.h"
+
+#define NUM_BUCKETS	64
+#define NUM_SLOTS	256
+#define MAX_DISP	255
+
+static const struct {
+	const char	*name;
+	int		 id;
+} names[] = {
+#define QC_ATTR(id, name, type, scale, srcs)	{name, id}, {#id, id},
+	QC_ATTRS
+#undef QC_ATTR
+};
+#define NUM_NAMES	(int)(sizeof(names) / sizeof(names[0]))
+
+static int bucket_size(int *bucket, int b) {
+	int i, n = 0;
+
+	for (i = 0; i < NUM_NAMES; ++i)
+		n += (bucket[i] == b);
+
+	return n;
+}
+
+// Finds displacements for all buckets with seed 'seed', largest buckets first
+static int try_seed(unsigned int seed, unsigned char *disp, short *slots) {
+	int bucket[NUM_NAMES], done[NUM_BUCKETS] = {0};
+	int i, j, b, max, slot[NUM_NAMES];
+	unsigned int d;
+
+	for (i = 0; i < NUM_SLOTS; ++i)
+		slots[i] = -1;
+	for (i = 0; i < NUM_NAMES; ++i)
+		bucket[i] = qc_attr_hash(names[i].name, strlen(names[i].name), seed) % NUM_BUCKETS;
+	for (j = 0; j < NUM_BUCKETS; ++j) {
+		for (b = -1, max = -1, i = 0; i < NUM_BUCKETS; ++i) {
+			if (!done[i] && bucket_size(bucket, i) > max) {
+				max = bucket_size(bucket, i);
+				b = i;
+			}
+		}
+		done[b] = 1;
+		for (d = 1; d <= MAX_DISP; ++d) {
+			for (i = 0; i < NUM_NAMES; ++i) {
+				if (bucket[i] != b)
+					continue;
+				slot[i] = qc_attr_hash(names[i].name, strlen(names[i].name), d) % NUM_SLOTS;
+				if (slots[slot[i]] >= 0)
+					break;
+				slots[slot[i]] = i;
+			}
+			if (i == NUM_NAMES)
+				break;
+			// collision: release the slots taken by this bucket so far
+			while (--i >= 0)
+				if (bucket[i] == b && slots[slot[i]] == i)
+					slots[slot[i]] = -1;
+		}
+		if (d > MAX_DISP)
+			return -1;
+		disp[b] = d;
+	}
+
+	return 0;
+}
+
+int main(void) {
+	unsigned char disp[NUM_BUCKETS];
+	short slots[NUM_SLOTS];
+	unsigned int seed;
+	int i;
+
+	for (i = 0; i < NUM_NAMES / 2; ++i) {
+		if (names[2 * i].id != i) {
+			fprintf(stderr, "Error: Metadata for attribute %d missing or out of order\n", i);
+			return 1;
+		}
+	}
+	for (seed = 0; seed < 1000 && try_seed(seed, disp, slots); ++seed);
+	if (seed == 1000) {
+		fprintf(stderr, "Error: Failed to generate attribute name hash\n");
+		return 1;
+	}
+	printf("/* Generated by qc_gen_attrs from query_capacity_attrs.h, do not edit */\n\n");
+	printf("#define QC_ATTR_HASH_SEED\t%u\n", seed);
+	printf("#define QC_ATTR_HASH_BUCKETS\t%d\n", NUM_BUCKETS);
+	printf("#define QC_ATTR_HASH_SLOTS\t%d\n\n", NUM_SLOTS);
+	printf("static const unsigned char qc_attr_hash_disp[QC_ATTR_HASH_BUCKETS] = {");
+	for (i = 0; i < NUM_BUCKETS; ++i)
+		printf("%s%3d,", i % 16 ? " " : "\n\t", disp[i]);
+	printf("\n};\n\n");
+	printf("static const short qc_attr_hash_slots[QC_ATTR_HASH_SLOTS] = {");
+	for (i = 0; i < NUM_SLOTS; ++i)
+		printf("%s%3d,", i % 16 ? " " : "\n\t", slots[i] < 0 ? -1 : names[slots[i]].id);
+	printf("\n};\n");
+
+	return 0;
+}
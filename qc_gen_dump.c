@@ -0,0 +1,604 @@
+/* Copyright IBM Corp. 2026 */
+
+/*
+ * Generates a synthetic dump directory as read by qclib with QC_USE_DUMP or
+ * qc_open_from_buffers(), covering sysinfo, s390_hypfs (diag_204 and
+ * diag_2fc), STHYI, and sysfs. The topology is parameterized, so we can
+ * create the worst cases that real systems would rarely provide, e.g.
+ * 85 LPARs with 200 cores each, thousands of z/VM guests, or deeply
+ * nested virtualization stacks. All data is generated to be consistent,
+ * so the result passes qclib's consistency checks.
+ */
+
+#include <endian.h>
+#include <errno.h>
+#include <iconv.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "query_capacity_hypfs.h"
+/* we are packing the structures in the header file generated by VM */
+#pragma pack(push)
+#pragma pack(1)
+#include "hcpinfbk_qclib.h"
+#pragma pack(pop)
+
+#define GEN_MAX_LPARS		85
+#define GEN_MAX_CORES		200
+#define GEN_MAX_LEVELS		99	// limited by the two digits in VMxx
+#define GEN_MAX_NAME		QC_NAME_LEN
+#define GEN_STHYI_SIZE		4096
+#define GEN_CEC_NAME		"GENCEC"
+#define GEN_CPU_TYPE_OTHER	9	// e.g. ICF, not reported by qclib
+#define GEN_NUM_CP		10
+#define GEN_NUM_ZIIP		6
+#define GEN_NUM_OTHER		4
+
+enum gen_hv_type {
+	GEN_ZVM = infytvm,
+	GEN_KVM = infytkvm,
+	GEN_ZCX = infytzcx,
+};
+
+struct gen_level {
+	int	type;				// hypervisor type, GEN_*
+	char	host[GEN_MAX_NAME + 1];		// system identifier of the hypervisor
+	char	name[GEN_MAX_NAME + 1];		// name of the guest
+	int	cpus;				// number of virtual CPUs of the guest
+};
+
+struct gen_topo {
+	int	lpars;
+	int	tgt;				// index of our LPAR
+	int	cores;				// cores of our LPAR
+	int	cpu_type;			// type of the cores of our LPAR
+	int	phys_cp, phys_ifl;		// counts in the physical section
+	const char *group;
+	const char *pool;
+	int	guests;				// additional z/VM guests in diag_2fc
+	unsigned int seed;
+	int	num_levels;
+	struct gen_level levels[GEN_MAX_LEVELS];	// bottom-up, levels[0] runs in the LPAR
+};
+
+static iconv_t cd = (iconv_t)-1;
+
+static void usage(void) {
+	printf("Usage: qc_gen_dump [-h] [-l <lpars>] [-c <cores>] [-g <group>] [-v <levels>]\n");
+	printf("                   [-n <guests>] [-p <pool>] [-s <seed>] <dir>\n");
+	printf("Generates a consistent dump for qclib in directory <dir>.\n");
+	printf("  -c  Number of cores of the LPAR, default: 8, max: %d\n", GEN_MAX_CORES);
+	printf("  -g  Name of the LPAR group to place the LPAR in\n");
+	printf("  -h  Print this help\n");
+	printf("  -l  Number of LPARs on the CEC, default: 10, max: %d\n", GEN_MAX_LPARS);
+	printf("  -n  Number of further z/VM guests in diag_2fc, default: 10\n");
+	printf("  -p  Name of the z/VM resource pool or z/OS tenant resource group of the\n");
+	printf("      topmost guest covered by STHYI\n");
+	printf("  -s  Seed for the generated data, default: 1\n");
+	printf("  -v  Comma-separated list of hypervisors 'zvm', 'kvm' and 'zcx' running in\n");
+	printf("      the LPAR, bottom-up. Default: None, i.e. dump of the LPAR itself\n");
+}
+
+// Converts 'str' into EBCDIC, padded with blanks to 'len' bytes
+static int gen_ebcdic(unsigned char *tgt, const char *str, size_t len) {
+	char buf[32], *in = buf, *out = (char *)tgt;
+	size_t insz = len, outsz = len;
+
+	if (len >= sizeof(buf))
+		return -1;
+	snprintf(buf, sizeof(buf), "%-*s", (int)len, str ? str : "");
+	if (iconv(cd, &in, &insz, &out, &outsz) == (size_t)-1) {
+		fprintf(stderr, "Error: iconv conversion of '%s' failed: %s\n", str, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int gen_mkdir(const char *dir, const char *sub) {
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", dir, sub);
+	if (mkdir(path, 0755) && errno != EEXIST) {
+		fprintf(stderr, "Error: Failed to create directory '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int gen_write(const char *dir, const char *file, const void *data, size_t len) {
+	char path[PATH_MAX];
+	FILE *fp;
+	int rc = 0;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, file);
+	fp = fopen(path, "w");
+	if (!fp) {
+		fprintf(stderr, "Error: Failed to open '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (len && fwrite(data, len, 1, fp) != 1) {
+		fprintf(stderr, "Error: Failed to write '%s'\n", path);
+		rc = -1;
+	}
+	if (fclose(fp)) {
+		fprintf(stderr, "Error: Failed to close '%s': %s\n", path, strerror(errno));
+		rc = -1;
+	}
+
+	return rc;
+}
+
+static int gen_has_type(struct gen_topo *t, int type) {
+	int i;
+
+	for (i = 0; i < t->num_levels; ++i)
+		if (t->levels[i].type == type)
+			return 1;
+
+	return 0;
+}
+
+static int gen_phys_total(struct gen_topo *t) {
+	return t->phys_cp + t->phys_ifl + GEN_NUM_ZIIP + GEN_NUM_OTHER;
+}
+
+static int gen_phys_type(struct gen_topo *t, int i) {
+	if (i < t->phys_cp)
+		return QC_CPU_TYPE_CP;
+	if (i < t->phys_cp + t->phys_ifl)
+		return QC_CPU_TYPE_IFL;
+	if (i < t->phys_cp + t->phys_ifl + GEN_NUM_ZIIP)
+		return QC_CPU_TYPE_ZIIP;
+
+	return GEN_CPU_TYPE_OTHER;
+}
+
+static int gen_phys_count(struct gen_topo *t, int type, int dedicated) {
+	int i, n = 0;
+
+	for (i = 0; i < gen_phys_total(t); ++i)
+		if (gen_phys_type(t, i) == type && (i % 7 == 0) == dedicated)
+			n++;
+
+	return n;
+}
+
+static int gen_parse_levels(struct gen_topo *t, char *list) {
+	static const char *prefix[] = {[GEN_ZVM] = "LINUX", [GEN_KVM] = "KVMGST", [GEN_ZCX] = "ZCX"};
+	struct gen_level *l;
+	char *tok;
+	int cpus;
+
+	for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+		if (t->num_levels == GEN_MAX_LEVELS) {
+			fprintf(stderr, "Error: More than %d levels\n", GEN_MAX_LEVELS);
+			return -1;
+		}
+		l = &t->levels[t->num_levels];
+		if (!strcmp(tok, "zvm"))
+			l->type = GEN_ZVM;
+		else if (!strcmp(tok, "kvm"))
+			l->type = GEN_KVM;
+		else if (!strcmp(tok, "zcx"))
+			l->type = GEN_ZCX;
+		else {
+			fprintf(stderr, "Error: Unknown hypervisor '%s'\n", tok);
+			return -1;
+		}
+		// nested hypervisors are identified by the name of the guest they run in
+		if (t->num_levels)
+			strcpy(l->host, (l - 1)->name);
+		else
+			strcpy(l->host, l->type == GEN_ZCX ? "ZOSSYS" : l->type == GEN_KVM ? "KVMHOST" : "ZVMHOST");
+		snprintf(l->name, sizeof(l->name), "%s%02d", prefix[l->type], t->num_levels);
+		cpus = t->num_levels ? (l - 1)->cpus : t->cores;
+		l->cpus = cpus > 1 ? cpus / 2 : 1;
+		t->num_levels++;
+	}
+	if (gen_has_type(t, GEN_ZCX) && (t->num_levels > 1 || t->levels[0].type != GEN_ZCX)) {
+		fprintf(stderr, "Error: zCX is only supported as the sole level\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int gen_sysinfo(const char *dir, struct gen_topo *t) {
+	char path[PATH_MAX];
+	struct gen_level *l;
+	FILE *fp;
+	int i;
+
+	snprintf(path, sizeof(path), "%s/sysinfo", dir);
+	fp = fopen(path, "w");
+	if (!fp) {
+		fprintf(stderr, "Error: Failed to open '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+	fprintf(fp, "Manufacturer:         IBM\n"
+		    "Type:                 3906\n"
+		    "Model:                704              M04\n"
+		    "Sequence Code:        00000000000ABCDE\n"
+		    "Plant:                02\n"
+		    "Model Capacity:       704              00000456\n"
+		    "Model Perm. Capacity: 704              00000456\n"
+		    "Model Temp. Capacity: 704              00000456\n"
+		    "Nominal Cap. Rating:  00000456\n"
+		    "Nominal Perm. Rating: 00000456\n"
+		    "Nominal Temp. Rating: 00000456\n"
+		    "Capacity Adj. Ind.:   100\n"
+		    "Capacity Ch. Reason:  0\n"
+		    "Capacity Transient:   0\n\n");
+	fprintf(fp, "CPUs Total:           %d\n"
+		    "CPUs Configured:      %d\n"
+		    "CPUs Standby:         0\n"
+		    "CPUs Reserved:        0\n"
+		    "CPUs G-MTID:          0\n"
+		    "CPUs S-MTID:          1\n"
+		    "Capability:           456\n"
+		    "Secondary Capability: 400\n"
+		    "Nominal Capability:   456\n\n", gen_phys_total(t), gen_phys_total(t));
+	fprintf(fp, "LPAR Number:          %d\n"
+		    "LPAR Characteristics: Shared\n"
+		    "LPAR Name:            LP%03d\n"
+		    "LPAR Adjustment:      250\n"
+		    "LPAR CPUs Total:      %d\n"
+		    "LPAR CPUs Configured: %d\n"
+		    "LPAR CPUs Standby:    0\n"
+		    "LPAR CPUs Reserved:   0\n"
+		    "LPAR CPUs Dedicated:  0\n"
+		    "LPAR CPUs Shared:     %d\n"
+		    "LPAR CPUs G-MTID:     0\n"
+		    "LPAR CPUs S-MTID:     1\n"
+		    "LPAR CPUs PS-MTID:    1\n", t->tgt + 1, t->tgt, t->cores, t->cores, t->cores);
+	// VM00 is the topmost level
+	for (i = 0; i < t->num_levels; ++i) {
+		l = &t->levels[t->num_levels - 1 - i];
+		fprintf(fp, "\nVM%02d Name:            %s\n", i, l->name);
+		fprintf(fp, "VM%02d Control Program: %s\n", i,
+			l->type == GEN_ZVM ? "z/VM    7.3.0" : l->type == GEN_KVM ? "KVM/Linux" : "z/OS zCX    2.5");
+		fprintf(fp, "VM%02d Adjustment:      100\n", i);
+		fprintf(fp, "VM%02d CPUs Total:      %d\n", i, l->cpus);
+		fprintf(fp, "VM%02d CPUs Configured: %d\n", i, l->cpus);
+		fprintf(fp, "VM%02d CPUs Standby:    0\n", i);
+		fprintf(fp, "VM%02d CPUs Reserved:   0\n", i);
+		if (l->type == GEN_KVM) {
+			fprintf(fp, "VM%02d Extended Name:   %s-ext\n", i, l->name);
+			fprintf(fp, "VM%02d UUID:            5d2c9a3e-4b5f-4d8c-9a3e-%012x\n", i, i);
+		}
+	}
+	if (fclose(fp)) {
+		fprintf(stderr, "Error: Failed to close '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void gen_cpu(struct dfs_cpu_info *cpu, int addr, int type, int flags, int weight, unsigned int *seed) {
+	memset(cpu, 0, sizeof(*cpu));
+	cpu->cpu_addr = htobe16(addr);
+	cpu->ctidx = type;
+	cpu->cflag = flags;
+	cpu->weight = htobe16(weight);
+	cpu->acc_time = htobe64((__u64)rand_r(seed) << 8);
+	cpu->lp_time = htobe64((__u64)rand_r(seed) << 8);
+	cpu->online_time = htobe64((__u64)rand_r(seed) << 12);
+}
+
+static int gen_diag204(const char *dir, struct gen_topo *t) {
+	struct dfs_info_blk_hdr *info;
+	struct dfs_diag_hdr *hdr;
+	struct dfs_sys_hdr *sys;
+	struct dfs_cpu_info *cpu;
+	unsigned int seed = t->seed;
+	int i, j, grp, rc = -1;
+	char *buf, *p, name[16];
+	size_t len;
+
+	len = sizeof(*hdr) + sizeof(*info) + (t->lpars + 1) * sizeof(*sys) +
+	      (t->lpars * t->cores + gen_phys_total(t)) * sizeof(*cpu);
+	buf = calloc(1, len);
+	if (!buf) {
+		fprintf(stderr, "Error: Failed to allocate %zu bytes\n", len);
+		return -1;
+	}
+	hdr = (struct dfs_diag_hdr *)buf;
+	info = (struct dfs_info_blk_hdr *)(hdr + 1);
+	info->npar = t->lpars;
+	info->flags = QC_FLAG_PHYS;
+	p = (char *)(info + 1);
+	for (i = 0; i < t->lpars; ++i) {
+		sys = (struct dfs_sys_hdr *)p;
+		grp = t->group && (i == t->tgt || i % 3 == 0);
+		sys->cpus = sys->rcpus = t->cores;
+		snprintf(name, sizeof(name), "LP%03d", i);
+		if (gen_ebcdic((unsigned char *)sys->sys_name, name, sizeof(sys->sys_name)) ||
+		    (grp && gen_ebcdic((unsigned char *)sys->grp_name, t->group, sizeof(sys->grp_name))))
+			goto out;
+		if (i == t->tgt)
+			info->thispart = htobe16(p - (char *)info);
+		cpu = (struct dfs_cpu_info *)(sys + 1);
+		for (j = 0; j < t->cores; ++j, ++cpu) {
+			if (i == t->tgt)
+				gen_cpu(cpu, j, t->cpu_type, QC_CPU_CONFIGURED, 300, &seed);
+			else
+				gen_cpu(cpu, j, j % 2 ? QC_CPU_TYPE_IFL : QC_CPU_TYPE_CP,
+					QC_CPU_CONFIGURED | (rand_r(&seed) % 4 ? 0 : QC_CPU_CAPPED),
+					rand_r(&seed) % 8 ? 10 + rand_r(&seed) % 990 : QC_CPU_DEDICATED, &seed);
+			if (grp)
+				cpu->groupCpuTypeCap = htobe32(t->cores * 50);
+		}
+		p = (char *)cpu;
+	}
+	// physical section
+	sys = (struct dfs_sys_hdr *)p;
+	sys->cpus = gen_phys_total(t);
+	if (gen_ebcdic((unsigned char *)sys->sys_name, "PHYSICAL", sizeof(sys->sys_name)))
+		goto out;
+	cpu = (struct dfs_cpu_info *)(sys + 1);
+	for (j = 0; j < sys->cpus; ++j, ++cpu)
+		gen_cpu(cpu, j, gen_phys_type(t, j), 0, j % 7 == 0 ? QC_CPU_DEDICATED : 0, &seed);
+	len = (char *)cpu - buf;
+	hdr->len = htobe64(len - sizeof(*hdr));
+	hdr->version = htobe16(1);
+	rc = gen_write(dir, "s390_hypfs/diag_204", buf, len);
+out:
+	free(buf);
+
+	return rc;
+}
+
+static int gen_diag2fc(const char *dir, struct gen_topo *t) {
+	struct gen_level *me = &t->levels[t->num_levels - 1];
+	unsigned int seed = t->seed;
+	struct dfs_diag2fc *rec;
+	struct dfs_diag_hdr *hdr;
+	int i, count, rc = -1;
+	char name[16];
+	size_t len;
+
+	count = t->guests + 1;
+	len = sizeof(*hdr) + count * sizeof(*rec);
+	hdr = calloc(1, len);
+	if (!hdr) {
+		fprintf(stderr, "Error: Failed to allocate %zu bytes\n", len);
+		return -1;
+	}
+	hdr->len = htobe64(len - sizeof(*hdr));
+	hdr->version = htobe16(1);
+	hdr->count = htobe64(count);
+	// place our own guest in the middle, so lookups have to search
+	for (i = 0, rec = (struct dfs_diag2fc *)(hdr + 1); i < count; ++i, ++rec) {
+		rec->version = htobe32(1);
+		rec->pcpus = rec->lcpus = htobe32(t->cores);
+		if (i == count / 2) {
+			rec->vcpus = htobe32(me->cpus);
+			strcpy(name, me->name);
+		} else {
+			rec->flags = htobe32(rand_r(&seed) % 0xf);
+			rec->vcpus = htobe32(1 + rand_r(&seed) % 8);
+			snprintf(name, sizeof(name), "G%05d", i % 100000);
+		}
+		rec->ocpus = rec->vcpus;
+		if (gen_ebcdic((unsigned char *)rec->guest_name, name, sizeof(rec->guest_name)))
+			goto out;
+	}
+	rc = gen_write(dir, "s390_hypfs/diag_2fc", hdr, len);
+out:
+	free(hdr);
+
+	return rc;
+}
+
+// Returns the number of levels reported by STHYI, which stops at KVM
+static int gen_sthyi_levels(struct gen_topo *t) {
+	int n;
+
+	for (n = 0; n < t->num_levels && n < inf0ygmx && t->levels[n].type != GEN_KVM; ++n);
+
+	return n;
+}
+
+static int gen_sthyi(const char *dir, struct gen_topo *t) {
+	char buf[GEN_STHYI_SIZE];
+	struct inf0hdr *hdr = (struct inf0hdr *)buf;
+	int i, n, shared, ifl = t->cpu_type == QC_CPU_TYPE_IFL;
+	struct inf0hdyg *hyg;
+	struct inf0mac *mac;
+	struct inf0par *par;
+	struct inf0hyp *hyp;
+	struct inf0gst *gst;
+	struct gen_level *l;
+	char name[16];
+	short off;
+
+	memset(buf, 0, sizeof(buf));
+	n = gen_sthyi_levels(t);
+	hdr->infhflg1 = (n ? infsthyi : 0) | (t->num_levels > n ? infvsi : 0);
+	hdr->infhygct = n;
+	hdr->infhdln = htobe16(inf0hdsz);
+	hdr->infmoff = htobe16(inf0hdsz);
+	hdr->infmlen = htobe16(inf0msiz);
+	hdr->infpoff = htobe16(inf0hdsz + inf0msiz);
+	hdr->infplen = htobe16(inf0psiz);
+	off = inf0hdsz + inf0msiz + inf0psiz;
+
+	mac = (struct inf0mac *)(buf + inf0hdsz);
+	mac->infmval1 = infmproc | infmmid | infmmnam | infmziipv;
+	mac->infmscps = htobe16(gen_phys_count(t, QC_CPU_TYPE_CP, 0));
+	mac->infmdcps = htobe16(gen_phys_count(t, QC_CPU_TYPE_CP, 1));
+	mac->infmsifl = htobe16(gen_phys_count(t, QC_CPU_TYPE_IFL, 0));
+	mac->infmdifl = htobe16(gen_phys_count(t, QC_CPU_TYPE_IFL, 1));
+	mac->infmsziip = htobe16(gen_phys_count(t, QC_CPU_TYPE_ZIIP, 0));
+	mac->infmdziip = htobe16(gen_phys_count(t, QC_CPU_TYPE_ZIIP, 1));
+	if (gen_ebcdic(mac->infmname, GEN_CEC_NAME, sizeof(mac->infmname)) ||
+	    gen_ebcdic(mac->infmtype, "3906", sizeof(mac->infmtype)) ||
+	    gen_ebcdic(mac->infmmanu, "IBM", sizeof(mac->infmmanu)) ||
+	    gen_ebcdic(mac->infmseq, "00000000000ABCDE", sizeof(mac->infmseq)) ||
+	    gen_ebcdic(mac->infmpman, "02", sizeof(mac->infmpman)))
+		return -1;
+
+	// Note: The LPAR group is reported by diag_204 only, else we would end up with two group layers
+	par = (struct inf0par *)(buf + inf0hdsz + inf0msiz);
+	par->infpval1 = infpproc | infppid | infpziipv;
+	par->infppnum = htobe16(t->tgt + 1);
+	if (ifl)
+		par->infpsifl = htobe16(t->cores);
+	else
+		par->infpscps = htobe16(t->cores);
+	snprintf(name, sizeof(name), "LP%03d", t->tgt);
+	if (gen_ebcdic(par->infppnam, name, sizeof(par->infppnam)))
+		return -1;
+
+	// STHYI reports the bottommost levels only
+	for (i = 0; i < n; ++i, off += inf0ysiz + inf0gsiz) {
+		l = &t->levels[i];
+		hyg = (struct inf0hdyg *)&hdr->infhygs1 + i;
+		hyg->infyoff = htobe16(off);
+		hyg->infylen = htobe16(inf0ysiz);
+		hyg->infgoff = htobe16(off + inf0ysiz);
+		hyg->infglen = htobe16(inf0gsiz);
+
+		hyp = (struct inf0hyp *)(buf + off);
+		hyp->infyval1 = infyziipv;
+		hyp->infytype = l->type;
+		shared = i ? (l - 1)->cpus : t->cores;
+		if (ifl)
+			hyp->infysifl = htobe16(shared);
+		else
+			hyp->infyscps = htobe16(shared);
+		hyp->infyinsf.infyins0 = hyp->infyautf.infyaut0 = infyfccp | infyfhyp | infyfgls | infyfgst | infyfpls;
+		if (gen_ebcdic(hyp->infysyid, l->host, sizeof(hyp->infysyid)) ||
+		    gen_ebcdic(hyp->infyclnm, l->type == GEN_ZVM ? "CLUSTER1" : "", sizeof(hyp->infyclnm)))
+			return -1;
+
+		gst = (struct inf0gst *)(buf + off + inf0ysiz);
+		gst->infgval1 = infgziipv;
+		if (ifl) {
+			gst->infgsifl = htobe16(l->cpus);
+			gst->infgifdt = infgpucifl;
+		} else {
+			gst->infgscps = htobe16(l->cpus);
+			gst->infgcpdt = infgpuccp;
+		}
+		if (gen_ebcdic(gst->infgusid, l->name, sizeof(gst->infgusid)) ||
+		    gen_ebcdic(gst->infgpnam, i == n - 1 ? t->pool : NULL, sizeof(gst->infgpnam)))
+			return -1;
+		if (i == n - 1 && t->pool) {
+			gst->infgpflg = ifl ? infgpilh : infgpclh;
+			if (ifl)
+				gst->infgpicc = htobe32(l->cpus << 16);
+			else
+				gst->infgpccc = htobe32(l->cpus << 16);
+		}
+	}
+	hdr->infhtotl = htobe16(off);
+
+	return gen_write(dir, "sthyi", buf, sizeof(buf));
+}
+
+static int gen_sysfs(const char *dir) {
+	if (gen_mkdir(dir, "sys") || gen_mkdir(dir, "sys/firmware") ||
+	    gen_mkdir(dir, "sys/firmware/ocf") || gen_mkdir(dir, "sys/firmware/ipl"))
+		return -1;
+
+	return gen_write(dir, "sys/firmware/ocf/cpc_name", GEN_CEC_NAME "\n", strlen(GEN_CEC_NAME) + 1) ||
+	       gen_write(dir, "sys/firmware/ipl/has_secure", "1\n", 2) ||
+	       gen_write(dir, "sys/firmware/ipl/secure", "0\n", 2);
+}
+
+// Only the LPAR itself sees the full diag_204 data, and z/VM guests get diag_2fc
+// instead. KVM guests and zCX servers have no access to hypfs at all
+static int gen_hypfs(const char *dir, struct gen_topo *t) {
+	if (t->num_levels && t->levels[t->num_levels - 1].type != GEN_ZVM)
+		return 0;
+	if (gen_mkdir(dir, "s390_hypfs"))
+		return -1;
+	if (!t->num_levels)
+		return gen_diag204(dir, t);
+
+	// diag_204 indicates availability of hypfs only
+	return gen_write(dir, "s390_hypfs/diag_204", NULL, 0) || gen_diag2fc(dir, t);
+}
+
+int main(int argc, char **argv) {
+	struct gen_topo topo;
+	char *levels = NULL;
+	int opt, rc = 1;
+
+	memset(&topo, 0, sizeof(topo));
+	topo.lpars = 10;
+	topo.cores = 8;
+	topo.guests = 10;
+	topo.seed = 1;
+	while ((opt = getopt(argc, argv, "c:g:hl:n:p:s:v:")) != -1) {
+		switch (opt) {
+		case 'c': topo.cores = atoi(optarg); break;
+		case 'g': topo.group = optarg; break;
+		case 'h': usage(); return 0;
+		case 'l': topo.lpars = atoi(optarg); break;
+		case 'n': topo.guests = atoi(optarg); break;
+		case 'p': topo.pool = optarg; break;
+		case 's': topo.seed = strtoul(optarg, NULL, 10); break;
+		case 'v': levels = optarg; break;
+		default: usage(); return 1;
+		}
+	}
+	if (optind != argc - 1) {
+		usage();
+		return 1;
+	}
+	if (topo.lpars < 1 || topo.lpars > GEN_MAX_LPARS || topo.cores < 1 || topo.cores > GEN_MAX_CORES ||
+	    topo.guests < 0) {
+		fprintf(stderr, "Error: Parameter out of range\n");
+		return 1;
+	}
+	if ((topo.group && strlen(topo.group) > GEN_MAX_NAME) || (topo.pool && strlen(topo.pool) > GEN_MAX_NAME)) {
+		fprintf(stderr, "Error: Names are limited to %d characters\n", GEN_MAX_NAME);
+		return 1;
+	}
+	cd = iconv_open("IBM-1047", "ISO8859-1");
+	if (cd == (iconv_t)-1) {
+		fprintf(stderr, "Error: iconv setup failed: %s\n", strerror(errno));
+		return 1;
+	}
+	if (levels && gen_parse_levels(&topo, levels))
+		goto out;
+	if (topo.pool && !gen_sthyi_levels(&topo)) {
+		fprintf(stderr, "Error: Pools require a z/VM or zCX level in STHYI\n");
+		goto out;
+	}
+	// zCX runs on CPs in z/OS, everything else on IFLs
+	topo.cpu_type = gen_has_type(&topo, GEN_ZCX) ? QC_CPU_TYPE_CP : QC_CPU_TYPE_IFL;
+	// diag_204 reports the offset of our LPAR in 16 bits
+	topo.tgt = (0xffff - sizeof(struct dfs_info_blk_hdr)) /
+		   (sizeof(struct dfs_sys_hdr) + topo.cores * sizeof(struct dfs_cpu_info));
+	if (topo.tgt > topo.lpars / 2)
+		topo.tgt = topo.lpars / 2;
+	topo.phys_cp = GEN_NUM_CP;
+	topo.phys_ifl = 20;
+	if (topo.cpu_type == QC_CPU_TYPE_CP && topo.cores > topo.phys_cp)
+		topo.phys_cp = topo.cores;
+	if (topo.cpu_type == QC_CPU_TYPE_IFL && topo.cores > topo.phys_ifl)
+		topo.phys_ifl = topo.cores;
+
+	if (mkdir(argv[optind], 0755) && errno != EEXIST) {
+		fprintf(stderr, "Error: Failed to create directory '%s': %s\n", argv[optind], strerror(errno));
+		goto out;
+	}
+	if (gen_sysinfo(argv[optind], &topo) || gen_hypfs(argv[optind], &topo) ||
+	    gen_sthyi(argv[optind], &topo) || gen_sysfs(argv[optind]))
+		goto out;
+	rc = 0;
+out:
+	iconv_close(cd);
+
+	return rc;
+}
@@ -0,0 +1,241 @@
+/* Copyright IBM Corp. 2026 */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "qc_tools.h"
+
+
+/* Runs concurrent loops of qc_open() and qc_close() in multiple processes with
+   multiple threads each, as e.g. many containers on a single guest would.
+   Output format: A comment line starting with '#', followed by one line per
+   measurement of the form "<source>\t<metric>\t<value>", same as qc_bench, so
+   results can be compared with 'qc_bench -c'. */
+#define STRESS_FORMAT		2
+
+// Global statistics reported as the difference before and after the loops, see struct qc_stats
+static const struct {
+	const char	*name;
+	size_t		 offset;
+} counters[] = {
+	{"reads.syscalls",     offsetof(struct qc_stats, syscalls)},
+	{"reads.bytes",        offsetof(struct qc_stats, bytes_read)},
+	{"reads.diag",         offsetof(struct qc_stats, diag_reads)},
+	{"reads.diag_retries", offsetof(struct qc_stats, diag_retries)},
+};
+#define NUM_COUNTERS	(int)(sizeof(counters) / sizeof(counters[0]))
+
+// Results shared by all processes
+struct shared {
+	unsigned long long	counters[NUM_COUNTERS];
+	unsigned long long	errors;
+	unsigned long long	samples[];	// latency of each qc_open(), per process and thread
+};
+
+struct worker {
+	struct qc_buffers	*bufs;		// use qc_open_from_buffers() if set, qc_open() otherwise
+	unsigned long long	*samples;
+	int			 iterations;
+	unsigned long long	 errors;
+};
+
+static void *worker_loop(void *arg) {
+	struct worker *w = arg;
+	unsigned long long t;
+	void *hdl;
+	int i, rc;
+
+	for (i = 0; i < w->iterations; ++i) {
+		t = now();
+		hdl = w->bufs ? qc_open_from_buffers(w->bufs, &rc) : qc_open(&rc);
+		w->samples[i] = now() - t;
+		if (!hdl || rc)
+			w->errors++;
+		qc_close(hdl);
+	}
+
+	return NULL;
+}
+
+// Runs 'threads' workers in the current process, adding the results to 'shm'. Returns 0 on success.
+static int run_process(struct shared *shm, int proc, int threads, int iterations, struct qc_buffers *bufs) {
+	struct qc_stats before, after;
+	struct worker *w;
+	pthread_t *tids;
+	int i, rc = 0;
+
+	w = calloc(threads, sizeof(*w));
+	tids = calloc(threads, sizeof(*tids));
+	if (!w || !tids) {
+		fprintf(stderr, "Error: Failed to allocate workers\n");
+		free(w);
+		free(tids);
+		return 1;
+	}
+	qc_get_global_stats(&before);
+	for (i = 0; i < threads; ++i) {
+		w[i].bufs = bufs;
+		w[i].iterations = iterations;
+		w[i].samples = shm->samples + ((long)proc * threads + i) * iterations;
+		if (pthread_create(&tids[i], NULL, worker_loop, &w[i])) {
+			fprintf(stderr, "Error: Failed to create thread\n");
+			threads = i;
+			rc = 1;
+			break;
+		}
+	}
+	for (i = 0; i < threads; ++i) {
+		pthread_join(tids[i], NULL);
+		__atomic_add_fetch(&shm->errors, w[i].errors, __ATOMIC_RELAXED);
+	}
+	qc_get_global_stats(&after);
+	for (i = 0; i < NUM_COUNTERS; ++i)
+		__atomic_add_fetch(&shm->counters[i], *(unsigned long long *)((char *)&after + counters[i].offset) -
+				   *(unsigned long long *)((char *)&before + counters[i].offset), __ATOMIC_RELAXED);
+	free(w);
+	free(tids);
+
+	return rc;
+}
+
+static void print_help() {
+	printf("\n");
+	printf("Usage: qc_stress [-h] [-p <num>] [-t <num>] [-n <num>] [-d <delays>] [-o <file>] [<dump>]\n");
+	printf("\n");
+	printf("Run concurrent loops of qc_open() and qc_close() in multiple processes and\n");
+	printf("threads, and report throughput, latencies and the number of data source reads.\n");
+	printf("Uses qc_open_from_buffers() with dump directory <dump> if specified, and qc_open()\n");
+	printf("on live data (or as specified by QC_USE_DUMP) otherwise.\n");
+	printf("\n");
+	printf("  -d, --delay      Delay reading data sources, see QC_INJECT_DELAY, e.g.\n");
+	printf("                   'hypfs=5000,sthyi=2000' for delays in microseconds.\n");
+	printf("  -h, --help       Print usage information and exit\n");
+	printf("  -n, --iterations Number of qc_open() calls per thread. Defaults to 100.\n");
+	printf("  -o, --output     Write results to <file> instead of stdout.\n");
+	printf("  -p, --processes  Number of processes. Defaults to 1.\n");
+	printf("  -t, --threads    Number of threads per process. Defaults to 4.\n");
+	printf("\n");
+}
+
+int main(int argc, char **argv) {
+	static struct option long_options[] = {
+		{ "delay",      required_argument, NULL, 'd'},
+		{ "help",       no_argument,       NULL, 'h'},
+		{ "iterations", required_argument, NULL, 'n'},
+		{ "output",     required_argument, NULL, 'o'},
+		{ "processes",  required_argument, NULL, 'p'},
+		{ "threads",    required_argument, NULL, 't'},
+		{ 0,            0,                 0,    0  }
+	};
+	int i, c, status, procs = 1, threads = 4, iterations = 100, rc = 0;
+	const char *output = NULL, *src = "live";
+	struct qc_buffers bufs, *b = NULL;
+	unsigned long long start, wall;
+	struct shared *shm;
+	long total;
+	size_t size;
+	FILE *out;
+	pid_t pid;
+
+	while ((c = getopt_long(argc, argv, "d:hn:o:p:t:", long_options, NULL)) != EOF) {
+		switch (c) {
+		case 'd': setenv("QC_INJECT_DELAY", optarg, 1);
+			  break;
+		case 'h': print_help();
+			  return 0;
+		case 'n': iterations = atoi(optarg);
+			  break;
+		case 'o': output = optarg;
+			  break;
+		case 'p': procs = atoi(optarg);
+			  break;
+		case 't': threads = atoi(optarg);
+			  break;
+		default:  print_help();
+			  return 1;
+		}
+	}
+	if (optind + 1 < argc || procs <= 0 || threads <= 0 || iterations <= 0) {
+		print_help();
+		return 1;
+	}
+	if (optind < argc) {
+		if (read_buffers(argv[optind], &bufs))
+			return 1;
+		b = &bufs;
+		if ((src = strrchr(argv[optind], '/')) != NULL && src[1])
+			src++;
+		else
+			src = argv[optind];
+	}
+	total = (long)procs * threads * iterations;
+	size = sizeof(struct shared) + total * sizeof(unsigned long long);
+	shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shm == MAP_FAILED) {
+		fprintf(stderr, "Error: Failed to map %zu Bytes: %s\n", size, strerror(errno));
+		rc = 1;
+		goto out;
+	}
+
+	start = now();
+	for (i = 1; i < procs; ++i) {
+		if ((pid = fork()) == 0)
+			_exit(run_process(shm, i, threads, iterations, b));
+		if (pid < 0) {
+			fprintf(stderr, "Error: fork() failed: %s\n", strerror(errno));
+			rc = 1;
+			procs = i;
+			break;
+		}
+	}
+	if (run_process(shm, 0, threads, iterations, b))
+		rc = 1;
+	while (wait(&status) > 0) {
+		if (!WIFEXITED(status) || WEXITSTATUS(status))
+			rc = 1;
+	}
+	wall = now() - start;
+	if (rc)
+		goto out_unmap;
+
+	out = stdout;
+	if (output && (out = fopen(output, "w")) == NULL) {
+		fprintf(stderr, "Error: Failed to open '%s': %s\n", output, strerror(errno));
+		rc = 1;
+		goto out_unmap;
+	}
+	total = (long)procs * threads * iterations;
+	fprintf(out, "# qc_stress format %d, %d processes, %d threads, %d iterations\n", STRESS_FORMAT,
+		procs, threads, iterations);
+	fprintf(out, "%s\topens\t%ld\n", src, total);
+	fprintf(out, "%s\terrors\t%llu\n", src, shm->errors);
+	// inverse of the throughput, so that larger values are worse as with all other latencies
+	fprintf(out, "%s\topen.wall_per_op_ns\t%llu\n", src, wall / total);
+	fprintf(out, "%s\topen.p50_ns\t%llu\n", src, percentile(shm->samples, total, 500));
+	fprintf(out, "%s\topen.p99_ns\t%llu\n", src, percentile(shm->samples, total, 990));
+	fprintf(out, "%s\topen.p999_ns\t%llu\n", src, percentile(shm->samples, total, 999));
+	fprintf(out, "%s\topen.max_ns\t%llu\n", src, percentile(shm->samples, total, 1000));
+	for (i = 0; i < NUM_COUNTERS; ++i)
+		fprintf(out, "%s\t%s\t%llu\n", src, counters[i].name, shm->counters[i]);
+	if (out != stdout)
+		fclose(out);
+
+out_unmap:
+	munmap(shm, size);
+out:
+	if (b)
+		free_buffers(b);
+
+	return rc;
+}
@@ -4,12 +4,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
-#include "query_capacity.h"
+#include "qc_tools.h"
 
 
 int err_cnt = 0;
 int attr_indent = 34;
+struct qc_buffers *bufs = NULL;
 
 void print_break() {
 	printf("\n");
@@ -25,91 +30,12 @@ void print_header(int indent, int layer, const char* layer_name) {
 }
 
 const char *attr2char(enum qc_attr_id id) {
-	switch (id) {
-	case qc_layer_type: return "qc_layer_type";
-	case qc_layer_category: return "qc_layer_category";
-	case qc_layer_type_num: return "qc_layer_type_num";
-	case qc_layer_category_num: return "qc_layer_category_num";
-	case qc_layer_name: return "qc_layer_name";
-	case qc_layer_extended_name: return "qc_layer_extended_name";
-	case qc_layer_uuid: return "qc_layer_uuid";
-	case qc_manufacturer: return "qc_manufacturer";
-	case qc_type: return "qc_type";
-	case qc_model_capacity: return "qc_model_capacity";
-	case qc_model: return "qc_model";
-	case qc_type_name: return "qc_type_name";
-	case qc_type_family: return "qc_type_family";
-	case qc_sequence_code: return "qc_sequence_code";
-	case qc_lic_identifier: return "qc_lic_identifier";
-	case qc_plant: return "qc_plant";
-	case qc_num_cpu_total: return "qc_num_cpu_total";
-	case qc_num_cpu_configured: return "qc_num_cpu_configured";
-	case qc_num_cpu_standby: return "qc_num_cpu_standby";
-	case qc_num_cpu_reserved: return "qc_num_cpu_reserved";
-	case qc_num_cpu_dedicated: return "qc_num_cpu_dedicated";
-	case qc_num_cpu_shared: return "qc_num_cpu_shared";
-	case qc_num_cp_total: return "qc_num_cp_total";
-	case qc_num_cp_dedicated: return "qc_num_cp_dedicated";
-	case qc_num_cp_shared: return "qc_num_cp_shared";
-	case qc_num_ifl_total: return "qc_num_ifl_total";
-	case qc_num_ifl_dedicated: return "qc_num_ifl_dedicated";
-	case qc_num_ifl_shared: return "qc_num_ifl_shared";
-	case qc_capability: return "qc_capability";
-	case qc_secondary_capability: return "qc_secondary_capability";
-	case qc_capacity_adjustment_indication: return "qc_capacity_adjustment_indication";
-	case qc_capacity_change_reason: return "qc_capacity_change_reason";
-	case qc_partition_number: return "qc_partition_number";
-	case qc_partition_char: return "qc_partition_char";
-	case qc_partition_char_num: return "qc_partition_char_num";
-	case qc_adjustment: return "qc_adjustment";
-	case qc_cp_absolute_capping: return "qc_cp_absolute_capping";
-	case qc_ifl_absolute_capping: return "qc_ifl_absolute_capping";
-	case qc_cp_weight_capping: return "qc_cp_weight_capping";
-	case qc_ifl_weight_capping: return "qc_ifl_weight_capping";
-	case qc_cluster_name: return "qc_cluster_name";
-	case qc_control_program_id: return "qc_control_program_id";
-	case qc_limithard_consumption: return "qc_limithard_consumption";
-	case qc_prorated_core_time: return "qc_prorated_core_time";
-	case qc_cp_limithard_cap: return "qc_cp_limithard_cap";
-	case qc_cp_capacity_cap: return "qc_cp_capacity_cap";
-	case qc_ifl_limithard_cap: return "qc_ifl_limithard_cap";
-	case qc_ifl_capacity_cap: return "qc_ifl_capacity_cap";
-	case qc_capping: return "qc_capping";
-	case qc_capping_num: return "qc_capping_num";
-	case qc_mobility_enabled: return "qc_mobility_enabled";
-	case qc_has_secure: return "qc_has_secure";
-	case qc_secure: return "qc_secure";
-	case qc_has_multiple_cpu_types: return "qc_has_multiple_cpu_types";
-	case qc_cp_dispatch_limithard: return "qc_cp_dispatch_limithard";
-	case qc_ifl_dispatch_limithard: return "qc_ifl_dispatch_limithard";
-	case qc_cp_dispatch_type: return "qc_cp_dispatch_type";
-	case qc_ifl_dispatch_type: return "qc_ifl_dispatch_type";
-	case qc_cp_capped_capacity: return "qc_cp_capped_capacity";
-	case qc_ifl_capped_capacity: return "qc_ifl_capped_capacity";
-	case qc_num_cp_threads: return "qc_num_cp_threads";
-	case qc_num_ifl_threads: return "qc_num_ifl_threads";
-	case qc_num_core_total: return "qc_num_core_total";
-	case qc_num_core_configured: return "qc_num_core_configured";
-	case qc_num_core_standby: return "qc_num_core_standby";
-	case qc_num_core_reserved: return "qc_num_core_reserved";
-	case qc_num_core_dedicated: return "qc_num_core_dedicated";
-	case qc_num_core_shared: return "qc_num_core_shared";
-	case qc_ziip_absolute_capping: return "qc_ziip_absolute_capping";
-	case qc_ziip_capacity_cap: return "qc_ziip_capacity_cap";
-	case qc_ziip_capped_capacity: return "qc_ziip_capped_capacity";
-	case qc_ziip_dispatch_limithard: return "qc_ziip_dispatch_limithard";
-	case qc_ziip_dispatch_type: return "qc_ziip_dispatch_type";
-	case qc_ziip_limithard_cap: return "qc_ziip_limithard_cap";
-	case qc_ziip_weight_capping: return "qc_ziip_weight_capping";
-	case qc_num_ziip_dedicated: return "qc_num_ziip_dedicated";
-	case qc_num_ziip_shared: return "qc_num_ziip_shared";
-	case qc_num_ziip_total: return "qc_num_ziip_total";
-	case qc_num_ziip_threads: return "qc_num_ziip_threads";
-
-	default: break;
-	}
-
-	return NULL;
+	struct qc_attr_info info;
+
+	if (qc_attr_get_info(id, &info))
+		return NULL;
+
+	return info.id_name;
 }
 
 void verify_nonexistence(void *hdl, enum qc_attr_id id, int layer) {
@@ -866,10 +792,367 @@ void print_kvmguest_information(void *hdl, int layer, int indent) {
 	verify_nonexistence(hdl, qc_cp_absolute_capping, layer);
 }
 
+// Verify attribute metadata and name lookups, and that it matches the attributes present in 'hdl'
+void verify_attr_metadata(void *hdl, int layers) {
+	int rc, i, j, n, id, type, ival, types[qc_secure + 1];
+	enum qc_attr_id ids[qc_secure + 1];
+	struct qc_attr_info info;
+	const char *sval;
+	float fval;
+
+	if (qc_attr_from_name("no_such_attribute") != -EINVAL || qc_attr_name(qc_secure + 1) != NULL) {
+		printf("Error: Attribute name lookup accepted invalid input\n");
+		err_cnt++;
+	}
+	for (id = 0; id <= qc_secure; id++) {
+		if (qc_attr_get_info(id, &info) || strcmp(qc_attr_name(id), info.name) ||
+		    qc_attr_from_name(info.name) != id || qc_attr_from_name(info.id_name) != id) {
+			printf("Error: Name lookup of attribute %d failed\n", id);
+			err_cnt++;
+		}
+	}
+	for (i = 0; i < layers; i++) {
+		if (qc_get_attribute_int(hdl, qc_layer_type_num, i, &type) <= 0)
+			continue;
+		n = qc_get_layer_attrs(hdl, i, ids, types, qc_secure + 1);
+		if (n <= 0 || n > qc_secure + 1 || qc_get_layer_attrs(hdl, i, NULL, NULL, 0) != n) {
+			printf("Error: qc_get_layer_attrs() failed for layer %d, rc=%d\n", i, n);
+			err_cnt++;
+			continue;
+		}
+		for (id = 0; id <= qc_secure; id++) {
+			qc_attr_get_info(id, &info);
+			for (j = 0; j < n && ids[j] != id; j++);
+			if ((j < n) != ((info.layer_types & (1 << type)) != 0) ||
+			    (j < n && (types[j] & ~QC_ATTR_SET) != info.type)) {
+				printf("Error: Metadata of attribute %s does not match layer %d\n", info.id_name, i);
+				err_cnt++;
+			}
+			switch (info.type) {
+			case QC_ATTR_TYPE_INT: rc = qc_get_attribute_int(hdl, id, i, &ival); break;
+			case QC_ATTR_TYPE_FLOAT: rc = qc_get_attribute_float(hdl, id, i, &fval); break;
+			default: rc = qc_get_attribute_string(hdl, id, i, &sval); break;
+			}
+			if ((rc > 0) != (j < n && (types[j] & QC_ATTR_SET))) {
+				printf("Error: qc_get_layer_attrs() reports attribute %s at layer %d %s\n",
+				       info.id_name, i, rc > 0 ? "as unset" : "as set");
+				err_cnt++;
+			}
+		}
+	}
+}
+
+// Verify that the trace ring holds messages if QC_TRACE is enabled
+void verify_trace(void) {
+	const char *s = getenv("QC_TRACE");
+	FILE *fp;
+	int rc;
+
+	if ((fp = tmpfile()) == NULL)
+		return;
+	rc = qc_trace_dump(fileno(fp));
+	if (rc < 0 || (s && atoi(s) > 0 && rc == 0)) {
+		printf("Error: qc_trace_dump() failed, rc=%d\n", rc);
+		err_cnt++;
+	}
+	fclose(fp);
+}
+
+// Verify the statistics of the qc_open() call that created 'hdl', and that they are included in the global ones
+void verify_stats(void *hdl) {
+	struct qc_stats stats, global;
+	unsigned long long sum = 0;
+	int i;
+
+	if (qc_get_stats(hdl, &stats)) {
+		printf("Error: qc_get_stats() failed\n");
+		err_cnt++;
+		return;
+	}
+	qc_get_global_stats(&global);
+	for (i = QC_PHASE_OPEN + 1; i < QC_PHASE_NUM; i++)
+		sum += stats.phase_ns[i];
+	if (stats.phase_count[QC_PHASE_OPEN] != 1 || stats.phase_count[QC_PHASE_SYSINFO_OPEN] < 1 ||
+	    stats.phase_count[QC_PHASE_SYSFS_CLOSE] != stats.phase_count[QC_PHASE_SYSINFO_OPEN] ||
+	    sum > stats.phase_ns[QC_PHASE_OPEN] || stats.allocations == 0 || stats.diag_retries > stats.diag_reads) {
+		printf("Error: qc_get_stats() returned implausible data\n");
+		err_cnt++;
+	}
+	for (i = 0; i < QC_PHASE_NUM; i++) {
+		if (global.phase_ns[i] < stats.phase_ns[i] || global.phase_count[i] < stats.phase_count[i]) {
+			printf("Error: Global statistics of phase %d are lower than those of the handle\n", i);
+			err_cnt++;
+		}
+	}
+}
+
+// Verify the consistency report, which must be empty if qc_open() checked consistency already
+void verify_consistency(void *hdl) {
+	struct qc_violation v[8];
+	const char *s;
+	int n, i, j, ival;
+
+	if ((n = qc_check_consistency(hdl, v, 8)) < 0 || qc_check_consistency(hdl, NULL, 0) != n) {
+		printf("Error: qc_check_consistency() failed, rc=%d\n", n);
+		err_cnt++;
+		return;
+	}
+	if (n > 0 && (s = getenv("QC_CHECK_CONSISTENCY")) != NULL && atoi(s) > 0) {
+		printf("Error: qc_check_consistency() reports %d violation(s), though qc_open() succeeded\n", n);
+		err_cnt++;
+	}
+	for (i = 0; i < n && i < 8; i++) {
+		for (j = 0; j < v[i].num_attrs; j++) {
+			if (qc_get_attribute_int(hdl, v[i].attrs[j], v[i].layer, &ival) > 0 ? ival != v[i].values[j] : v[i].sources[j] != '_') {
+				printf("Error: Violation of rule %d at layer %d reports wrong value for %s\n",
+				       v[i].rule, v[i].layer, qc_attr_name(v[i].attrs[j]));
+				err_cnt++;
+			}
+		}
+	}
+}
+
+// Resolve all attributes in 'hdl' to tokens, and verify that reads from 'hdl2' match its getters
+void verify_tokens(void *hdl, void *hdl2, int layers) {
+	int rc, rc2, i, j, n, types[qc_secure + 1], ival, ival2;
+	enum qc_attr_id ids[qc_secure + 1];
+	const char *sval, *sval2;
+	unsigned long long token;
+	float fval, fval2;
+
+	for (i = 0; i < layers; i++) {
+		n = qc_get_layer_attrs(hdl, i, ids, types, qc_secure + 1);
+		for (j = 0; j < n; j++) {
+			if ((rc = qc_resolve(hdl, i, ids[j], &token)) != 0) {
+				printf("Error: qc_resolve() failed for attribute %s at layer %d, rc=%d\n",
+				       attr2char(ids[j]), i, rc);
+				err_cnt++;
+				continue;
+			}
+			switch (types[j] & ~QC_ATTR_SET) {
+			case QC_ATTR_TYPE_INT:
+				rc = qc_read_int(hdl2, token, &ival);
+				rc2 = qc_get_attribute_int(hdl2, ids[j], i, &ival2);
+				if (rc != rc2 || (rc > 0 && ival != ival2) || qc_read_float(hdl2, token, &fval) >= 0)
+					goto mismatch;
+				break;
+			case QC_ATTR_TYPE_FLOAT:
+				rc = qc_read_float(hdl2, token, &fval);
+				rc2 = qc_get_attribute_float(hdl2, ids[j], i, &fval2);
+				if (rc != rc2 || (rc > 0 && fval != fval2) || qc_read_string(hdl2, token, &sval) >= 0)
+					goto mismatch;
+				break;
+			default:
+				rc = qc_read_string(hdl2, token, &sval);
+				rc2 = qc_get_attribute_string(hdl2, ids[j], i, &sval2);
+				if (rc != rc2 || (rc > 0 && strcmp(sval, sval2)) || qc_read_int(hdl2, token, &ival) >= 0)
+					goto mismatch;
+				break;
+			}
+			continue;
+mismatch:
+			printf("Error: Token read of attribute %s at layer %d does not match, rc=%d\n",
+			       attr2char(ids[j]), i, rc);
+			err_cnt++;
+		}
+	}
+}
+
+// Export 'hdl' to a binary snapshot, import it, and verify all attributes match
+void verify_binary_snapshot(void *hdl, int layers) {
+	int rc, rc2, i, id, ival, ival2;
+	const char *sval, *sval2;
+	float fval, fval2;
+	void *hdl2 = NULL;
+	size_t size = 0;
+	char *buf;
+
+	if (qc_export_binary(hdl, NULL, &size) != -ENOSPC || size == 0) {
+		printf("Error: qc_export_binary() failed to return size\n");
+		err_cnt++;
+		return;
+	}
+	if ((buf = malloc(size)) == NULL)
+		return;
+	if ((rc = qc_export_binary(hdl, buf, &size)) != 0) {
+		printf("Error: qc_export_binary() failed, rc=%d\n", rc);
+		err_cnt++;
+		goto out;
+	}
+	if (qc_import_binary(buf, size - 1, &rc) != NULL || rc == 0) {
+		printf("Error: qc_import_binary() accepted truncated snapshot\n");
+		err_cnt++;
+	}
+	if ((hdl2 = qc_import_binary(buf, size, &rc)) == NULL || rc) {
+		printf("Error: qc_import_binary() failed, rc=%d\n", rc);
+		err_cnt++;
+		goto out;
+	}
+	if (qc_get_num_layers(hdl2, &rc) != layers) {
+		printf("Error: Imported snapshot has a different number of layers\n");
+		err_cnt++;
+		goto out;
+	}
+	verify_tokens(hdl, hdl2, layers);
+	for (i = 0; i < layers; i++) {
+		for (id = 0; id <= qc_secure; id++) {
+			rc = qc_get_attribute_int(hdl, id, i, &ival);
+			rc2 = qc_get_attribute_int(hdl2, id, i, &ival2);
+			if (rc != rc2 || (rc > 0 && ival != ival2))
+				goto mismatch;
+			rc = qc_get_attribute_float(hdl, id, i, &fval);
+			rc2 = qc_get_attribute_float(hdl2, id, i, &fval2);
+			if (rc != rc2 || (rc > 0 && fval != fval2))
+				goto mismatch;
+			rc = qc_get_attribute_string(hdl, id, i, &sval);
+			rc2 = qc_get_attribute_string(hdl2, id, i, &sval2);
+			if (rc != rc2 || (rc > 0 && strcmp(sval, sval2)))
+				goto mismatch;
+			continue;
+mismatch:
+			printf("Error: Attribute %s at layer %d differs in imported snapshot\n", attr2char(id), i);
+			err_cnt++;
+		}
+	}
+
+out:
+	qc_close(hdl2);
+	free(buf);
+}
+
+// Export 'hdl' to JSON, import it, and verify that exporting the result yields the same output
+void verify_json_snapshot(void *hdl, int layers, int flags) {
+	struct qc_json_target tgt = {QC_JSON_TARGET_BUFFER}, tgt2;
+	void *hdl2 = NULL;
+	int rc;
+
+	if (qc_export_json_ex(hdl, &tgt, flags) != -ENOSPC || (tgt.buf = malloc(tgt.len + 1)) == NULL) {
+		printf("Error: qc_export_json_ex() failed to return size\n");
+		err_cnt++;
+		return;
+	}
+	tgt.size = tgt.len + 1;
+	tgt2 = tgt;
+	if ((tgt2.buf = malloc(tgt2.size)) == NULL)
+		goto out;
+	if ((rc = qc_export_json_ex(hdl, &tgt, flags)) != 0) {
+		printf("Error: qc_export_json_ex() failed, rc=%d\n", rc);
+		err_cnt++;
+		goto out;
+	}
+	if (qc_import_json(tgt.buf, tgt.len - 2, &rc) != NULL || rc == 0) {
+		printf("Error: qc_import_json() accepted truncated input\n");
+		err_cnt++;
+	}
+	if ((hdl2 = qc_import_json(tgt.buf, tgt.len, &rc)) == NULL || rc) {
+		printf("Error: qc_import_json() failed, rc=%d\n", rc);
+		err_cnt++;
+		goto out;
+	}
+	if (qc_get_num_layers(hdl2, &rc) != layers) {
+		printf("Error: Imported JSON has a different number of layers\n");
+		err_cnt++;
+		goto out;
+	}
+	if ((rc = qc_export_json_ex(hdl2, &tgt2, flags)) != 0 || tgt.len != tgt2.len ||
+	    memcmp(tgt.buf, tgt2.buf, tgt.len)) {
+		printf("Error: JSON export of imported handle differs (flags=%d), rc=%d\n", flags, rc);
+		err_cnt++;
+	}
+
+out:
+	qc_close(hdl2);
+	free(tgt2.buf);
+	free(tgt.buf);
+}
+
+/* Change the last occurrence of num_cpu_total in the JSON export of 'hdl', and verify that qc_diff() reports it.
+   A value exceeding the range of an int must be rejected on import. */
+void verify_diff(void *hdl) {
+	struct qc_json_target tgt = {QC_JSON_TARGET_BUFFER};
+	const char *key = "\"num_cpu_total\":";
+	char *p, *last = NULL, *buf = NULL;
+	struct qc_event ev[4];
+	void *hdl2 = NULL;
+	int rc, val;
+
+	if ((rc = qc_diff(hdl, hdl, QC_EVENT_ALL, ev, 4)) != 0) {
+		printf("Error: qc_diff() reported %d event(s) for identical handles\n", rc);
+		err_cnt++;
+	}
+	if (qc_export_json_ex(hdl, &tgt, QC_JSON_COMPACT | QC_JSON_NATIVE) != -ENOSPC ||
+	    (tgt.buf = malloc(tgt.len + 1)) == NULL || (buf = malloc(tgt.len + 16)) == NULL)
+		goto out;
+	tgt.size = tgt.len + 1;
+	if (qc_export_json_ex(hdl, &tgt, QC_JSON_COMPACT | QC_JSON_NATIVE))
+		goto out;
+	for (p = tgt.buf; (p = strstr(p, key)) != NULL; p++)
+		last = p;
+	if (!last)
+		goto out;
+	p = last + strlen(key);
+	sprintf(buf, "%.*s9999%s", (int)(p - tgt.buf), tgt.buf, p + strspn(p, "0123456789"));
+	if ((hdl2 = qc_import_json(buf, strlen(buf), &rc)) == NULL) {
+		printf("Error: qc_import_json() failed on modified input, rc=%d\n", rc);
+		err_cnt++;
+		goto out;
+	}
+	if ((rc = qc_diff(hdl, hdl2, QC_EVENT_ALL, ev, 4)) != 1 || ev[0].type != QC_EVENT_COUNT ||
+	    ev[0].attr != qc_num_cpu_total || ev[0].new_value != 9999 ||
+	    qc_get_attribute_int(hdl, qc_num_cpu_total, ev[0].layer, &val) != 1 || val != ev[0].old_value) {
+		printf("Error: qc_diff() failed to report changed num_cpu_total, rc=%d\n", rc);
+		err_cnt++;
+	}
+	if ((rc = qc_diff(hdl, hdl2, QC_EVENT_ALL & ~QC_EVENT_COUNT, NULL, 0)) != 0) {
+		printf("Error: qc_diff() reported %d event(s) not in mask\n", rc);
+		err_cnt++;
+	}
+	qc_close(hdl2);
+	sprintf(buf, "%.*s4294967296%s", (int)(p - tgt.buf), tgt.buf, p + strspn(p, "0123456789"));
+	if ((hdl2 = qc_import_json(buf, strlen(buf), &rc)) != NULL || rc == 0) {
+		printf("Error: qc_import_json() accepted an integer out of range\n");
+		err_cnt++;
+	}
+
+out:
+	qc_close(hdl2);
+	free(tgt.buf);
+	free(buf);
+}
+
+static void count_events(void *watch, const struct qc_event *event, void *arg) {
+	(*(int *)arg)++;
+}
+
+// Verify that watching unchanged data reports no events
+void verify_watch(void) {
+	int rc, events = 0;
+	void *watch;
+
+	if ((watch = qc_watch(0, QC_EVENT_ALL, count_events, &events, -1, &rc)) == NULL) {
+		printf("Error: qc_watch() failed, rc=%d\n", rc);
+		err_cnt++;
+		return;
+	}
+	if ((rc = qc_watch_poll(watch)) != 0 || events) {
+		printf("Error: qc_watch_poll() reported changes in unchanged data, rc=%d\n", rc);
+		err_cnt++;
+	}
+	qc_unwatch(watch);
+	if ((watch = qc_watch(0, QC_EVENT_ALL, NULL, NULL, -1, &rc)) != NULL || rc != -EINVAL) {
+		printf("Error: qc_watch() accepted a watch without callback and eventfd\n");
+		err_cnt++;
+		qc_unwatch(watch);
+	}
+}
+
 int get_handle(void **hdl, int *layers, int quiet) {
 	int rc;
 
-	*hdl = qc_open(&rc);
+	if (bufs)
+		*hdl = qc_open_from_buffers(bufs, &rc);
+	else
+		*hdl = qc_open(&rc);
 	if (rc < 0) {
 		if (!quiet)
 			printf("Error: Could not open capacity data, rc=%d\n", rc);
@@ -900,6 +1183,176 @@ int get_handle(void **hdl, int *layers, int quiet) {
 	return 0;
 }
 
+// Verify that QC_INJECT_DELAY delays reading STHYI data as requested
+void verify_inject_delay(void) {
+	struct qc_stats stats;
+	int layers, rc;
+	void *hdl;
+
+	setenv("QC_INJECT_DELAY", "sthyi=10000", 1);
+	rc = get_handle(&hdl, &layers, 1);
+	setenv("QC_INJECT_DELAY", "", 1);
+	if (rc) {
+		printf("Error: Failed to open handle with QC_INJECT_DELAY set, rc=%d\n", rc);
+		err_cnt++;
+		return;
+	}
+	if (qc_get_stats(hdl, &stats) || stats.phase_ns[QC_PHASE_STHYI_OPEN] < 10000000ULL) {
+		printf("Error: QC_INJECT_DELAY did not delay reading STHYI\n");
+		err_cnt++;
+	}
+	qc_close(hdl);
+}
+
+// Verify that interest in attributes from /proc/sysinfo only skips hypfs and STHYI
+void verify_interest(void *hdl) {
+	enum qc_attr_id ids[] = {qc_num_core_configured, qc_capacity_adjustment_indication, qc_ifl_weight_capping, -1};
+	struct qc_stats stats;
+	int rc, val, val2;
+	void *hdl2;
+
+	if (qc_interest_plan(&ids[3], 1) != -EINVAL || qc_interest_plan(&ids[2], 1) !=
+	    (QC_PLAN_SYSINFO | QC_PLAN_HYPFS | QC_PLAN_STHYI | QC_PLAN_HYPFS_WEIGHTS)) {
+		printf("Error: qc_interest_plan() returned an unexpected plan\n");
+		err_cnt++;
+	}
+	if ((rc = qc_interest_plan(ids, 2)) != QC_PLAN_SYSINFO) {
+		printf("Error: qc_interest_plan() returned plan %d for sysinfo attributes\n", rc);
+		err_cnt++;
+	}
+	if ((hdl2 = qc_open_interest(bufs, ids, 2, &rc)) == NULL || rc) {
+		printf("Error: Failed to open handle with interest in sysinfo attributes, rc=%d\n", rc);
+		err_cnt++;
+		qc_close(hdl2);
+		return;
+	}
+	if (qc_get_stats(hdl2, &stats) || stats.phase_count[QC_PHASE_HYPFS_OPEN] || stats.phase_count[QC_PHASE_STHYI_OPEN]) {
+		printf("Error: qc_open_interest() did not skip hypfs and STHYI\n");
+		err_cnt++;
+	}
+	if (qc_get_attribute_int(hdl, qc_num_core_configured, 0, &val) != 1 ||
+	    qc_get_attribute_int(hdl2, qc_num_core_configured, 0, &val2) != 1 || val != val2) {
+		printf("Error: Attribute of interest differs when skipping hypfs and STHYI\n");
+		err_cnt++;
+	}
+	qc_close(hdl2);
+}
+
+static int src_open(void *hdl, void *arg, void **priv) {
+	*priv = arg;
+	return 0;
+}
+
+/* Re-set an attribute from an earlier source to its value, so consistency checks remain unaffected.
+   Functions other than the getters must reject the incomplete handle. */
+static int src_process(void *hdl, void *priv) {
+	int val, rc;
+
+	qc_get_num_layers(hdl, &rc);
+	if (qc_get_attribute_int(hdl, qc_num_core_configured, 0, &val) != 1 ||
+	    qc_set_attribute_int(hdl, qc_num_core_configured, 0, val) || rc != -EFAULT ||
+	    qc_diff(hdl, hdl, QC_EVENT_ALL, NULL, 0) >= 0)
+		return -1;
+	(*(int *)priv)++;
+	return 0;
+}
+
+static void src_close(void *hdl, void *priv) {
+}
+
+// Verify ordering, dependencies and timing of a registered data source
+void verify_sources(void) {
+	const char *deps[] = {"hypfs", NULL}, *deps2[] = {"test", NULL};
+	struct qc_source src = {"test", 500, deps, NULL, src_open, src_process, NULL, src_close, NULL};
+	struct qc_source_info info[QC_SOURCES_MAX];
+	int layers, num, rc, processed = 0;
+	void *hdl;
+
+	src.arg = &processed;
+	if ((rc = qc_register_source(&src)) != 0) {
+		printf("Error: qc_register_source() failed, rc=%d\n", rc);
+		err_cnt++;
+		return;
+	}
+	if (qc_register_source(&src) != -EEXIST || qc_unregister_source("hypfs") != -EPERM ||
+	    qc_enable_source("sysinfo", 0) != -EPERM) {
+		printf("Error: Invalid management of data sources succeeded\n");
+		err_cnt++;
+	}
+	src.name = "test2";
+	src.depends = deps2;
+	if (qc_register_source(&src) != -EINVAL) {
+		printf("Error: qc_register_source() accepted a dependency of equal priority\n");
+		err_cnt++;
+	}
+	if (get_handle(&hdl, &layers, 1) == 0) {
+		if (processed != 1 || qc_set_attribute_int(hdl, qc_num_core_configured, 0, 0) != -EPERM) {
+			printf("Error: Registered data source not processed as expected\n");
+			err_cnt++;
+		}
+		qc_close(hdl);
+	} else
+		err_cnt++;
+	num = qc_get_sources(info, QC_SOURCES_MAX);
+	if (num != 5 || strcmp(info[4].name, "test") || info[4].builtin || info[4].calls != 1) {
+		printf("Error: qc_get_sources() returned unexpected data sources\n");
+		err_cnt++;
+	}
+	// sources depending on a disabled source are skipped
+	qc_enable_source("hypfs", 0);
+	if (get_handle(&hdl, &layers, 1) == 0) {
+		if (processed != 1) {
+			printf("Error: Data source depending on a disabled source was processed\n");
+			err_cnt++;
+		}
+		qc_close(hdl);
+	} else
+		err_cnt++;
+	qc_enable_source("hypfs", 1);
+	if ((rc = qc_unregister_source("test")) != 0 || qc_get_sources(NULL, 0) != 4) {
+		printf("Error: qc_unregister_source() failed, rc=%d\n", rc);
+		err_cnt++;
+	}
+}
+
+// Verify that buffers with truncated or out-of-bounds content are handled gracefully
+void verify_truncated_buffers(void) {
+	struct qc_buffers b;
+	char d2fc[64], *sthyi;
+	void *hdl;
+	int rc;
+
+	if (!bufs)
+		return;
+	if (bufs->diag_2fc && bufs->diag_2fc_len >= sizeof(d2fc)) {
+		// retain the header only, keeping the number of guest records
+		b = *bufs;
+		memcpy(d2fc, bufs->diag_2fc, sizeof(d2fc));
+		memset(d2fc, 0, 8);
+		b.diag_2fc = d2fc;
+		b.diag_2fc_len = sizeof(d2fc);
+		if ((hdl = qc_open_from_buffers(&b, &rc)) == NULL || rc < 0) {
+			printf("Error: Failed to open handle with truncated diag 2fc data, rc=%d\n", rc);
+			err_cnt++;
+		}
+		qc_close(hdl);
+	}
+	if (bufs->sthyi && bufs->sthyi_len >= 4096 && (sthyi = malloc(bufs->sthyi_len)) != NULL) {
+		// point the machine section (infmoff) past the end of the buffer
+		b = *bufs;
+		memcpy(sthyi, bufs->sthyi, bufs->sthyi_len);
+		sthyi[12] = 0xff;
+		sthyi[13] = 0xf0;
+		b.sthyi = sthyi;
+		if ((hdl = qc_open_from_buffers(&b, &rc)) != NULL || rc >= 0) {
+			printf("Error: Opened handle with STHYI section offset out of bounds, rc=%d\n", rc);
+			err_cnt++;
+		}
+		qc_close(hdl);
+		free(sthyi);
+	}
+}
+
 // Retrieve handle, dump data, and return *hdl to leave it at the caller's discretion when to close it
 static void *run_test(int quiet, int fulltest) {
 	int indent = 0, layers, i, etype;
@@ -976,6 +1429,22 @@ static void *run_test(int quiet, int fulltest) {
 			err_cnt++;
 		}
 	}
+	verify_attr_metadata(hdl, layers);
+	verify_consistency(hdl);
+	verify_stats(hdl);
+	verify_inject_delay();
+	verify_interest(hdl);
+	verify_sources();
+	verify_truncated_buffers();
+	verify_trace();
+	verify_tokens(hdl, hdl, layers);
+	verify_binary_snapshot(hdl, layers);
+	verify_json_snapshot(hdl, layers, 0);
+	verify_json_snapshot(hdl, layers, QC_JSON_COMPACT | QC_JSON_NATIVE);
+	verify_diff(hdl);
+	if (!bufs)
+		// qc_watch() reads the configuration via qc_open()
+		verify_watch();
 	if (fulltest) {
 		// finally, get another handle before closing the existing one
 		if (get_handle(&hdl2, &layers, quiet) != 0)
@@ -1004,11 +1473,13 @@ out:
 
 static void print_help() {
 	printf("\n");
-	printf("Usage: qc_test [-q] [-h] [<dump>*]\n");
+	printf("Usage: qc_test [-q] [-h] [-b] [<dump>*]\n");
 	printf("\n");
 	printf("Print live system information and perform self-test. Specify dumps to display\n");
 	printf("previously dumped data instead (but skipping a minor part of the self-test).\n");
 	printf("\n");
+	printf("  -b, --buffers    Read dump directories into memory and process them via\n");
+	printf("                   qc_open_from_buffers() instead of using QC_USE_DUMP.\n");
 	printf("  -h, --help       Print usage information and exit\n");
 	printf("  -q, --quiet      Quiet mode: Only gather system information; skip self-test and\n");
 	printf("                   suppress any output.\n");
@@ -1017,15 +1488,19 @@ static void print_help() {
 
 int main(int argc, char **argv) {
 	static struct option long_options[] = {
+		{ "buffers", no_argument, NULL, 'b'},
 		{ "help",  no_argument, NULL, 'h'},
 		{ "quiet", no_argument, NULL, 'q'},
 		{ 0,       0,		0,    0  }
 	};
-	int i, j, c, quiet = 0, rc = 0;
+	int i, j, c, quiet = 0, use_bufs = 0, rc = 0;
+	struct qc_buffers b;
 	void **hdls = NULL;
 
-	while ((c = getopt_long(argc, argv, "hq", long_options, NULL)) != EOF) {
+	while ((c = getopt_long(argc, argv, "bhq", long_options, NULL)) != EOF) {
 		switch (c) {
+		case 'b': use_bufs = 1;
+			  break;
 		case 'h': print_help();
 			  return 0;
 		case 'q': quiet = 1;
@@ -1041,9 +1516,19 @@ int main(int argc, char **argv) {
 	if (optind < argc) {
 		// dump(s) specified on command line - dump all, and close handles later on
 		for (j = 0, i = optind; i < argc; ++i, ++j) {
-			setenv("QC_USE_DUMP", argv[i], 1);
+			if (use_bufs) {
+				if (read_buffers(argv[i], &b)) {
+					hdls[j] = NULL;
+					rc++;
+					continue;
+				}
+				bufs = &b;
+			} else
+				setenv("QC_USE_DUMP", argv[i], 1);
 			if ((hdls[j] = run_test(quiet, 0)) == NULL)
 				rc++;
+			if (use_bufs)
+				free_buffers(&b);
 		}
 		for (--j; j >= 0; --j)
 			qc_close(hdls[j]);
@@ -0,0 +1,100 @@
+/* Copyright IBM Corp. 2026 */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "query_capacity.h"
+
+
+/* Helpers shared by qc_test, qc_bench and qc_stress */
+
+// Returns a monotonic timestamp in nanoseconds
+unsigned long long now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int cmp_ull(const void *a, const void *b) {
+	unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+// Returns the 'pml' per mille percentile of the 'n' values in 'vals' (nearest rank), sorting 'vals'
+unsigned long long percentile(unsigned long long *vals, long n, int pml) {
+	long idx = (n * pml + 999) / 1000 - 1;
+
+	qsort(vals, n, sizeof(*vals), cmp_ull);
+
+	return vals[idx < 0 ? 0 : idx];
+}
+
+// Read file 'name' in dump directory 'dir' into a malloc'd buffer, leaving *buf NULL if not present
+int read_dump_file(const char *dir, const char *name, const void **buf, size_t *len) {
+	char path[4096];
+	struct stat sb;
+	char *data;
+	int fd, rc;
+
+	*buf = NULL;
+	*len = 0;
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return 0;
+	if (fstat(fd, &sb) || (data = malloc(sb.st_size ? sb.st_size : 1)) == NULL) {
+		close(fd);
+		return 1;
+	}
+	rc = read(fd, data, sb.st_size);
+	close(fd);
+	if (rc != sb.st_size) {
+		fprintf(stderr, "Error: Failed to read '%s'\n", path);
+		free(data);
+		return 1;
+	}
+	*buf = data;
+	*len = sb.st_size;
+
+	return 0;
+}
+
+void free_buffers(struct qc_buffers *b) {
+	free((void *)b->sysinfo);
+	free((void *)b->diag_204);
+	free((void *)b->diag_2fc);
+	free((void *)b->sthyi);
+	free((void *)b->cpc_name);
+	free((void *)b->has_secure);
+	free((void *)b->secure);
+	memset(b, 0, sizeof(*b));
+}
+
+// Read dump directory 'dir' into 'b' for use with qc_open_from_buffers()
+int read_buffers(const char *dir, struct qc_buffers *b) {
+	memset(b, 0, sizeof(*b));
+	if (read_dump_file(dir, "sysinfo", (const void **)&b->sysinfo, &b->sysinfo_len) ||
+	    read_dump_file(dir, "s390_hypfs/diag_204", &b->diag_204, &b->diag_204_len) ||
+	    read_dump_file(dir, "s390_hypfs/diag_2fc", &b->diag_2fc, &b->diag_2fc_len) ||
+	    read_dump_file(dir, "sthyi", &b->sthyi, &b->sthyi_len) ||
+	    read_dump_file(dir, "sys/firmware/ocf/cpc_name", (const void **)&b->cpc_name, &b->cpc_name_len) ||
+	    read_dump_file(dir, "sys/firmware/ipl/has_secure", (const void **)&b->has_secure, &b->has_secure_len) ||
+	    read_dump_file(dir, "sys/firmware/ipl/secure", (const void **)&b->secure, &b->secure_len)) {
+		free_buffers(b);
+		return 1;
+	}
+	if (!b->sysinfo) {
+		fprintf(stderr, "Error: '%s' is not a dump directory\n", dir);
+		free_buffers(b);
+		return 1;
+	}
+
+	return 0;
+}
@@ -3,21 +3,26 @@
 #define _GNU_SOURCE
 
 #include <sys/stat.h>
+#include <pthread.h>
 
 #include "query_capacity_data.h"
 
 
 long  qc_dbg_level;
 FILE *qc_dbg_file;
-char *qc_dbg_dump_dir;
 int   qc_dbg_indent;
 char *qc_dbg_use_dump;
 int   qc_dbg_console;
 int   qc_consistency_check_requested;
+int   qc_plan = QC_PLAN_ALL;		// plan of the qc_open() call in progress
 static char	    *qc_dbg_file_name;
+static char	    *qc_dbg_dump_file;
 static long	     qc_dbg_autodump;
+static long	     qc_dbg_delay_hypfs;	// in microseconds, see QC_INJECT_DELAY
+static long	     qc_dbg_delay_sthyi;
 static unsigned int  qc_dbg_dump_idx;
 static iconv_t	     qc_cd = (iconv_t)-1;
+static iconv_t	     qc_cd_a2e = (iconv_t)-1;
 
 struct qc_reg_hdl {
 	struct qc_handle	*hdl;
@@ -25,15 +30,58 @@ struct qc_reg_hdl {
 };
 
 static struct qc_reg_hdl *qc_hdls = NULL;
+// Handle that qc_open() is gathering data for in the current thread, valid in callbacks of data sources only
+static __thread struct qc_handle *qc_src_hdl;
+
+// Data sources and debug facilities are global, hence we serialize opening and closing handles
+static pthread_mutex_t qc_open_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t qc_hdls_lock = PTHREAD_MUTEX_INITIALIZER;
 
 static void __attribute__((destructor)) qc_destructor(void) {
 	if (qc_cd != (iconv_t)-1)
 		iconv_close(qc_cd);
+	if (qc_cd_a2e != (iconv_t)-1)
+		iconv_close(qc_cd_a2e);
+}
+
+/* Parses a list of '<source>=<microseconds>' as specified in QC_INJECT_DELAY */
+static void qc_parse_delays(const char *s) {
+	char name[8];
+	long us;
+	int n;
+
+	qc_dbg_delay_hypfs = 0;
+	qc_dbg_delay_sthyi = 0;
+	while (sscanf(s, "%7[a-z]=%ld%n", name, &us, &n) == 2) {
+		if (strcmp(name, "hypfs") == 0)
+			qc_dbg_delay_hypfs = us < 0 ? 0 : us;
+		else if (strcmp(name, "sthyi") == 0)
+			qc_dbg_delay_sthyi = us < 0 ? 0 : us;
+		s += n;
+		if (*s++ != ',')
+			break;
+	}
+}
+
+/* Delays reading the data of the source with open phase 'phase' as requested via
+   QC_INJECT_DELAY, simulating slow sources for stress tests */
+void qc_inject_delay(struct qc_handle *hdl, int phase) {
+	long us = 0;
+
+	if (phase == QC_PHASE_HYPFS_OPEN)
+		us = qc_dbg_delay_hypfs;
+	else if (phase == QC_PHASE_STHYI_OPEN)
+		us = qc_dbg_delay_sthyi;
+	if (us > 0) {
+		qc_debug(hdl, "Inject delay of %ld us\n", us);
+		usleep(us);
+	}
 }
 
 /* Update dbg_level from environment variable */
 static void qc_update_dbg_level(void) {
 	char *s, *end;
+	long num;
 
 	s = getenv("QC_DEBUG");
 	if (s) {
@@ -61,6 +109,17 @@ static void qc_update_dbg_level(void) {
 		if (end == s || qc_dbg_console < 0)
 			qc_dbg_console = 0;
 	}
+	s = getenv("QC_INJECT_DELAY");
+	if (s)
+		qc_parse_delays(s);
+	s = getenv("QC_TRACE");
+	if (s) {
+		num = strtol(s, &end, 10);
+		if (end == s)
+			num = 0;
+		s = getenv("QC_TRACE_SIGNAL");
+		qc_trace_init(num, s ? atoi(s) : 0);
+	}
 }
 
 static void qc_debug_deinit(void *hdl) {
@@ -69,10 +128,9 @@ static void qc_debug_deinit(void *hdl) {
 		qc_dbg_level = 1;	// temporarily set, or qc_debug won't print anything
 		qc_debug(hdl, "Log level set to %ld, closing\n", qc_dbg_level);
 		qc_dbg_level = 0;
+		qc_trace_flush();
 		fclose(qc_dbg_file);
 		qc_dbg_file = NULL;
-		free(qc_dbg_dump_dir);
-		qc_dbg_dump_dir = NULL;
 		free(qc_dbg_file_name);
 		qc_dbg_file_name = NULL;
 		qc_dbg_dump_idx = 0;
@@ -121,51 +179,46 @@ out_err:
 	return -1;
 }
 
-static int qc_debug_open_dump_dir(struct qc_handle *hdl) {
-	int i;
-
+static int qc_debug_open_dump(struct qc_handle *hdl) {
 	if (!qc_dbg_file_name && qc_debug_file_init())
 		return -1;
+
+	return qc_dump_begin(hdl);
+}
+
+// Write the dump to a new file, using the next available index
+static void qc_debug_close_dump(struct qc_handle *hdl) {
+	int i, rc = -1;
+
 	for (i = 0, ++qc_dbg_dump_idx; i < 100; ++i, ++qc_dbg_dump_idx) {
-		free(qc_dbg_dump_dir);
-		qc_dbg_dump_dir = NULL;
-		if (asprintf(&qc_dbg_dump_dir, "%s.dump-%u", qc_dbg_file_name,
+		free(qc_dbg_dump_file);
+		qc_dbg_dump_file = NULL;
+		if (asprintf(&qc_dbg_dump_file, "%s.dump-%u", qc_dbg_file_name,
 				qc_dbg_dump_idx) == -1) {
 			qc_debug(hdl, "Error: Mem alloc error\n");
-			goto out_err;
+			break;
 		}
-		if (mkdir(qc_dbg_dump_dir, S_IRWXU) == 0)
+		if ((rc = qc_dump_write(hdl, qc_dbg_dump_file)) <= 0)
 			break;
-		qc_debug(hdl, "Warning: Could not create dir '%s': %s\n", qc_dbg_dump_dir,
-									strerror(errno));
 	}
-	if (i == 100)
-		goto out_err;
-	qc_debug(hdl, "Created directory '%s' for all dumps\n", qc_dbg_dump_dir);
-
-	return 0;
-
-out_err:
-	qc_debug(hdl, "Error: Could not create directory for dump, better luck maybe next time...\n");
-	free(qc_dbg_dump_dir);
-	qc_dbg_dump_dir = NULL;
-
-	return -1;
-}
-
-static void qc_debug_close_dump_dir(struct qc_handle *hdl) {
-	free(qc_dbg_dump_dir);
-	qc_dbg_dump_dir = NULL;
+	if (rc)
+		qc_debug(hdl, "Error: Could not write dump, better luck maybe next time...\n");
+	free(qc_dbg_dump_file);
+	qc_dbg_dump_file = NULL;
+	qc_dump_end();
+	qc_trace_flush();
 }
 
 #define QC_DUMP_INCOMPLETE	"INCOMPLETE_DUMP.txt"
 /* Opens a log file for debug messages if env var QC_DEBUG is >0. Note that the file is only
    closed in qc_close_configuration() when qc_dbg_level is <=0, so that it's left up to the user
    to decide whether a single file is used all the time or individual files created for each
-   invocation of the library. */
-static int qc_debug_init(void) {
+   invocation of the library. Any dump requested via QC_USE_DUMP is only set up if 'use_dump'
+   is set. */
+static int qc_debug_init(int use_dump) {
 	static int init = 0;
 	char *path = NULL;
+	struct stat sb;
 	int rc = 0;
 
 	if (!init) {
@@ -174,7 +227,7 @@ static int qc_debug_init(void) {
 		qc_dbg_file = NULL;
 		qc_dbg_file_name = NULL;
 		qc_dbg_level = 0;
-		qc_dbg_dump_dir = NULL;
+		qc_dbg_dump_file = NULL;
 		qc_dbg_use_dump = NULL;
 		qc_dbg_dump_idx = 0;
 		qc_dbg_autodump = 0;
@@ -189,8 +242,16 @@ static int qc_debug_init(void) {
 		}
 		qc_debug(NULL, "Log level set to %ld\n", qc_dbg_level);
 	}
-	if (qc_dbg_use_dump) {
+	if (qc_dbg_use_dump && use_dump) {
 		// usage of dump file requested - any error in here is fatal
+		if (stat(qc_dbg_use_dump, &sb) == 0 && S_ISREG(sb.st_mode)) {
+			if (qc_dump_load(NULL, qc_dbg_use_dump)) {
+				rc = 4;
+				goto out_err;
+			}
+			qc_debug(NULL, "Running with dump file '%s'\n", qc_dbg_use_dump);
+			return 0;
+		}
 		if (access(qc_dbg_use_dump, R_OK | X_OK) == -1) {
 			qc_debug(NULL, "Error: Dump usage requested, but path '%s' "
 					"not accessible: %s\n",	qc_dbg_use_dump, strerror(errno));
@@ -204,7 +265,7 @@ static int qc_debug_init(void) {
 			goto out_err;
 		}
 		if (!access(path, R_OK)) {
-			qc_debug(NULL, "Error: Dump at %s is incomplete, cannot use\n", qc_dbg_dump_dir);
+			qc_debug(NULL, "Error: Dump at %s is incomplete, cannot use\n", qc_dbg_use_dump);
 			qc_debug(NULL, "       See content of %s for list of missing components\n",
 											path);
 			rc = 4;
@@ -220,8 +281,6 @@ static int qc_debug_init(void) {
 
 out_err:
 	// Nothing we can do about this except to disable debug messages to prevent further damage
-	free(qc_dbg_dump_dir);
-	qc_dbg_dump_dir = NULL;
 	free(qc_dbg_use_dump);
 	qc_dbg_use_dump = NULL;
 	free(path);
@@ -237,19 +296,27 @@ void qc_debug_indent_dec(void) {
 	qc_dbg_indent -= 2;
 }
 
-void qc_mark_dump_incomplete(struct qc_handle *hdl, char *missing_component) {
-	int rc;
-	char *cmd;
+void qc_mark_dump_incomplete(struct qc_handle *hdl, const char *missing_component) {
+	qc_dump_add(hdl, QC_DUMP_SEC_INCOMPLETE, missing_component, strlen(missing_component));
+}
 
-	if (asprintf(&cmd, "/bin/echo %s >> %s/%s", missing_component, qc_dbg_dump_dir,
-								QC_DUMP_INCOMPLETE) == -1) {
-		qc_debug(hdl, "Error: Failed to alloc mem to indicate dump as incomplete\n");
-		return;
+/* Convert ASCII string to EBCDIC into a buffer of size outsz, padded with EBCDIC
+   blanks. Fails if the string does not fit. */
+int qc_ascii_to_ebcdic(struct qc_handle *hdl, const char *in, char *out, size_t outsz) {
+	size_t insz = strlen(in), left = outsz;
+	char *inbuf = (char *)in;
+
+	if (insz > outsz) {
+		qc_debug(hdl, "Error: String '%s' exceeds %zd characters\n", in, outsz);
+		return -1;
+	}
+	if (iconv(qc_cd_a2e, &inbuf, &insz, &out, &left) == (size_t)(-1)) {
+		qc_debug(hdl, "Error: iconv conversion failed: %s\n", strerror(errno));
+		return -2;
 	}
-	if ((rc = system(cmd)) != 0)
-		qc_debug(hdl, "Error: Failed to exec command to indicate dump as incomplete, "
-										"rc=%d\n", rc);
-	free(cmd);
+	memset(out, 0x40, left);
+
+	return 0;
 }
 
 /* Convert EBCDIC input to ASCII in place, removing trailing whitespace */
@@ -295,20 +362,43 @@ out:
 	return rc;
 }
 
+// Sets up the index of all layers and the topology fingerprint in the root handle
+static int qc_hdl_index_layers(struct qc_handle *hdl) {
+	struct qc_handle *layer;
+	int num;
+
+	for (num = 0, layer = hdl; layer; layer = layer->next)
+		num++;
+	free(hdl->layers);
+	if ((hdl->layers = malloc(num * sizeof(*hdl->layers))) == NULL)
+		return -1;
+	hdl->num_layers = num;
+	hdl->topology = 2166136261u ^ num;
+	for (layer = hdl; layer; layer = layer->next) {
+		hdl->layers[layer->layer_no] = layer;
+		hdl->topology = (hdl->topology ^ *(int *)layer->layer) * 16777619u;
+	}
+
+	return 0;
+}
+
 static int qc_hdl_register(struct qc_handle *hdl) {
 	struct qc_reg_hdl *entry;
 
 	entry = malloc(sizeof(struct qc_reg_hdl));
-	if (!entry) {
+	if (!entry || qc_hdl_index_layers(hdl)) {
 		qc_debug(hdl, "Error: Failed register hdl\n");
+		free(entry);
 		return -1;
 	}
 	entry->hdl = hdl;
+	pthread_mutex_lock(&qc_hdls_lock);
 	if (qc_hdls)
 		entry->next = qc_hdls;
 	else
 		entry->next = NULL;
 	qc_hdls = entry;
+	pthread_mutex_unlock(&qc_hdls_lock);
 
 	return 0;
 }
@@ -316,6 +406,7 @@ static int qc_hdl_register(struct qc_handle *hdl) {
 static void qc_hdl_unregister(struct qc_handle *hdl) {
 	struct qc_reg_hdl *entry, *prev = NULL;
 
+	pthread_mutex_lock(&qc_hdls_lock);
 	for (entry = qc_hdls; entry != NULL; prev = entry, entry = entry->next) {
 		if (entry->hdl == hdl) {
 			if (prev && entry->next)
@@ -328,6 +419,8 @@ static void qc_hdl_unregister(struct qc_handle *hdl) {
 			break;
 		}
 	}
+	pthread_mutex_unlock(&qc_hdls_lock);
+
 	return;
 }
 
@@ -336,180 +429,218 @@ static int qc_hdl_verify(struct qc_handle *hdl, const char *func) {
 
 	if (!hdl)
 		return -1;
+	pthread_mutex_lock(&qc_hdls_lock);
 	for (entry = qc_hdls; entry != NULL; entry = entry->next) {
-		if (entry->hdl == hdl)
+		if (entry->hdl == hdl) {
+			pthread_mutex_unlock(&qc_hdls_lock);
 			return 0;
+		}
 	}
+	pthread_mutex_unlock(&qc_hdls_lock);
 	qc_debug(NULL, "Error: %s() called with unknown handle %p\n", func, hdl);
 
 	return -1;
 }
 
+// Same as qc_hdl_verify(), but also accepts the handle passed to the callbacks of data sources
+static int qc_hdl_verify_src(struct qc_handle *hdl, const char *func) {
+	if (hdl && hdl == qc_src_hdl)
+		return 0;
+
+	return qc_hdl_verify(hdl, func);
+}
+
 // De-alloc hdl, leaving out the actual handle
 static void qc_hdl_reinit(struct qc_handle *hdl) {
 	qc_hdl_prune(hdl);
 	qc_hdl_unregister(hdl);
 }
 
-/** Verifies that either a and (b or c), or none are set. I.e. if only one of the attributes is set, then that's an error */
-static int qc_verify_capped_capacity(struct qc_handle *hdl, enum qc_attr_id a, enum qc_attr_id b, enum qc_attr_id c) {
-	int *val_a, *val_b, *val_c;
-
-	// We assume that non-presence of a value is due to...non-presence, as opposed to an error (since that would have been reported previously)
-	val_a = qc_get_attr_value_int(hdl, a);
-	val_b = qc_get_attr_value_int(hdl, b);
-	val_c = qc_get_attr_value_int(hdl, c);
-	if (!val_a && !val_b && !val_c)
-		return 0;
+#define ATTR_UNDEF	qc_layer_name
+#define QC_RULE_LAYER(type)	(1U << (type))
+
+/* Consistency rules, evaluated in order for each layer that they apply to:
+ * - QC_RULE_SUM_LE/QC_RULE_SUM_EQ: Verify that a + (b (+ c)) <= d (or = d) for the respective int-attributes holds
+ *   true. b and c are optional, where b being unset (==ATTR_UNDEF) implies c being unset, too.
+ * - QC_RULE_CAPPED: Verify that either a and (b or c), or none are set. I.e. if only one of the attributes is set,
+ *   then that's an error. d is unused.
+ * Rules are skipped if any of their attributes is not set, as we assume that non-presence of a value is due
+ * to...non-presence, as opposed to an error (since that would have been reported previously). */
+struct qc_rule {
+	unsigned int	layer_types;	// see QC_RULE_LAYER()
+	int		kind;		// see enum qc_rule_kinds
+	enum qc_attr_id	a, b, c, d;
+};
 
-	// Attributes should all be set now
-        if (!val_a || !val_b || !val_c)
-                return 1;
+static const struct qc_rule qc_rules[] = {
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_LE,	qc_num_core_dedicated,	qc_num_core_shared,	ATTR_UNDEF,		qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_LE,	qc_num_core_configured,	qc_num_core_standby,	qc_num_core_reserved,	qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_LE,	qc_num_cp_total,	qc_num_ifl_total,	ATTR_UNDEF,		qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_EQ,	qc_num_ifl_dedicated,	qc_num_cp_dedicated,	ATTR_UNDEF,		qc_num_core_dedicated},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_EQ,	qc_num_ifl_shared,	qc_num_cp_shared,	ATTR_UNDEF,		qc_num_core_shared},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_EQ,	qc_num_cp_dedicated,	qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_EQ,	qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_CEC), QC_RULE_SUM_EQ,	qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total},
+
+	{QC_RULE_LAYER(QC_LAYER_TYPE_LPAR), QC_RULE_SUM_LE,	qc_num_core_dedicated,	qc_num_core_shared,	qc_num_core_reserved,	qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_LPAR), QC_RULE_SUM_LE,	qc_num_core_configured,	qc_num_core_standby,	qc_num_core_reserved,	qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_LPAR), QC_RULE_SUM_EQ,	qc_num_cp_dedicated,	qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_LPAR), QC_RULE_SUM_EQ,	qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_LPAR), QC_RULE_SUM_EQ,	qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total},
+
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_core_dedicated, qc_num_core_shared,	qc_num_core_reserved,	qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_cp_total,	qc_num_ifl_total,	ATTR_UNDEF,		qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_cp_dedicated, qc_num_ifl_dedicated,	ATTR_UNDEF,		qc_num_core_dedicated},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_cp_shared,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_core_shared},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_cp_dedicated, qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_ifl_dedicated, qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_ziip_dedicated, qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total},
+
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_CPU_POOL) | QC_RULE_LAYER(QC_LAYER_TYPE_ZOS_TENANT_RESOURCE_GROUP), QC_RULE_CAPPED,
+									qc_cp_capped_capacity,	qc_cp_capacity_cap,	qc_cp_limithard_cap,	ATTR_UNDEF},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_CPU_POOL) | QC_RULE_LAYER(QC_LAYER_TYPE_ZOS_TENANT_RESOURCE_GROUP), QC_RULE_CAPPED,
+									qc_ifl_capped_capacity,	qc_ifl_capacity_cap,	qc_ifl_limithard_cap,	ATTR_UNDEF},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_CPU_POOL) | QC_RULE_LAYER(QC_LAYER_TYPE_ZOS_TENANT_RESOURCE_GROUP), QC_RULE_CAPPED,
+									qc_ziip_capped_capacity, qc_ziip_capacity_cap,	qc_ziip_limithard_cap,	ATTR_UNDEF},
+
+	// Note: z/VM doesn't add qc_num_cpu_reserved when calculating qc_num_cpu_total
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cpu_dedicated,	qc_num_cpu_shared,	ATTR_UNDEF,		qc_num_cpu_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cpu_configured,	qc_num_cpu_standby,	qc_num_cpu_reserved,	qc_num_cpu_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cp_total,	qc_num_ifl_total,	ATTR_UNDEF,		qc_num_cpu_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cp_dedicated,	qc_num_ifl_dedicated,	ATTR_UNDEF,		qc_num_cpu_dedicated},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cp_shared,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_cpu_shared},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_cp_dedicated,	qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_ZVM_GUEST), QC_RULE_SUM_EQ, qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total},
+
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_core_shared, qc_num_core_dedicated,	qc_num_core_reserved,	qc_num_core_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_cp_dedicated, qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_ifl_dedicated, qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_HYPERVISOR), QC_RULE_SUM_EQ, qc_num_ziip_dedicated, qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total},
+
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_GUEST), QC_RULE_SUM_EQ, qc_num_cpu_configured,	qc_num_cpu_standby,	qc_num_cpu_reserved,	qc_num_cpu_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_GUEST), QC_RULE_SUM_EQ, qc_num_cpu_shared,	qc_num_cpu_dedicated,	qc_num_cpu_reserved,	qc_num_cpu_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_GUEST), QC_RULE_SUM_EQ, qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total},
+	{QC_RULE_LAYER(QC_LAYER_TYPE_KVM_GUEST), QC_RULE_SUM_EQ, qc_num_ifl_shared,	ATTR_UNDEF,		ATTR_UNDEF,		qc_num_cpu_configured},
+};
 
-	if ((*val_a && !*val_b && !*val_c) || (!*val_a && (*val_b || *val_c))) {
-		qc_debug(hdl, "Warning: Consistency check (\"capped capacity\") for '%s && (%s || %s)' failed at layer %d (%s/%s): %d && (%d || %d)\n",
-			qc_attr_id_to_char(hdl, a), qc_attr_id_to_char(hdl, b), qc_attr_id_to_char(hdl, c),
-			hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type), qc_get_attr_value_string(hdl, qc_layer_category),
-			*val_a, *val_b, *val_c);
-		return 1;
-	}
+#define QC_NUM_RULES	(int)(sizeof(qc_rules) / sizeof(qc_rules[0]))
 
-	return 0;
-}
+/** Evaluates rule 'r' on layer 'hdl', with 'vals' as returned by qc_get_attr_int_slots().
+ *  Returns 0 if the rule holds or doesn't apply, and >0 otherwise. */
+static int qc_rule_violated(struct qc_handle *hdl, const struct qc_rule *r, int **vals, int log) {
+	int *val_a = vals[r->a], *val_b = vals[r->b], *val_c = vals[r->c], *val_d = vals[r->d];
+	int equals = (r->kind == QC_RULE_SUM_EQ), sum;
 
-#define ATTR_UNDEF	qc_layer_name
-/** Verifies that a + (b (+ c)) <= d (b and c are optional, where b being unset (==ATTR_UNDEF) implies c being unset, too)
- *  for the respective int-attributes holds true.
- * @param equals If set, we verify using '=', not '<='
- */
-static int qc_verify(struct qc_handle *hdl, enum qc_attr_id a, enum qc_attr_id b, enum qc_attr_id c, enum qc_attr_id d, int equals) {
-	int *val_a, *val_b = NULL, *val_c = NULL, *val_d;
-
-	// We assume that non-presence of a value is due to...non-presence, as opposed to an error (since that would have been reported previously)
-	if ((val_a = qc_get_attr_value_int(hdl, a)) == NULL ||
-	    (val_d = qc_get_attr_value_int(hdl, d)) == NULL)
+	if (r->kind == QC_RULE_CAPPED) {
+		if (!val_a && !val_b && !val_c)
+			return 0;
+		// Attributes should all be set now
+		if (!val_a || !val_b || !val_c)
+			return 1;
+		if ((*val_a && !*val_b && !*val_c) || (!*val_a && (*val_b || *val_c))) {
+			if (log)
+				qc_debug(hdl, "Warning: Consistency check (\"capped capacity\") for '%s && (%s || %s)' failed at layer %d (%s/%s): %d && (%d || %d)\n",
+					qc_attr_id_to_char(hdl, r->a), qc_attr_id_to_char(hdl, r->b), qc_attr_id_to_char(hdl, r->c),
+					hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type), qc_get_attr_value_string(hdl, qc_layer_category),
+					*val_a, *val_b, *val_c);
+			return 1;
+		}
 		return 0;
-	if (b != ATTR_UNDEF && (val_b = qc_get_attr_value_int(hdl, b)) == NULL)
+	}
+
+	if (!val_a || !val_d || (r->b != ATTR_UNDEF && !val_b) || (r->c != ATTR_UNDEF && !val_c))
 		return 0;
-	if (c != ATTR_UNDEF && (val_c = qc_get_attr_value_int(hdl, c)) == NULL)
+	sum = *val_a + (val_b ? *val_b : 0) + (val_c ? *val_c : 0);
+	if ((equals && sum == *val_d) || (!equals && sum <= *val_d))
 		return 0;
 
-	if (b == ATTR_UNDEF) {
-		if ((equals && *val_a != *val_d) || (!equals && *val_a > *val_d)) {
+	if (r->b == ATTR_UNDEF) {
+		if (log)
 			qc_debug(hdl, "Warning: Consistency check '%s %s %s' failed at layer %d (%s/%s): %d %s %d\n",
-				qc_attr_id_to_char(hdl, a), (equals ? "=" : "<="), qc_attr_id_to_char(hdl, d),
+				qc_attr_id_to_char(hdl, r->a), (equals ? "=" : "<="), qc_attr_id_to_char(hdl, r->d),
 				hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type), qc_get_attr_value_string(hdl, qc_layer_category),
 				*val_a, (equals ? "!=" : ">"), *val_d);
-			return 1;
-		}
-	} else if (c == ATTR_UNDEF) {
-		if ((equals && *val_a + *val_b != *val_d) || (!equals && *val_a + *val_b > *val_d)) {
+		return 1;
+	}
+	if (r->c == ATTR_UNDEF) {
+		if (log)
 			qc_debug(hdl, "Warning: Consistency check '%s + %s %s %s' failed at layer %d (%s/%s): %d + %d %s %d\n",
-				qc_attr_id_to_char(hdl, a), qc_attr_id_to_char(hdl, b), (equals ? "=" : "<="), qc_attr_id_to_char(hdl, d),
+				qc_attr_id_to_char(hdl, r->a), qc_attr_id_to_char(hdl, r->b), (equals ? "=" : "<="), qc_attr_id_to_char(hdl, r->d),
 				hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type), qc_get_attr_value_string(hdl, qc_layer_category),
 				*val_a, *val_b, (equals ? "!=" : ">"), *val_d);
-			return 2;
-		}
-	} else {
-		if ((equals && *val_a + *val_b + *val_c != *val_d) || (!equals && *val_a + *val_b + *val_c > *val_d)) {
-			qc_debug(hdl, "Warning: Consistency check '%s + %s + %s %s %s' failed at layer %d (%s/%s): %d + %d + %d %s %d\n",
-				qc_attr_id_to_char(hdl, a), qc_attr_id_to_char(hdl, b),	qc_attr_id_to_char(hdl, c), (equals ? "=" : "<="),
-				qc_attr_id_to_char(hdl, d), hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type),
-				qc_get_attr_value_string(hdl, qc_layer_category), *val_a, *val_b, *val_c, (equals ? "!=" : ">"), *val_d);
-			return 1;
+		return 2;
+	}
+	if (log)
+		qc_debug(hdl, "Warning: Consistency check '%s + %s + %s %s %s' failed at layer %d (%s/%s): %d + %d + %d %s %d\n",
+			qc_attr_id_to_char(hdl, r->a), qc_attr_id_to_char(hdl, r->b), qc_attr_id_to_char(hdl, r->c), (equals ? "=" : "<="),
+			qc_attr_id_to_char(hdl, r->d), hdl->layer_no, qc_get_attr_value_string(hdl, qc_layer_type),
+			qc_get_attr_value_string(hdl, qc_layer_category), *val_a, *val_b, *val_c, (equals ? "!=" : ">"), *val_d);
+
+	return 1;
+}
+
+static void qc_rule_fill_violation(struct qc_violation *v, struct qc_handle *hdl, int layer_type, int rule, int **vals, char *srcs) {
+	const struct qc_rule *r = &qc_rules[rule];
+	enum qc_attr_id ids[4] = {r->a, r->b, r->c, r->d};
+	int i;
+
+	v->layer = hdl->layer_no;
+	v->layer_type = layer_type;
+	v->rule = rule;
+	v->kind = r->kind;
+	v->num_attrs = 0;
+	for (i = 0; i < 4; ++i) {
+		if (ids[i] == ATTR_UNDEF)
+			continue;
+		v->attrs[v->num_attrs] = ids[i];
+		v->values[v->num_attrs] = vals[ids[i]] ? *vals[ids[i]] : 0;
+		v->sources[v->num_attrs] = vals[ids[i]] ? srcs[ids[i]] : ATTR_SRC_UNDEF;
+		v->num_attrs++;
+	}
+}
+
+/** Evaluates all consistency rules in a single pass over the layers starting at 'hdl'. Stores up to 'max' violations
+ *  in 'out', and stops at the first violation unless 'all' is set.
+ *  Returns the number of violations (or the result of the failing rule if 'all' is not set), or <0 on error. */
+static int qc_check_rules(struct qc_handle *hdl, struct qc_violation *out, int max, int all, int log) {
+	int *vals[qc_secure + 1], *etype, i, rc, num = 0;
+	char srcs[qc_secure + 1];
+
+	for (; hdl; hdl = hdl->next) {
+		if ((etype = qc_get_attr_value_int(hdl, qc_layer_type_num)) == NULL)
+			return -1;
+		qc_get_attr_int_slots(hdl, vals, srcs);
+		for (i = 0; i < QC_NUM_RULES; ++i) {
+			if (!(qc_rules[i].layer_types & QC_RULE_LAYER(*etype)) ||
+			    (rc = qc_rule_violated(hdl, &qc_rules[i], vals, log)) == 0)
+				continue;
+			if (num < max)
+				qc_rule_fill_violation(&out[num], hdl, *etype, i, vals, srcs);
+			if (!all)
+				return rc;
+			num++;
 		}
 	}
 
-	return 0;
+	return num;
 }
 
 // Check consistency of data across data sources, as well as consistency of data within each data source.
 // Returns 0 in case of success, <0 for errors, and >0 in case the data is inconsistent.
 static int qc_consistency_check(struct qc_handle *hdl) {
-	int *etype, rc = 0;
+	unsigned long long start;
+	int rc;
 
 	if (!qc_consistency_check_requested)
 		return 0;
+	start = qc_stats_now();
 	qc_debug(hdl, "Run consistency check\n");
 	qc_debug_indent_inc();
-	for (; hdl; hdl = hdl->next) {
-		if ((etype = qc_get_attr_value_int(hdl, qc_layer_type_num)) == NULL) {
-			rc = -1;
-			goto out;
-		}
-
-		switch (*etype) {
-		case QC_LAYER_TYPE_CEC:
-			if ((rc = qc_verify(hdl, qc_num_core_dedicated, qc_num_core_shared,	ATTR_UNDEF,	      	qc_num_core_total, 0)) ||
-			    (rc = qc_verify(hdl, qc_num_core_configured, qc_num_core_standby,	qc_num_core_reserved, 	qc_num_core_total, 0)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_total,	 qc_num_ifl_total,	ATTR_UNDEF,     	qc_num_core_total, 0)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,	 qc_num_cp_dedicated,	ATTR_UNDEF,		qc_num_core_dedicated, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_shared,	 qc_num_cp_shared,	ATTR_UNDEF,		qc_num_core_shared, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,    qc_num_cp_shared,	ATTR_UNDEF,	      	qc_num_cp_total,  1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,   qc_num_ifl_shared,	ATTR_UNDEF,	      	qc_num_ifl_total, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_ziip_dedicated,  qc_num_ziip_shared,	ATTR_UNDEF,	      	qc_num_ziip_total, 1)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_LPAR:
-			if ((rc = qc_verify(hdl, qc_num_core_dedicated,  qc_num_core_shared,	qc_num_core_reserved,	qc_num_core_total, 0)) ||
-			    (rc = qc_verify(hdl, qc_num_core_configured, qc_num_core_standby,	qc_num_core_reserved,	qc_num_core_total, 0)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,	 qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total,  1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,   qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_ziip_dedicated,  qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total, 1)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_ZVM_HYPERVISOR:
-			if ((rc = qc_verify(hdl, qc_num_core_dedicated, qc_num_core_shared,	qc_num_core_reserved,	qc_num_core_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_total,       qc_num_ifl_total,	ATTR_UNDEF,		qc_num_core_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,   qc_num_ifl_dedicated,	ATTR_UNDEF,		qc_num_core_dedicated,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_shared,      qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_core_shared,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,   qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total,	  1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,  qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total,	  1)) ||
-			    (rc = qc_verify(hdl, qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total,	  1)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_ZVM_CPU_POOL:
-		case QC_LAYER_TYPE_ZOS_TENANT_RESOURCE_GROUP:
-			if ((rc = qc_verify_capped_capacity(hdl,	qc_cp_capped_capacity,	qc_cp_capacity_cap,	qc_cp_limithard_cap)) ||
-			    (rc = qc_verify_capped_capacity(hdl,	qc_ifl_capped_capacity,	qc_ifl_capacity_cap,	qc_ifl_limithard_cap)) ||
-			    (rc = qc_verify_capped_capacity(hdl,	qc_ziip_capped_capacity, qc_ziip_capacity_cap,	qc_ziip_limithard_cap)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_ZVM_GUEST:
-			// Note: z/VM doesn't add qc_num_cpu_reserved when calculating qc_num_cpu_total
-			if ((rc = qc_verify(hdl, qc_num_cpu_dedicated,  qc_num_cpu_shared,	ATTR_UNDEF,		qc_num_cpu_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cpu_configured, qc_num_cpu_standby,	qc_num_cpu_reserved,	qc_num_cpu_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_total,       qc_num_ifl_total,	ATTR_UNDEF,		qc_num_cpu_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,   qc_num_ifl_dedicated,	ATTR_UNDEF,		qc_num_cpu_dedicated,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_shared,      qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_cpu_shared,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_cp_dedicated,   qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,  qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total,	1)) ||
-			    (rc = qc_verify(hdl, qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total,	1)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_KVM_HYPERVISOR:
-			if ((rc = qc_verify(hdl, qc_num_core_shared, 	qc_num_core_dedicated,	qc_num_core_reserved,	qc_num_core_total, 1)) ||
-			(rc = qc_verify(hdl, qc_num_cp_dedicated,	qc_num_cp_shared,	ATTR_UNDEF,		qc_num_cp_total, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total, 1)) ||
-			    (rc = qc_verify(hdl, qc_num_ziip_dedicated,	qc_num_ziip_shared,	ATTR_UNDEF,		qc_num_ziip_total, 1)))
-				goto out;
-			break;
-		case QC_LAYER_TYPE_KVM_GUEST:
-			if ((rc = qc_verify(hdl, qc_num_cpu_configured, qc_num_cpu_standby,	qc_num_cpu_reserved,	qc_num_cpu_total,	   1)) ||
-			    (rc = qc_verify(hdl, qc_num_cpu_shared, 	qc_num_cpu_dedicated,	qc_num_cpu_reserved,	qc_num_cpu_total,	   1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,	qc_num_ifl_shared,	ATTR_UNDEF,		qc_num_ifl_total,	   1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_dedicated,	ATTR_UNDEF,		ATTR_UNDEF,		0,			   1)) ||
-			    (rc = qc_verify(hdl, qc_num_ifl_shared,	ATTR_UNDEF,		ATTR_UNDEF,		qc_num_cpu_configured, 1)))
-				goto out;
-			break;
-		default: break;
-		}
-	}
-
-out:
-	if (rc)
+	if ((rc = qc_check_rules(hdl, NULL, 0, 0, 1)) != 0)
 		qc_debug(hdl, "Warning: Consistency check failed\n");
 	qc_debug_indent_dec();
+	qc_stats_phase(QC_PHASE_CONSISTENCY_CHECK, start);
 
 	return rc;
 }
@@ -763,11 +894,115 @@ fail:
 	return -1;
 }
 
+/* Registry of all data sources, sorted by priority. Protected by qc_open_lock.
+ * sysinfo needs to be handled first, or our LGM check later on will have loopholes.
+ * sysfs needs to be handled after the other built-in sources, as part of the attributes apply to top-most layer only. */
+struct qc_src_entry {
+	struct qc_data_src	*builtin;	// NULL for sources registered via qc_register_source()
+	struct qc_source	 src;		// name and priority only for built-in sources
+	int			 plan;		// QC_PLAN_* flag of built-in sources
+	int			 enabled;
+	int			 active;	// whether the source takes part in the qc_open() call in progress
+	void			*priv;		// private data of registered sources
+	unsigned long long	 calls;
+	unsigned long long	 ns;
+};
+
+static struct qc_src_entry qc_sources[QC_SOURCES_MAX] = {
+	{&sysinfo, {"sysinfo",   0}, QC_PLAN_SYSINFO, 1},
+	{&hypfs,   {"hypfs",   100}, QC_PLAN_HYPFS,   1},
+	{&sthyi,   {"sthyi",   200}, QC_PLAN_STHYI,   1},
+	{&sysfs,   {"sysfs",   300}, QC_PLAN_SYSFS,   1},
+};
+static int qc_num_sources = 4;
+
+static struct qc_src_entry *qc_source_find(const char *name) {
+	int i;
+
+	for (i = 0; i < qc_num_sources; ++i) {
+		if (strcmp(qc_sources[i].src.name, name) == 0)
+			return &qc_sources[i];
+	}
+
+	return NULL;
+}
+
+// Determines the sources taking part in the qc_open() call in progress
+static void qc_sources_activate(struct qc_handle *hdl) {
+	const char *const *dep;
+	struct qc_src_entry *e;
+	int i;
+
+	for (i = 0; i < qc_num_sources; ++i) {
+		e = &qc_sources[i];
+		e->active = 0;
+		if (!e->enabled) {
+			qc_debug(hdl, "Skip %s, disabled\n", e->src.name);
+			continue;
+		}
+		if (e->builtin && !(qc_plan & e->plan)) {
+			qc_debug(hdl, "Skip %s, not required by the attributes of interest\n", e->src.name);
+			continue;
+		}
+		// dependencies have a lower priority, hence were handled already
+		for (dep = e->src.depends; dep && *dep && qc_source_find(*dep)->active; ++dep);
+		if (dep && *dep) {
+			qc_debug(hdl, "Skip %s, depends on %s\n", e->src.name, *dep);
+			continue;
+		}
+		e->active = 1;
+	}
+}
+
+// Calls callback 'op' (see QC_SRC_*) of source 'e', accounting the time spent to the source and its phase
+static int qc_source_call(struct qc_handle *hdl, struct qc_src_entry *e, int op) {
+	struct qc_data_src *b = e->builtin;
+	unsigned long long t;
+	int rc = 0;
+
+	if (b && op == QC_SRC_OPEN) {
+		qc_probe2(source__open__entry, hdl, b->phase);
+	} else if (b && op == QC_SRC_PROCESS) {
+		qc_probe2(source__process__entry, hdl, b->phase);
+	}
+	t = qc_stats_now();
+	switch (op) {
+	case QC_SRC_OPEN:
+		e->calls++;
+		e->priv = NULL;
+		rc = b ? b->open(hdl, &b->priv) : e->src.open(hdl, e->src.arg, &e->priv);
+		break;
+	case QC_SRC_PROCESS:
+		rc = b ? b->process(hdl, b->priv) : e->src.process(hdl, e->priv);
+		break;
+	case QC_SRC_DUMP:
+		if (b)
+			b->dump(hdl, b->priv);
+		else if (e->src.dump)
+			e->src.dump(hdl, e->priv);
+		break;
+	case QC_SRC_CLOSE:
+		if (b)
+			b->close(hdl, b->priv);
+		else
+			e->src.close(hdl, e->priv);
+		break;
+	}
+	t = b ? qc_stats_phase(b->phase + op, t) : qc_stats_now() - t;
+	e->ns += t;
+	if (b && op == QC_SRC_OPEN) {
+		qc_probe4(source__open__return, hdl, b->phase, rc, t);
+	} else if (b && op == QC_SRC_PROCESS) {
+		qc_probe4(source__process__return, hdl, b->phase, rc, t);
+	}
+
+	return rc;
+}
+
 static void *_qc_open(struct qc_handle *hdl, int *rc) {
-	// sysinfo needs to be handled first, or our LGM check later on will have loopholes
-	// sysfs needs to be handled last, as part of the attributes apply to top-most layer only
-	struct qc_data_src *src, *sources[] = {&sysinfo, &hypfs, &sthyi, &sysfs, NULL};
 	struct qc_handle *lparhdl;
+	struct qc_src_entry *e;
+	unsigned long long t;
 	int i;
 
 	qc_debug(hdl, "_qc_open()\n");
@@ -780,22 +1015,42 @@ static void *_qc_open(struct qc_handle *hdl, int *rc) {
 	}
 	hdl->next = lparhdl;
 	lparhdl->root = hdl->root;
+	qc_src_hdl = hdl;
 
+	if (qc_plan != QC_PLAN_ALL)
+		qc_debug(hdl, "Plan: 0x%x\n", qc_plan);
+	qc_sources_activate(hdl);
 	// open all data sources
-	for (i = 0; (src = sources[i]) != NULL; i++)
-		if (src->open(hdl, &src->priv))
+	for (i = 0; i < qc_num_sources; i++) {
+		if (qc_sources[i].active && qc_source_call(hdl, &qc_sources[i], QC_SRC_OPEN) != 0)
 			*rc = -2;	// don't exit on error immediately, so we collect all data for a dump later on
+	}
 	if (*rc)
 		goto out;
 
 	// verify that we weren't migrated
-	if ((*rc = sysinfo.lgm_check(hdl, sysinfo.priv)) != 0)
+	t = qc_stats_now();
+	*rc = sysinfo.lgm_check(hdl, sysinfo.priv);
+	for (i = 0; *rc == 0 && i < qc_num_sources; i++) {
+		e = &qc_sources[i];
+		if (e->active && !e->builtin && e->src.lgm_check)
+			*rc = e->src.lgm_check(hdl, e->priv);
+	}
+	qc_stats_phase(QC_PHASE_LGM_CHECK, t);
+	if (*rc > 0) {
+		qc_stats_add(lgm_detections, 1);
+		qc_probe1(lgm__detected, hdl);
+	}
+	if (*rc)
 		goto out;
 
 	// process data sources
-	for (i = 0; (src = sources[i]) != NULL; i++) {
+	for (i = 0; i < qc_num_sources; i++) {
+		if (!qc_sources[i].active)
+			continue;
 		// Return values >0 will be left as is and passed back to caller
-		if ((*rc = src->process(hdl, src->priv)) < 0) {
+		*rc = qc_source_call(hdl, &qc_sources[i], QC_SRC_PROCESS);
+		if (*rc < 0) {
 			*rc = -3;	// match errors to a value that we can identify
 			goto out;
 		}
@@ -803,7 +1058,10 @@ static void *_qc_open(struct qc_handle *hdl, int *rc) {
 			goto out;
 	}
 
-	if (qc_post_processing(hdl)) {
+	t = qc_stats_now();
+	i = qc_post_processing(hdl);
+	qc_stats_phase(QC_PHASE_POST_PROCESSING, t);
+	if (i) {
 		*rc = -4;
 		goto out;
 	}
@@ -822,18 +1080,27 @@ out:
 	if (qc_dbg_level > 1 || (qc_dbg_autodump && *rc < 0)) {
 		qc_debug(hdl, "Create dump\n");
 		qc_debug_indent_inc();
-		if (qc_debug_open_dump_dir(hdl) == 0) {	// get a new dump directory
-			for (i = 0; (src = sources[i]) != NULL; i++)
-				src->dump(hdl, src->priv);
-			qc_debug_close_dump_dir(hdl);
+		if (qc_debug_open_dump(hdl) == 0) {
+			for (i = 0; i < qc_num_sources; i++) {
+				e = &qc_sources[i];
+				if (e->active)
+					qc_source_call(hdl, e, QC_SRC_DUMP);
+				else if (e->builtin)
+					qc_mark_dump_incomplete(hdl, e->src.name);
+			}
+			qc_debug_close_dump(hdl);
 		} else
-			qc_debug(hdl, "Failed, could not open directory\n");
+			qc_debug(hdl, "Failed, could not start dump\n");
 		qc_debug_indent_dec();
 	}
 
 	// Close all data sources
-	for (i = 0; (src = sources[i]) != NULL; i++)
-		src->close(hdl, src->priv);
+	for (i = 0; i < qc_num_sources; i++) {
+		if (qc_sources[i].active)
+			qc_source_call(hdl, &qc_sources[i], QC_SRC_CLOSE);
+		qc_sources[i].active = 0;
+	}
+	qc_src_hdl = NULL;
 	if (hdl)
 		// nothing else we can do if registration fails
 		qc_hdl_register(hdl);
@@ -843,17 +1110,40 @@ out:
 	return hdl;
 }
 
-__attribute__ ((visibility ("default"))) void *qc_open(int *rc) {
+// Must be called with qc_open_lock held
+static void qc_close_locked(void *hdl) {
+	if (qc_hdl_verify(hdl, "qc_close"))
+		return;
+	qc_debug(hdl, "qc_close()\n");
+	qc_debug_indent_inc();
+
+	qc_debug_deinit(hdl);
+	qc_hdl_reinit(hdl);
+	free(hdl);
+
+	qc_debug_indent_dec();
+	qc_trace_flush();
+}
+
+/* Opens a new handle, using the data in 'bufs' if set, or live data or QC_USE_DUMP otherwise, and reading the
+   data sources in 'plan' only. Must be called with qc_open_lock held. */
+static void *qc_open_locked(const struct qc_buffers *bufs, int plan, int *rc) {
+	unsigned long long start = qc_stats_now();
 	struct qc_handle *hdl = NULL;
+	struct qc_stats stats;
+	char *use_dump = NULL;
+	int i, restore = 0;
 	char *s, *end;
-	int i;
 
 	*rc = 0;
-	if (qc_debug_init()) {
+	memset(&stats, 0, sizeof(stats));
+	qc_stats_cur = &stats;
+	qc_probe1(open__entry, bufs != NULL);
+	if (qc_debug_init(bufs == NULL)) {
 		*rc = -1;
 		goto out;
 	}
-	qc_debug(hdl, "qc_open()\n");
+	qc_debug(hdl, "%s()\n", bufs ? "qc_open_from_buffers" : "qc_open");
 	qc_debug_indent_inc();
 
 	if (qc_cd == (iconv_t)-1) {
@@ -865,6 +1155,28 @@ __attribute__ ((visibility ("default"))) void *qc_open(int *rc) {
 			goto out;
 		}
 	}
+	if (qc_cd_a2e == (iconv_t)-1) {
+		qc_cd_a2e = iconv_open("IBM-1047", "ISO8859-1");
+		if (qc_cd_a2e == (iconv_t)-1) {
+			qc_debug(hdl, "Error: iconv setup failed: %s\n", strerror(errno));
+			*rc = -2;
+			goto out;
+		}
+	}
+
+	if (bufs) {
+		// the data sources process buffers exactly like a dump file
+		if (qc_dump_use_buffers(hdl, bufs)) {
+			*rc = -1;
+			goto out;
+		}
+		use_dump = qc_dbg_use_dump;
+		qc_dbg_use_dump = "<buffers>";
+		restore = 1;
+	}
+
+	// dumps are only complete with all data
+	qc_plan = qc_dbg_level > 1 ? QC_PLAN_ALL : plan;
 
 	if ((s = getenv("QC_CHECK_CONSISTENCY")) != NULL) {
 		qc_consistency_check_requested = strtol(s, &end, 10);
@@ -878,6 +1190,7 @@ __attribute__ ((visibility ("default"))) void *qc_open(int *rc) {
 	for (i = 0; i < 3; ++i) {
 		if (i > 0) {
 			qc_debug(hdl, "Warning: Gathering data failed, retry %d\n", i);
+			qc_stats_add(open_retries, 1);
 			qc_hdl_reinit(hdl);
 		}
 		hdl = _qc_open(hdl, rc);
@@ -890,27 +1203,228 @@ __attribute__ ((visibility ("default"))) void *qc_open(int *rc) {
 		qc_debug(hdl, "Error: Unable to retrieve consistent data, giving up\n");
 
 out:
+	qc_dump_unload();
+	if (restore)
+		qc_dbg_use_dump = use_dump;
 	qc_debug(hdl, "Return %p, rc=%d\n", *rc ? NULL : hdl, *rc);
 	qc_debug_indent_dec();
+	start = qc_stats_phase(QC_PHASE_OPEN, start);
+	qc_stats_cur = NULL;
+	qc_probe3(open__return, *rc ? NULL : hdl, *rc, start);
 	if (*rc) {
-		qc_close(hdl);
+		qc_close_locked(hdl);
 		hdl = NULL;
+	} else if ((hdl->stats = malloc(sizeof(stats))) != NULL)
+		memcpy(hdl->stats, &stats, sizeof(stats));
+
+	return hdl;
+}
+
+__attribute__ ((visibility ("default"))) void *qc_open(int *rc) {
+	void *hdl;
+
+	pthread_mutex_lock(&qc_open_lock);
+	hdl = qc_open_locked(NULL, QC_PLAN_ALL, rc);
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return hdl;
+}
+
+__attribute__ ((visibility ("default"))) void *qc_open_from_buffers(const struct qc_buffers *bufs, int *rc) {
+	void *hdl;
+
+	if (!bufs || !bufs->sysinfo) {
+		*rc = -EINVAL;
+		return NULL;
 	}
+	pthread_mutex_lock(&qc_open_lock);
+	hdl = qc_open_locked(bufs, QC_PLAN_ALL, rc);
+	pthread_mutex_unlock(&qc_open_lock);
 
 	return hdl;
 }
 
-__attribute__ ((visibility ("default"))) void qc_close(void *hdl) {
-	if (qc_hdl_verify(hdl, "qc_close"))
-		return;
-	qc_debug(hdl, "qc_close()\n");
-	qc_debug_indent_inc();
+__attribute__ ((visibility ("default"))) int qc_interest_plan(const enum qc_attr_id *ids, int num) {
+	int i, plan = QC_PLAN_SYSINFO;
+	const char *srcs, *p;
+
+	if (num < 0 || (num > 0 && !ids))
+		return -EINVAL;
+	if (num == 0)
+		plan = QC_PLAN_ALL;
+	for (i = 0; i < num; ++i) {
+		if ((srcs = qc_attr_get_sources(ids[i])) == NULL)
+			return -EINVAL;
+		// the letters are in the order of the QC_PLAN_* flags
+		for (; *srcs; ++srcs) {
+			if ((p = strchr("SHVF", *srcs)) != NULL)
+				plan |= 1 << (p - "SHVF");
+		}
+		if (ids[i] == qc_cp_weight_capping || ids[i] == qc_ifl_weight_capping || ids[i] == qc_ziip_weight_capping)
+			plan |= QC_PLAN_HYPFS_WEIGHTS;
+	}
 
-	qc_debug_deinit(hdl);
-	qc_hdl_reinit(hdl);
-	free(hdl);
+	return plan;
+}
 
-	qc_debug_indent_dec();
+__attribute__ ((visibility ("default"))) void *qc_open_interest(const struct qc_buffers *bufs, const enum qc_attr_id *ids,
+								 int num, int *rc) {
+	void *hdl;
+	int plan;
+
+	if ((bufs && !bufs->sysinfo) || (plan = qc_interest_plan(ids, num)) < 0) {
+		*rc = -EINVAL;
+		return NULL;
+	}
+	pthread_mutex_lock(&qc_open_lock);
+	hdl = qc_open_locked(bufs, plan, rc);
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return hdl;
+}
+
+__attribute__ ((visibility ("default"))) int qc_register_source(const struct qc_source *src) {
+	const char *const *dep;
+	struct qc_src_entry *e;
+	int i, rc = 0;
+
+	if (!src || !src->name || !src->open || !src->process || !src->close || src->priority <= 0)
+		return -EINVAL;
+	pthread_mutex_lock(&qc_open_lock);
+	if (qc_source_find(src->name)) {
+		rc = -EEXIST;
+		goto out;
+	}
+	if (qc_num_sources == QC_SOURCES_MAX) {
+		rc = -ENOSPC;
+		goto out;
+	}
+	for (dep = src->depends; dep && *dep; ++dep) {
+		if ((e = qc_source_find(*dep)) == NULL || e->src.priority >= src->priority) {
+			rc = -EINVAL;
+			goto out;
+		}
+	}
+	// insert after all sources of lower or equal priority
+	for (i = qc_num_sources; i > 0 && qc_sources[i - 1].src.priority > src->priority; --i)
+		qc_sources[i] = qc_sources[i - 1];
+	memset(&qc_sources[i], 0, sizeof(qc_sources[i]));
+	qc_sources[i].src = *src;
+	qc_sources[i].enabled = 1;
+	qc_num_sources++;
+
+out:
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) int qc_unregister_source(const char *name) {
+	const char *const *dep;
+	struct qc_src_entry *e;
+	int i, rc = 0;
+
+	if (!name)
+		return -EINVAL;
+	pthread_mutex_lock(&qc_open_lock);
+	if ((e = qc_source_find(name)) == NULL) {
+		rc = -ENOENT;
+		goto out;
+	}
+	if (e->builtin) {
+		rc = -EPERM;
+		goto out;
+	}
+	for (i = 0; i < qc_num_sources; ++i) {
+		for (dep = qc_sources[i].src.depends; dep && *dep; ++dep) {
+			if (strcmp(*dep, name) == 0) {
+				rc = -EBUSY;
+				goto out;
+			}
+		}
+	}
+	for (i = e - qc_sources; i < qc_num_sources - 1; ++i)
+		qc_sources[i] = qc_sources[i + 1];
+	qc_num_sources--;
+
+out:
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) int qc_enable_source(const char *name, int enable) {
+	struct qc_src_entry *e;
+	int rc = 0;
+
+	if (!name)
+		return -EINVAL;
+	pthread_mutex_lock(&qc_open_lock);
+	if ((e = qc_source_find(name)) == NULL)
+		rc = -ENOENT;
+	else if (e->builtin == &sysinfo && !enable)
+		rc = -EPERM;
+	else
+		e->enabled = !!enable;
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) int qc_get_sources(struct qc_source_info *out, int max) {
+	struct qc_src_entry *e;
+	int i, num;
+
+	if (max < 0 || (max > 0 && !out))
+		return -EINVAL;
+	pthread_mutex_lock(&qc_open_lock);
+	for (i = 0; i < qc_num_sources && i < max; ++i) {
+		e = &qc_sources[i];
+		out[i].name = e->src.name;
+		out[i].priority = e->src.priority;
+		out[i].enabled = e->enabled;
+		out[i].builtin = e->builtin != NULL;
+		out[i].calls = e->calls;
+		out[i].ns = e->ns;
+	}
+	num = qc_num_sources;
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return num;
+}
+
+/* Reads /proc/sysinfo and compares it to '*prev', which is replaced if changed. Returns 0 if unchanged, 1 if changed
+   or running on a dump, where only a full qc_open() picks up changes, and <0 in case of an error. */
+int qc_sysinfo_changed(char **prev) {
+	char *cur = NULL;
+	int rc = 1;
+
+	pthread_mutex_lock(&qc_open_lock);
+	if (qc_dbg_use_dump)
+		goto out;
+	if (sysinfo.open(NULL, &cur)) {
+		rc = -1;
+		goto out;
+	}
+	if (*prev && strcmp(*prev, cur) == 0) {
+		rc = 0;
+		goto out;
+	}
+	free(*prev);
+	*prev = cur;
+	cur = NULL;
+
+out:
+	sysinfo.close(NULL, cur);
+	pthread_mutex_unlock(&qc_open_lock);
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) void qc_close(void *hdl) {
+	pthread_mutex_lock(&qc_open_lock);
+	qc_close_locked(hdl);
+	pthread_mutex_unlock(&qc_open_lock);
 }
 
 __attribute__ ((visibility ("default"))) int qc_get_num_layers(void *cfg, int *rc) {
@@ -952,7 +1466,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_string(void *cfg,
 	int rc;
 
 	*value = NULL;
-	if (qc_hdl_verify(cfg, "qc_get_attribute_string"))
+	if (qc_hdl_verify_src(cfg, "qc_get_attribute_string"))
 		return -4;
 	hdl = qc_get_layer_handle(cfg, layer);
 	qc_debug(cfg, "qc_get_attribute_string(attr=%d, layer=%d)\n", id, layer);
@@ -972,6 +1486,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_string(void *cfg,
 	}
 	if (qc_is_attr_set_string(hdl, id) <= 0) {
 		qc_debug(cfg, "Attr '%s' not defined\n", qc_attr_id_to_char(cfg, id));
+		qc_probe3(attr__miss, cfg, id, layer);
 		rc = 0;
 		goto out;
 	}
@@ -989,7 +1504,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_int(void *cfg, enu
 	int rc;
 
 	*value = -EINVAL;
-	if (qc_hdl_verify(cfg, "qc_get_attribute_int"))
+	if (qc_hdl_verify_src(cfg, "qc_get_attribute_int"))
 		return -4;
 	hdl = qc_get_layer_handle(cfg, layer);
 	qc_debug(cfg, "qc_get_attribute_int(attr=%d, layer=%d)\n", id, layer);
@@ -1010,6 +1525,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_int(void *cfg, enu
 	// Attribute value not set - let's figure out why
 	if (qc_is_attr_set_int(hdl, id) <= 0) {
 		qc_debug(cfg, "Attr '%s' not defined\n", qc_attr_id_to_char(cfg, id));
+		qc_probe3(attr__miss, cfg, id, layer);
 		rc = 0;
 		goto out;
 	}
@@ -1031,7 +1547,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_float(void *cfg, e
 	int rc;
 
 	*value = -EINVAL;
-	if (qc_hdl_verify(cfg, "qc_get_attribute_float"))
+	if (qc_hdl_verify_src(cfg, "qc_get_attribute_float"))
 		return -4;
 	hdl = qc_get_layer_handle(cfg, layer);
 	qc_debug(cfg, "qc_get_attribute_float(attr=%d, layer=%d)\n", id, layer);
@@ -1052,6 +1568,7 @@ __attribute__ ((visibility ("default"))) int qc_get_attribute_float(void *cfg, e
 	// Attribute value not set - let's figure out why
 	if (qc_is_attr_set_float(hdl, id) <= 0) {
 		qc_debug(cfg, "Attr '%s' not defined\n", qc_attr_id_to_char(cfg, id));
+		qc_probe3(attr__miss, cfg, id, layer);
 		rc = 0;
 		goto out;
 	}
@@ -1066,32 +1583,622 @@ out:
 	return rc;
 }
 
-static void qc_start_object(int *jindent, int layer) {
-	printf("%*s\"Layer %d\": {\n", *jindent, "", layer);
+__attribute__ ((visibility ("default"))) int qc_set_attribute_int(void *cfg, enum qc_attr_id id, int layer, int value) {
+	struct qc_handle *hdl;
+	int rc;
+
+	if (!cfg || cfg != qc_src_hdl)
+		return -EPERM;
+	if (!qc_is_attr_id_valid(id) || id == qc_layer_type_num || id == qc_layer_category_num ||
+	    (hdl = qc_get_layer_handle(cfg, layer)) == NULL)
+		return -EINVAL;
+	qc_debug(cfg, "qc_set_attribute_int(attr=%d, layer=%d, value=%d)\n", id, layer, value);
+	rc = qc_set_attr_int(hdl, id, value, ATTR_SRC_EXTERNAL);
+
+	return rc == -2 ? -EEXIST : (rc ? -EINVAL : 0);
+}
+
+__attribute__ ((visibility ("default"))) const char *qc_attr_name(enum qc_attr_id id) {
+	return qc_attr_id_to_char(NULL, id);
+}
+
+__attribute__ ((visibility ("default"))) int qc_attr_from_name(const char *name) {
+	int id;
+
+	if (!name || (id = qc_attr_char_to_id(name, strlen(name))) < 0)
+		return -EINVAL;
+
+	return id;
+}
+
+__attribute__ ((visibility ("default"))) int qc_attr_get_info(enum qc_attr_id id, struct qc_attr_info *info) {
+	if (!info || qc_attr_get_meta(id, info))
+		return -EINVAL;
+
+	return 0;
+}
+
+__attribute__ ((visibility ("default"))) int qc_get_layer_attrs(void *cfg, int layer, enum qc_attr_id *ids, int *types, int max) {
+	struct qc_handle *hdl;
+	int rc;
+
+	if (qc_hdl_verify(cfg, "qc_get_layer_attrs"))
+		return -EFAULT;
+	qc_debug(cfg, "qc_get_layer_attrs(layer=%d, max=%d)\n", layer, max);
+	qc_debug_indent_inc();
+	if ((hdl = qc_get_layer_handle(cfg, layer)) == NULL || max < 0 || (max > 0 && !ids)) {
+		rc = -EINVAL;
+		goto out;
+	}
+	rc = qc_get_attrs(hdl, ids, types, max);
+
+out:
+	qc_debug(cfg, "Return rc=%d\n", rc);
+	qc_debug_indent_dec();
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) int qc_check_consistency(void *cfg, struct qc_violation *out, int max) {
+	int rc;
+
+	if (qc_hdl_verify(cfg, "qc_check_consistency"))
+		return -EFAULT;
+	qc_debug(cfg, "qc_check_consistency(max=%d)\n", max);
+	qc_debug_indent_inc();
+	if (max < 0 || (max > 0 && !out)) {
+		rc = -EINVAL;
+		goto out;
+	}
+	rc = qc_check_rules(cfg, out, max, 1, 0);
+
+out:
+	qc_debug(cfg, "Return rc=%d\n", rc);
+	qc_debug_indent_dec();
+
+	return rc;
+}
+
+// Returns the event type that a change of integer attribute 'id' is reported as, or 0 if none
+static int qc_diff_event_type(int id) {
+	switch (id) {
+	case qc_num_cpu_total:
+	case qc_num_cpu_configured:
+	case qc_num_cpu_standby:
+	case qc_num_cpu_reserved:
+	case qc_num_cpu_dedicated:
+	case qc_num_cpu_shared:
+	case qc_num_core_total:
+	case qc_num_core_configured:
+	case qc_num_core_standby:
+	case qc_num_core_reserved:
+	case qc_num_core_dedicated:
+	case qc_num_core_shared:
+	case qc_num_cp_total:
+	case qc_num_cp_dedicated:
+	case qc_num_cp_shared:
+	case qc_num_cp_threads:
+	case qc_num_ifl_total:
+	case qc_num_ifl_dedicated:
+	case qc_num_ifl_shared:
+	case qc_num_ifl_threads:
+	case qc_num_ziip_total:
+	case qc_num_ziip_dedicated:
+	case qc_num_ziip_shared:
+	case qc_num_ziip_threads:
+		return QC_EVENT_COUNT;
+	case qc_capping_num:
+	case qc_limithard_consumption:
+	case qc_cp_absolute_capping:
+	case qc_cp_capacity_cap:
+	case qc_cp_capped_capacity:
+	case qc_cp_dispatch_limithard:
+	case qc_cp_dispatch_type:
+	case qc_cp_limithard_cap:
+	case qc_cp_weight_capping:
+	case qc_ifl_absolute_capping:
+	case qc_ifl_capacity_cap:
+	case qc_ifl_capped_capacity:
+	case qc_ifl_dispatch_limithard:
+	case qc_ifl_dispatch_type:
+	case qc_ifl_limithard_cap:
+	case qc_ifl_weight_capping:
+	case qc_ziip_absolute_capping:
+	case qc_ziip_capacity_cap:
+	case qc_ziip_capped_capacity:
+	case qc_ziip_dispatch_limithard:
+	case qc_ziip_dispatch_type:
+	case qc_ziip_limithard_cap:
+	case qc_ziip_weight_capping:
+		return QC_EVENT_CAPPING;
+	case qc_capacity_adjustment_indication:
+	case qc_capacity_change_reason:
+		return QC_EVENT_CAPACITY;
+	}
+
+	return 0;
+}
+
+static int qc_diff_add(struct qc_event *out, int max, int num, int type, int layer, int attr, int old, int cur) {
+	if (num < max) {
+		out[num].type = type;
+		out[num].layer = layer;
+		out[num].attr = attr;
+		out[num].old_value = old;
+		out[num].new_value = cur;
+	}
+
+	return num + 1;
+}
+
+static int qc_diff_string(struct qc_handle *old, struct qc_handle *cur, enum qc_attr_id id) {
+	char *o = qc_get_attr_value_string(old, id), *c = qc_get_attr_value_string(cur, id);
+
+	if (!o || !c)
+		return o != c;
+
+	return strcmp(o, c) != 0;
+}
+
+static int qc_diff_layer_type(struct qc_handle *root, int layer) {
+	int *etype;
+
+	if (layer >= root->num_layers || (etype = qc_get_attr_value_int(root->layers[layer], qc_layer_type_num)) == NULL)
+		return -1;
+
+	return *etype;
+}
+
+// A guest was migrated if it kept its name, but runs on a different CEC or in a different host
+static int qc_diff_lgm(struct qc_handle *old, struct qc_handle *cur) {
+	struct qc_handle *otop, *ctop;
+	int i;
+
+	if (old->num_layers < 2 || cur->num_layers < 2)
+		return 0;
+	otop = old->layers[old->num_layers - 1];
+	ctop = cur->layers[cur->num_layers - 1];
+	if (qc_diff_layer_type(old, old->num_layers - 1) != qc_diff_layer_type(cur, cur->num_layers - 1) ||
+	    qc_diff_string(otop, ctop, qc_layer_name))
+		return 0;
+	if (qc_diff_string(old, cur, qc_type) || qc_diff_string(old, cur, qc_sequence_code))
+		return 1;
+	if (old->num_layers != cur->num_layers)
+		return 0;
+	for (i = 1; i < old->num_layers - 1; ++i) {
+		if (qc_diff_layer_type(old, i) == qc_diff_layer_type(cur, i) &&
+		    qc_diff_string(old->layers[i], cur->layers[i], qc_layer_name))
+			return 1;
+	}
+
+	return 0;
+}
+
+__attribute__ ((visibility ("default"))) int qc_diff(void *cfg_old, void *cfg_cur, int mask, struct qc_event *out, int max) {
+	int *ovals[qc_secure + 1], *cvals[qc_secure + 1], i, id, otype, ctype, ov, cv, common, num = 0;
+	struct qc_handle *old = cfg_old, *cur = cfg_cur;
+	char srcs[qc_secure + 1];
+
+	if (qc_hdl_verify(old, "qc_diff") || qc_hdl_verify(cur, "qc_diff"))
+		return -EFAULT;
+	qc_debug(cur, "qc_diff(old=%p, mask=0x%x, max=%d)\n", old, mask, max);
+	qc_debug_indent_inc();
+	if (max < 0 || (max > 0 && !out)) {
+		num = -EINVAL;
+		goto out;
+	}
+	if ((mask & QC_EVENT_LGM) && qc_diff_lgm(old, cur))
+		num = qc_diff_add(out, max, num, QC_EVENT_LGM, -1, -1, 0, 0);
+	// attributes are only comparable in the layers below the first change in topology
+	for (common = 0; common < old->num_layers || common < cur->num_layers; ++common) {
+		otype = qc_diff_layer_type(old, common);
+		ctype = qc_diff_layer_type(cur, common);
+		if (otype != ctype) {
+			if (mask & QC_EVENT_TOPOLOGY)
+				num = qc_diff_add(out, max, num, QC_EVENT_TOPOLOGY, common, qc_layer_type_num, otype, ctype);
+			break;
+		}
+	}
+	for (i = 0; i < common; ++i) {
+		qc_get_attr_int_slots(old->layers[i], ovals, srcs);
+		qc_get_attr_int_slots(cur->layers[i], cvals, srcs);
+		for (id = 0; id <= qc_secure; ++id) {
+			// attributes that are not set count as 0
+			ov = ovals[id] ? *ovals[id] : 0;
+			cv = cvals[id] ? *cvals[id] : 0;
+			if ((qc_diff_event_type(id) & mask) && ov != cv)
+				num = qc_diff_add(out, max, num, qc_diff_event_type(id), i, id, ov, cv);
+		}
+	}
+
+out:
+	qc_debug(cur, "Return rc=%d\n", num);
+	qc_debug_indent_dec();
+
+	return num;
+}
+
+__attribute__ ((visibility ("default"))) int qc_get_stats(void *cfg, struct qc_stats *stats) {
+	struct qc_handle *hdl = cfg;
+
+	if (qc_hdl_verify(cfg, "qc_get_stats"))
+		return -EFAULT;
+	if (!stats)
+		return -EINVAL;
+	if (hdl->stats)
+		memcpy(stats, hdl->stats, sizeof(*stats));
+	else
+		memset(stats, 0, sizeof(*stats));
+
+	return 0;
+}
+
+/* Tokens are composed of the topology (32 bits), layer (8 bits), index in the attribute list (8 bits),
+   offset in the layer (12 bits) and type (4 bits) */
+#define QC_TOKEN(topology, layer, idx, offset, type)	((unsigned long long)(topology) | \
+							 (unsigned long long)(layer) << 32 | \
+							 (unsigned long long)(idx) << 40 | \
+							 (unsigned long long)(offset) << 48 | \
+							 (unsigned long long)(type) << 60)
+
+__attribute__ ((visibility ("default"))) int qc_resolve(void *cfg, int layer, enum qc_attr_id id, unsigned long long *token) {
+	struct qc_handle *hdl;
+	int rc = 0, idx, type, offset;
+
+	if (qc_hdl_verify(cfg, "qc_resolve"))
+		return -EFAULT;
+	qc_debug(cfg, "qc_resolve(attr=%d, layer=%d)\n", id, layer);
+	qc_debug_indent_inc();
+	if ((hdl = qc_get_layer_handle(cfg, layer)) == NULL || !qc_is_attr_id_valid(id) ||
+	    (idx = qc_get_attr_slot(hdl, id, &type, &offset)) < 0) {
+		qc_debug(cfg, "Attr not defined\n");
+		qc_probe3(attr__miss, cfg, id, layer);
+		rc = -EINVAL;
+		goto out;
+	}
+	if (layer > 0xff || idx > 0xff || offset > 0xfff) {
+		qc_debug(cfg, "Error: Attr cannot be represented in a token\n");
+		rc = -ERANGE;
+		goto out;
+	}
+	*token = QC_TOKEN(((struct qc_handle *)cfg)->topology, layer, idx, offset, type);
+
+out:
+	qc_debug(cfg, "Return rc=%d\n", rc);
+	qc_debug_indent_dec();
+
+	return rc;
+}
+
+// Returns the layer that 'token' refers to, or NULL if 'token' does not match 'hdl' or 'type'
+static inline struct qc_handle *qc_token_layer(struct qc_handle *hdl, unsigned long long token, int type) {
+	unsigned int layer = (token >> 32) & 0xff;
+
+	if ((((unsigned int)token ^ hdl->topology) | ((token >> 60) ^ type) | (layer >= hdl->num_layers)) != 0)
+		return NULL;
+
+	return hdl->layers[layer];
+}
+
+// Returns a pointer to the value of the attribute that 'token' refers to, or NULL if not set
+static inline void *qc_token_value(struct qc_handle *hdl, unsigned long long token) {
+	return hdl->attr_present[(token >> 40) & 0xff] ? (char *)hdl->layer + ((token >> 48) & 0xfff) : NULL;
+}
+
+__attribute__ ((visibility ("default"))) int qc_read_int(void *cfg, unsigned long long token, int *value) {
+	struct qc_handle *hdl;
+	int *ptr;
+
+	if ((hdl = qc_token_layer(cfg, token, QC_ATTR_TYPE_INT)) == NULL)
+		return -ESTALE;
+	if ((ptr = qc_token_value(hdl, token)) == NULL)
+		return 0;
+	*value = *ptr;
+
+	return 1;
+}
+
+__attribute__ ((visibility ("default"))) int qc_read_float(void *cfg, unsigned long long token, float *value) {
+	struct qc_handle *hdl;
+	float *ptr;
+
+	if ((hdl = qc_token_layer(cfg, token, QC_ATTR_TYPE_FLOAT)) == NULL)
+		return -ESTALE;
+	if ((ptr = qc_token_value(hdl, token)) == NULL)
+		return 0;
+	*value = *ptr;
+
+	return 1;
+}
+
+__attribute__ ((visibility ("default"))) int qc_read_string(void *cfg, unsigned long long token, const char **value) {
+	struct qc_handle *hdl;
+
+	if ((hdl = qc_token_layer(cfg, token, QC_ATTR_TYPE_STRING)) == NULL)
+		return -ESTALE;
+	*value = qc_token_value(hdl, token);
+
+	return *value != NULL;
+}
+
+static void qc_start_object(struct qc_bin *b, int *jindent, int layer, int flags) {
+	if (flags & QC_JSON_COMPACT)
+		qc_bin_printf(b, "\"Layer %d\":{", layer);
+	else
+		qc_bin_printf(b, "%*s\"Layer %d\": {\n", *jindent, "", layer);
 	*jindent += 2;
 }
-static void qc_end_object(int *jindent, int final) {
+
+static void qc_end_object(struct qc_bin *b, int *jindent, int final, int flags) {
 	*jindent -= 2;
-	printf("%*s}%s\n", *jindent, "", (final ? "" : ","));
+	if (flags & QC_JSON_COMPACT)
+		qc_bin_printf(b, "}%s", (final ? "" : ","));
+	else
+		qc_bin_printf(b, "%*s}%s\n", *jindent, "", (final ? "" : ","));
 }
 
-__attribute__ ((visibility ("default"))) void qc_export_json(void *cfg) {
+static int qc_write_fd(int fd, const char *buf, size_t len) {
+	ssize_t lrc;
+
+	while (len > 0) {
+		lrc = write(fd, buf, len);
+		if (lrc == -1) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		buf += lrc;
+		len -= lrc;
+	}
+
+	return 0;
+}
+
+__attribute__ ((visibility ("default"))) int qc_export_json_ex(void *cfg, struct qc_json_target *target, int flags) {
 	struct qc_handle *hdl = (struct qc_handle *)cfg;
 	int jindent = 0;	// indent for json output
-	int i;
+	struct qc_bin b;
+	int i, rc = 0;
+
+	if (qc_hdl_verify(cfg, "qc_export_json_ex"))
+		return -EFAULT;
+	if (!target)
+		return -EINVAL;
+	qc_debug(cfg, "qc_export_json_ex(type=%d, flags=%d)\n", target->type, flags);
+	qc_debug_indent_inc();
+	memset(&b, 0, sizeof(b));
+	qc_bin_put(&b, flags & QC_JSON_COMPACT ? "{" : "{\n", flags & QC_JSON_COMPACT ? 1 : 2);
+	jindent += 2;
+	for (hdl = hdl->root, i = 0; hdl != NULL; hdl = hdl->next, i++) {
+		qc_start_object(&b, &jindent, i, flags);
+		qc_attrs_to_json(hdl, &b, jindent, flags, target->attrs, target->num_attrs);
+		qc_end_object(&b, &jindent, hdl->next == NULL, flags);
+	}
+	qc_bin_put(&b, flags & QC_JSON_COMPACT ? "}" : "}\n", flags & QC_JSON_COMPACT ? 1 : 2);
+	if (b.err) {
+		qc_debug(cfg, "Error: Failed to allocate buffer\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+	target->len = b.len;
+	switch (target->type) {
+	case QC_JSON_TARGET_BUFFER:
+		if (!target->buf || target->size < b.len + 1) {
+			rc = -ENOSPC;
+			break;
+		}
+		memcpy(target->buf, b.buf, b.len);
+		target->buf[b.len] = '\0';
+		break;
+	case QC_JSON_TARGET_FILE:
+		if (fwrite(b.buf, 1, b.len, target->fp) != b.len)
+			rc = -EIO;
+		break;
+	case QC_JSON_TARGET_FD:
+		rc = qc_write_fd(target->fd, b.buf, b.len);
+		break;
+	default:
+		rc = -EINVAL;
+	}
 
-	if (!hdl)
+out:
+	qc_bin_free(&b);
+	qc_debug(cfg, "Return rc=%d, len=%zd\n", rc, target->len);
+	qc_debug_indent_dec();
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) void qc_export_json(void *cfg) {
+	struct qc_json_target target;
+
+	if (!cfg)
 		return;
+	memset(&target, 0, sizeof(target));
+	target.type = QC_JSON_TARGET_FILE;
+	target.fp = stdout;
+	qc_export_json_ex(cfg, &target, 0);
 
-	printf("{\n");
-	jindent += 2;
+	return;
+}
+
+/* Binary snapshot format, all integers are big endian:
+   - header, see struct qc_bin_hdr
+   - string table: 'num_strs' strings, each a 16 bit length followed by the characters
+   - 'num_layers' layers, each consisting of
+       - 16 bit layer type, see enum qc_layer_types
+       - bitmap with 'num_ids' bits, where bit i of Byte i/8 indicates whether
+	 attribute i (see enum qc_attr_id) is set
+       - for each attribute set in ascending order: 8 bit source (see ATTR_SRC_*),
+	 followed by 32 bit value for integers and floats (IEEE 754), or 16 bit index
+	 into the string table for strings */
+#define QC_BIN_MAGIC	"QCLIBSNP"
+#define QC_BIN_VERSION	1
+
+struct qc_bin_hdr {
+	char	magic[8];
+	__u16	version;
+	__u16	num_layers;
+	__u16	num_ids;
+	__u16	num_strs;
+	__u32	len;		// total length including header
+} __attribute__ ((packed));
+
+__attribute__ ((visibility ("default"))) int qc_export_binary(void *cfg, void *buf, size_t *size) {
+	struct qc_handle *hdl = (struct qc_handle *)cfg;
+	struct qc_bin layers, out;
+	struct qc_bin_hdr hdr;
+	int i, j, rc = 0;
+	size_t len;
+
+	if (qc_hdl_verify(cfg, "qc_export_binary"))
+		return -EFAULT;
+	qc_debug(cfg, "qc_export_binary()\n");
+	qc_debug_indent_inc();
+	memset(&layers, 0, sizeof(layers));
+	memset(&out, 0, sizeof(out));
 	for (hdl = hdl->root, i = 0; hdl != NULL; hdl = hdl->next, i++) {
-		qc_start_object(&jindent, i);
-		qc_print_attrs_json(hdl, jindent);
-		qc_end_object(&jindent, hdl->next == NULL);
+		qc_bin_put_u16(&layers, *qc_get_attr_value_int(hdl, qc_layer_type_num));
+		qc_attrs_to_binary(hdl, &layers);
+	}
+	// string table
+	for (j = 0; j < layers.num_strs; ++j) {
+		qc_bin_put_u16(&out, strlen(layers.strs[j]));
+		qc_bin_put(&out, layers.strs[j], strlen(layers.strs[j]));
+	}
+	if (layers.err || out.err) {
+		qc_debug(cfg, "Error: Failed to allocate buffer\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+	len = sizeof(hdr) + out.len + layers.len;
+	if (!buf || *size < len) {
+		qc_debug(cfg, "Buffer of %zd Bytes too small, %zd Bytes required\n", buf ? *size : 0, len);
+		*size = len;
+		rc = -ENOSPC;
+		goto out;
 	}
+	memcpy(hdr.magic, QC_BIN_MAGIC, sizeof(hdr.magic));
+	hdr.version = htobe16(QC_BIN_VERSION);
+	hdr.num_layers = htobe16(i);
+	hdr.num_ids = htobe16(QC_ATTR_ID_MAX + 1);
+	hdr.num_strs = htobe16(layers.num_strs);
+	hdr.len = htobe32(len);
+	memcpy(buf, &hdr, sizeof(hdr));
+	memcpy((char *)buf + sizeof(hdr), out.buf, out.len);
+	memcpy((char *)buf + sizeof(hdr) + out.len, layers.buf, layers.len);
+	*size = len;
 
-	printf("}\n");
+out:
+	qc_bin_free(&layers);
+	qc_bin_free(&out);
+	qc_debug(cfg, "Return rc=%d, size=%zd\n", rc, *size);
+	qc_debug_indent_dec();
 
-	return;
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) void *qc_import_binary(const void *buf, size_t size, int *rc) {
+	struct qc_handle *hdl = NULL, *prev = NULL, *layer;
+	const struct qc_bin_hdr *hdr = buf;
+	struct qc_bin_str *strs = NULL;
+	const char *data = buf;
+	int i, num_strs = 0;
+	size_t off, len;
+	__u16 u;
+
+	*rc = 0;
+	qc_debug(NULL, "qc_import_binary()\n");
+	qc_debug_indent_inc();
+	if (!buf || size < sizeof(*hdr) || memcmp(hdr->magic, QC_BIN_MAGIC, sizeof(hdr->magic)) ||
+	    be16toh(hdr->version) != QC_BIN_VERSION || be32toh(hdr->len) > size) {
+		qc_debug(NULL, "Error: Not a snapshot of a supported version\n");
+		*rc = -EINVAL;
+		goto out;
+	}
+	len = be32toh(hdr->len);
+	off = sizeof(*hdr);
+	num_strs = be16toh(hdr->num_strs);
+	if ((strs = malloc(num_strs * sizeof(*strs) + 1)) == NULL) {
+		*rc = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < num_strs; ++i) {
+		if (off + sizeof(u) > len)
+			goto err_trunc;
+		memcpy(&u, data + off, sizeof(u));
+		strs[i].len = be16toh(u);
+		strs[i].str = data + off + sizeof(u);
+		off += sizeof(u) + strs[i].len;
+		if (off > len)
+			goto err_trunc;
+	}
+	for (i = 0; i < be16toh(hdr->num_layers); ++i) {
+		if (off + sizeof(u) > len)
+			goto err_trunc;
+		memcpy(&u, data + off, sizeof(u));
+		off += sizeof(u);
+		layer = NULL;
+		if (qc_hdl_new(prev, &layer, i, be16toh(u))) {
+			*rc = -EINVAL;
+			goto out;
+		}
+		if (prev)
+			prev->next = layer;
+		else
+			hdl = layer;
+		prev = layer;
+		if (qc_attrs_from_binary(layer, data, len, &off, be16toh(hdr->num_ids), strs, num_strs)) {
+			*rc = -EINVAL;
+			goto out;
+		}
+	}
+	if (!hdl) {
+		qc_debug(NULL, "Error: Snapshot contains no layers\n");
+		*rc = -EINVAL;
+		goto out;
+	}
+	if (qc_hdl_register(hdl))
+		*rc = -ENOMEM;
+	goto out;
+
+err_trunc:
+	qc_debug(NULL, "Error: Snapshot is truncated\n");
+	*rc = -EINVAL;
+out:
+	free(strs);
+	if (*rc && hdl) {
+		qc_hdl_prune(hdl);
+		free(hdl);
+		hdl = NULL;
+	}
+	qc_debug(hdl, "Return %p, rc=%d\n", hdl, *rc);
+	qc_debug_indent_dec();
+
+	return hdl;
 }
+
+__attribute__ ((visibility ("default"))) void *qc_import_json(const char *buf, size_t len, int *rc) {
+	struct qc_handle *hdl = NULL;
+
+	*rc = 0;
+	qc_debug(NULL, "qc_import_json()\n");
+	qc_debug_indent_inc();
+	if (!buf || qc_layers_from_json(buf, len, &hdl) || !hdl) {
+		qc_debug(NULL, "Error: Failed to parse JSON input\n");
+		*rc = -EINVAL;
+		goto out;
+	}
+	if (qc_hdl_register(hdl)) {
+		qc_hdl_prune(hdl);
+		free(hdl);
+		hdl = NULL;
+		*rc = -ENOMEM;
+	}
+out:
+	qc_debug(hdl, "Return %p, rc=%d\n", hdl, *rc);
+	qc_debug_indent_dec();
+
+	return hdl;
+}
+
@@ -5,6 +5,9 @@
 #ifndef QUERY_CAPACITY
 #define QUERY_CAPACITY
 
+#include <stddef.h>
+#include <stdio.h>
+
 #define QC_VERSION	"2.5.0"
 
 
@@ -32,6 +35,8 @@
  *            - <i>KVM Linux guests</i>: Requires Linux kernel 4.8 or higher in the KVM host.
  *            - <i>Linux LPAR</i>: Requires Linux kernel 4.15 or higher in the KVM host.
  *            - <i>zCX</i>: Requires z/OS 2.4 or higher.
+ *   - **X**: Set by a data source registered with qc_register_source(). Not
+ *            listed in the tables below, as any integer attribute can be set.
  *
  * Several letters indicate the order in which the value is attempted to be
  * acquired. If the extraction of the value in a later phase succeeds, it will
@@ -641,22 +646,38 @@ enum qc_attr_id {
  * - \c QC_DEBUG: Set to an integer value
  *   - >0 to enable logging to a file \c /tmp/qclib-XXXXXX or as specified by
  *     \c QC_DEBUG_FILE if set.
- *   - >1 to have data dumped to a directory named \c \<STEM\>.dump-XXX
+ *   - >1 to have data dumped to a file named \c \<STEM\>.dump-XXX
  *     on every qc_open() call (where STEM is \c /tmp/qclib-XXXXXX or as specified
  *     by \c QC_DEBUG_FILE if set.<br>
  *   To disable logging, either see qc_close(), or set \c QC_DEBUG to a value
  *   <=0 on the next qc_open() call.<BR>
- * - \c QC_DEBUG_FILE: Stem to use for log files and dump directories (see \c
+ * - \c QC_DEBUG_FILE: Stem to use for log files and dump files (see \c
  *   QC_DEBUG). Defaults to \c /tmp/qclib-XXXXXX.
- * - \c QC_AUTODUMP: Set to a value >0 to trigger a dump to a directory named
+ * - \c QC_AUTODUMP: Set to a value >0 to trigger a dump to a file named
  *   \c /tmp/qclib-XXXXXX.dump-XXX if an error is encountered within qc_open().<br>
  *   <b>Note</b>: This will also create an empty log file for technical reasons,
  *   unless \c QC_DEBUG was set to a value >0<BR>
  * - \c QC_USE_DUMP: To run with a previously generated dump instead of live data,
-     point this environment variable to a directory containing the dump data.
+     point this environment variable to a dump file, or to a directory containing
+     dump data as written by previous releases.
      Requires compilation with \c CONFIG_DUMP_READING set.
  * - \c QC_CHECK_CONSISTENCY: Check data for consistency. Recommended for debugging
  *   scenarios only.
+ * - \c QC_TRACE: Set to a value >0 to record log messages in an in-memory ring
+ *   buffer instead of writing each message to the log file. Messages are only
+ *   formatted when the ring is written out: to the log file (if any, see \c
+ *   QC_DEBUG) on qc_close() and when writing a dump, or anytime via
+ *   qc_trace_dump(). A value of 1 uses a ring of 1024 messages, larger values
+ *   specify the number of messages. Set to 0 to stop recording.
+ * - \c QC_TRACE_SIGNAL: Number of a signal that writes out the ring to the log
+ *   file, or to \c stderr if there is no log file. Requires \c QC_TRACE. As
+ *   signal handlers are restricted to async-signal-safe functions, timestamps
+ *   are written in seconds since the epoch, and field widths, precisions and
+ *   fractions of floating point values are omitted.
+ * - \c QC_INJECT_DELAY: Comma-separated list of \c \<source\>=\<microseconds\>
+ *   to delay reading the respective data source by, with sources \c hypfs and
+ *   \c sthyi, e.g. \c hypfs=5000,sthyi=2000. Simulates slow data sources for
+ *   stress tests.
  *
  * @see qc_close()
  *
@@ -671,6 +692,63 @@ enum qc_attr_id {
  */
 void *qc_open(int *rc);
 
+/**
+ * Raw data of the sources that qclib retrieves information from, as passed to
+ * qc_open_from_buffers(). Each source is optional: Set it to \c NULL if not
+ * available. All data is expected in the exact format as provided on the
+ * respective system, i.e. as read from the files listed below, or as returned
+ * by the \c STHYI instruction.
+ */
+struct qc_buffers {
+	/** Content of \c /proc/sysinfo. Mandatory. */
+	const char	*sysinfo;
+	/** Length of \c sysinfo in Bytes */
+	size_t		 sysinfo_len;
+	/** Content of \c s390_hypfs/diag_204 in \c debugfs */
+	const void	*diag_204;
+	/** Length of \c diag_204 in Bytes */
+	size_t		 diag_204_len;
+	/** Content of \c s390_hypfs/diag_2fc in \c debugfs */
+	const void	*diag_2fc;
+	/** Length of \c diag_2fc in Bytes */
+	size_t		 diag_2fc_len;
+	/** Response buffer of the \c STHYI instruction */
+	const void	*sthyi;
+	/** Length of \c sthyi in Bytes, usually 4096 */
+	size_t		 sthyi_len;
+	/** Content of \c /sys/firmware/ocf/cpc_name */
+	const char	*cpc_name;
+	/** Length of \c cpc_name in Bytes */
+	size_t		 cpc_name_len;
+	/** Content of \c /sys/firmware/ipl/has_secure */
+	const char	*has_secure;
+	/** Length of \c has_secure in Bytes */
+	size_t		 has_secure_len;
+	/** Content of \c /sys/firmware/ipl/secure */
+	const char	*secure;
+	/** Length of \c secure in Bytes */
+	size_t		 secure_len;
+};
+
+/**
+ * Like qc_open(), but processes raw data previously collected on an arbitrary
+ * system instead of retrieving live data, e.g. to analyze data of many
+ * systems centrally. The filesystem is not accessed (unless dumping is
+ * requested via \c QC_DEBUG or \c QC_AUTODUMP), and \c QC_USE_DUMP is
+ * ignored.<BR>
+ * The buffers are only accessed during the call and can be released
+ * afterwards.<BR>
+ * qc_open(), qc_open_from_buffers() and qc_close() are thread-safe with respect
+ * to each other, though calls are serialized internally.
+ *
+ * @see qc_open()
+ *
+ * @param bufs Raw data to process.
+ * @param rc Return parameter indicating the return code, see qc_open().
+ * @return Returns a configuration handle, see qc_open().
+ */
+void *qc_open_from_buffers(const struct qc_buffers *bufs, int *rc);
+
 /**
  * Closes the configuration handle and releases all memory allocated when the
  * configuration was opened. The configuration handle is invalid after
@@ -686,6 +764,192 @@ void *qc_open(int *rc);
  */
 void qc_close(void *hdl);
 
+/** Acquisition steps of qc_open_interest() as planned by qc_interest_plan() */
+enum qc_plan_steps {
+	/** Read \c /proc/sysinfo. Always part of the plan, as it defines the layers. */
+	QC_PLAN_SYSINFO = 0x1,
+	/** Read hypfs data (diag 204 or diag 2fc) */
+	QC_PLAN_HYPFS = 0x2,
+	/** Run the \c STHYI instruction */
+	QC_PLAN_STHYI = 0x4,
+	/** Read attributes in \c /sys/firmware */
+	QC_PLAN_SYSFS = 0x8,
+	/** Aggregate the weights of all LPARs in hypfs data for the weight-based capping of an LPAR */
+	QC_PLAN_HYPFS_WEIGHTS = 0x10,
+	/** All of the above, i.e. the default plan */
+	QC_PLAN_ALL = 0x1f,
+};
+
+/**
+ * Determines the data sources and processing steps that qc_open_interest()
+ * requires for the attributes in \p ids. E.g. data from hypfs and \c STHYI
+ * is not required if only attributes from \c /proc/sysinfo like
+ * #qc_num_core_configured are of interest.
+ *
+ * @param ids Attributes of interest. Can be \c NULL if \p num is 0.
+ * @param num Number of entries in \p ids. Pass 0 for interest in all
+ * attributes.
+ * @return Returns the plan as a combination of enum #qc_plan_steps, or <0 in
+ * case of an error, e.g. \c -EINVAL for an invalid attribute.
+ */
+int qc_interest_plan(const enum qc_attr_id *ids, int num);
+
+/**
+ * Like qc_open(), or qc_open_from_buffers() if \p bufs is set, but retrieves
+ * and processes only the data required for the attributes in \p ids as
+ * planned by qc_interest_plan(). Other calls of qc_open() in the process are
+ * not affected.
+ *
+ * Attributes of interest are set as usual, while other attributes might not
+ * be set. Layers that are found in skipped data sources only, like LPAR
+ * groups and z/VM resource pools in hypfs and \c STHYI data, are missing.
+ * Whenever \c QC_DEBUG requests dumps, all data is retrieved regardless.
+ *
+ * @param bufs Data to use as in qc_open_from_buffers(), or \c NULL to use
+ * live data as in qc_open().
+ * @param ids Attributes of interest. Can be \c NULL if \p num is 0.
+ * @param num Number of entries in \p ids. Pass 0 for interest in all
+ * attributes.
+ * @param rc Return parameter as in qc_open(), or \c -EINVAL for invalid
+ * attributes.
+ * @return Returns a handle as in qc_open().
+ */
+void *qc_open_interest(const struct qc_buffers *bufs, const enum qc_attr_id *ids, int num, int *rc);
+
+/** Maximum number of data sources, including the built-in ones */
+#define QC_SOURCES_MAX		16
+
+/**
+ * Data source to register with qc_register_source(). qc_open() and
+ * qc_open_from_buffers() call the sources in the order of their priority:
+ * First \p open of all sources, followed by \p lgm_check, \p process,
+ * optionally \p dump, and finally \p close. All callbacks are called with
+ * a lock held that serializes qc_open() calls, and must not call qc_open(),
+ * qc_close() or any of the functions to manage data sources.
+ *
+ * The built-in sources are named \c "sysinfo" (priority 0), \c "hypfs" (100),
+ * \c "sthyi" (200) and \c "sysfs" (300). Layers are set up by the built-in
+ * sources only, and are complete in \p process of sources with a priority
+ * above 300.
+ *
+ * Within the callbacks, \p hdl can be passed to the qc_get_attribute_*()
+ * functions to read the attributes as set by sources called earlier, and to
+ * qc_set_attribute_int() to set attributes. All other functions reject it, as
+ * the configuration is incomplete.
+ */
+struct qc_source {
+	/** Unique name of the source */
+	const char	  *name;
+	/** Priority of the source, must be >0. Sources of equal priority are
+	    called in the order of their registration. */
+	int		   priority;
+	/** Names of the sources that must be called before this source,
+	    terminated by \c NULL, or \c NULL if there are none. If any of them
+	    is disabled or skipped, this source is skipped, too. */
+	const char *const *depends;
+	/** Passed to \p open unmodified */
+	void		  *arg;
+	/** Acquires the data of the source. Return 0 on success, or <0 to fail
+	    qc_open(). \p priv is passed to all other callbacks. */
+	int		 (*open)(void *hdl, void *arg, void **priv);
+	/** Sets the attributes. Return 0 on success, >0 to have qc_open() retry,
+	    e.g. in case of inconsistent data, or <0 to fail qc_open(). */
+	int		 (*process)(void *hdl, void *priv);
+	/** Optional. Called when \c QC_DEBUG requests a dump, see qc_open(). */
+	void		 (*dump)(void *hdl, void *priv);
+	/** Frees all resources acquired in \p open */
+	void		 (*close)(void *hdl, void *priv);
+	/** Optional. Return >0 if a Live Guest Migration happened since \p open
+	    to have qc_open() retry, 0 if not, or <0 to fail qc_open(). */
+	int		 (*lgm_check)(void *hdl, void *priv);
+};
+
+/**
+ * Registers a data source that is called by subsequent calls of qc_open()
+ * and qc_open_from_buffers() in the current process. The source is enabled
+ * initially, see qc_enable_source(). The strings in \p src must remain valid
+ * until the source is unregistered.
+ *
+ * @param src Source to register. Its content is copied.
+ * @return Returns 0 on success, or <0 in case of an error:
+ * - \c -EINVAL if a member of \p src is invalid, or any of the sources in
+ *   \p depends is not registered or has a priority that is not lower,
+ * - \c -EEXIST if a source of the same name is registered already,
+ * - \c -ENOSPC if #QC_SOURCES_MAX sources are registered already.
+ */
+int qc_register_source(const struct qc_source *src);
+
+/**
+ * Unregisters a data source registered with qc_register_source().
+ *
+ * @param name Name of the source.
+ * @return Returns 0 on success, or <0 in case of an error:
+ * - \c -ENOENT if no such source is registered,
+ * - \c -EPERM for built-in sources,
+ * - \c -EBUSY if another source depends on it.
+ */
+int qc_unregister_source(const char *name);
+
+/**
+ * Enables or disables a data source, including the built-in ones except for
+ * \c "sysinfo". Disabled sources and the sources depending on them are skipped
+ * by qc_open() and qc_open_from_buffers(), as are built-in sources that are
+ * not required per qc_open_interest().
+ *
+ * @param name Name of the source.
+ * @param enable 1 to enable the source, 0 to disable it.
+ * @return Returns 0 on success, or <0 in case of an error:
+ * - \c -ENOENT if no such source is registered,
+ * - \c -EPERM when attempting to disable \c "sysinfo".
+ */
+int qc_enable_source(const char *name, int enable);
+
+/** State of a data source as returned by qc_get_sources() */
+struct qc_source_info {
+	/** Name of the source */
+	const char		*name;
+	/** Priority of the source */
+	int			 priority;
+	/** 1 if enabled, 0 if disabled, see qc_enable_source() */
+	int			 enabled;
+	/** 1 for built-in sources, 0 for sources registered via qc_register_source() */
+	int			 builtin;
+	/** Number of times the source was opened */
+	unsigned long long	 calls;
+	/** Time spent in the callbacks of the source in nanoseconds, accumulated over all calls */
+	unsigned long long	 ns;
+};
+
+/**
+ * Retrieves all data sources in the order in which they are called.
+ *
+ * @param out Return parameter for the sources. Can be \c NULL if \p max is 0.
+ * The names remain valid until the respective source is unregistered.
+ * @param max Number of entries in \p out.
+ * @return Returns the number of sources, which can exceed \p max, in which
+ * case only the first \p max sources are returned, or <0 in case of an error.
+ */
+int qc_get_sources(struct qc_source_info *out, int max);
+
+/**
+ * Sets the integer attribute designated by \p id. Can only be called from
+ * within the \p process callback of a source registered with
+ * qc_register_source(). The value overwrites values set by sources called
+ * earlier, and is reported with source letter \c 'X'.
+ *
+ * @param hdl Handle as passed to the callback.
+ * @param id Attribute to set.
+ * @param layer Layer to set the attribute at.
+ * @param value Value to set.
+ * @return Returns 0 on success, or <0 in case of an error:
+ * - \c -EPERM if not called from within a callback,
+ * - \c -EINVAL if \p id or \p layer is invalid, or the attribute is not of
+ *   type integer or not available at the layer,
+ * - \c -EEXIST if the attribute is set to a different value already and
+ *   environment variable \c QC_CHECK_CONSISTENCY is set.
+ */
+int qc_set_attribute_int(void *hdl, enum qc_attr_id id, int layer, int value);
+
 /**
  * Get the number of layers.
  *
@@ -767,10 +1031,514 @@ int qc_get_attribute_int(void *hdl, enum qc_attr_id id, int layer, int *value);
  */
 int qc_get_attribute_float(void *hdl, enum qc_attr_id id, int layer, float *value);
 
+/** \enum qc_attr_types
+ * Data type of an attribute, i.e. which of qc_get_attribute_int(),
+ * qc_get_attribute_float() and qc_get_attribute_string() to use. */
+enum qc_attr_types {
+	/** Retrieve with qc_get_attribute_int() */
+	QC_ATTR_TYPE_INT = 0,
+	/** Retrieve with qc_get_attribute_float() */
+	QC_ATTR_TYPE_FLOAT = 1,
+	/** Retrieve with qc_get_attribute_string() */
+	QC_ATTR_TYPE_STRING = 2,
+};
+
+/**
+ * Metadata of an attribute, see qc_attr_get_info().
+ */
+struct qc_attr_info {
+	/** Name of the attribute as used in JSON output, e.g. \c "num_ifl_total" */
+	const char	*name;
+	/** Name of the value in enum #qc_attr_id, e.g. \c "qc_num_ifl_total" */
+	const char	*id_name;
+	/** Data type, see enum #qc_attr_types */
+	int		 type;
+	/** Value that represents one unit, e.g. \c 0x10000 for capping values where
+	    0x10000 equals one core, \c 1000 for #qc_adjustment, or \c 1 for plain values */
+	int		 scale;
+	/** Layer types featuring the attribute: Bit <tt>(1 << t)</tt> is set for each
+	    layer type \c t from enum #qc_layer_types */
+	unsigned int	 layer_types;
+};
+
+/**
+ * Returns the name of attribute \p id as used in JSON output.
+ *
+ * @param id Attribute.
+ * @return Returns the name, or \c NULL if \p id is invalid.
+ */
+const char *qc_attr_name(enum qc_attr_id id);
+
+/**
+ * Returns the attribute with name \p name, as returned by qc_attr_name(), or
+ * as of the respective value in enum #qc_attr_id, e.g. \c "qc_num_ifl_total".
+ *
+ * @param name Name of the attribute.
+ * @return Returns the attribute, or \c -EINVAL if there is no attribute with
+ * name \p name.
+ */
+int qc_attr_from_name(const char *name);
+
+/**
+ * Retrieves the metadata of attribute \p id.
+ *
+ * @param id Attribute.
+ * @param info Return parameter for the metadata.
+ * @return Returns 0 on success, or \c -EINVAL if \p id is invalid.
+ */
+int qc_attr_get_info(enum qc_attr_id id, struct qc_attr_info *info);
+
+/** Flag in the types returned by qc_get_layer_attrs(), indicating that the attribute is set */
+#define QC_ATTR_SET		0x100
+
+/**
+ * Lists the attributes that exist in layer \p layer, i.e. all attributes for
+ * which qc_get_attribute_int(), qc_get_attribute_float() or
+ * qc_get_attribute_string() can return a value. Allows iterating over the
+ * available data without probing every value of enum #qc_attr_id.
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param layer Specifies the layer, e.g.
+ * - 0: CEC layer information,
+ * - 1: LPAR layer information, etc.
+ * @param ids Return parameter for the attributes. Can be \c NULL if \p max is 0.
+ * @param types Return parameter for the data type of each attribute, see enum
+ * #qc_attr_types, OR'ed with #QC_ATTR_SET if the attribute is set. Can be
+ * \c NULL.
+ * @param max Number of entries in \p ids and \p types. Pass 0 to query the
+ * number of attributes only.
+ * @return Returns the number of attributes in the layer, which can exceed
+ * \p max, in which case only the first \p max attributes are returned,
+ * or <0 in case of an error.
+ */
+int qc_get_layer_attrs(void *hdl, int layer, enum qc_attr_id *ids, int *types, int max);
+
+/**
+ * Resolves attribute \p id of layer \p layer into a token for use with
+ * qc_read_int(), qc_read_float() or qc_read_string(), depending on the type of
+ * the attribute. All validation and lookups happen here once, making
+ * subsequent reads cheap.<br>
+ * A token remains valid for all handles with the same layer topology, i.e.
+ * the same sequence of layer types, like handles from subsequent calls of
+ * qc_open() on the same system. Reads with a handle of a different topology
+ * fail, indicating that the token needs to be resolved again.
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param layer Specifies the layer, e.g.
+ * - 0: CEC layer information,
+ * - 1: LPAR layer information, etc.
+ * @param id Attribute to resolve.
+ * @param token Return parameter for the token.
+ * @return Returns 0 on success, \c -EINVAL if the attribute does not exist at
+ * the specified layer, or <0 in case of any other error.
+ */
+int qc_resolve(void *hdl, int layer, enum qc_attr_id id, unsigned long long *token);
+
+/**
+ * Returns the integer attribute that \p token refers to. Unlike
+ * qc_get_attribute_int(), does not verify \p hdl, nor write any log output.
+ *
+ * @see qc_resolve()
+ *
+ * @param hdl Valid handle of the configuration to use.
+ * @param token Token as returned by qc_resolve().
+ * @param value Return parameter for the value.
+ * @return
+ * - >0 attribute is valid
+ * - 0 attribute is not set
+ * - \c -ESTALE if the topology of \p hdl does not match, or the attribute is
+ *   not of type integer
+ */
+int qc_read_int(void *hdl, unsigned long long token, int *value);
+
+/**
+ * Like qc_read_int(), but for attributes of type float.
+ *
+ * @see qc_resolve()
+ */
+int qc_read_float(void *hdl, unsigned long long token, float *value);
+
+/**
+ * Like qc_read_int(), but for attributes of type string.
+ *
+ * @see qc_resolve()
+ */
+int qc_read_string(void *hdl, unsigned long long token, const char **value);
+
+/** Kinds of consistency rules, see struct qc_violation */
+enum qc_rule_kinds {
+	/** The sum of all attributes but the last one is less than or equal to the last one */
+	QC_RULE_SUM_LE = 0,
+	/** The sum of all attributes but the last one equals the last one */
+	QC_RULE_SUM_EQ = 1,
+	/** Either the first and at least one of the other attributes are non-zero, or none (capped capacity) */
+	QC_RULE_CAPPED = 2,
+};
+
+/**
+ * Violation of a consistency rule as reported by qc_check_consistency().
+ */
+struct qc_violation {
+	/** Layer number, with 0 being the CEC layer */
+	int		 layer;
+	/** Type of the layer, see enum #qc_layer_types */
+	int		 layer_type;
+	/** Number of the rule. Identifies the same rule across handles of the same version of qclib. */
+	int		 rule;
+	/** Kind of the rule, see enum #qc_rule_kinds */
+	int		 kind;
+	/** Number of valid entries in \c attrs, \c values and \c sources */
+	int		 num_attrs;
+	/** Attributes that the rule verifies */
+	enum qc_attr_id	 attrs[4];
+	/** Values of the attributes, 0 if not set */
+	int		 values[4];
+	/** Sources of the values as in the '\c Src' column of enum #qc_attr_id, \c 'P' if post-processed,
+	    or \c '_' if not set */
+	char		 sources[4];
+};
+
+/**
+ * Verifies the consistency of the data in all layers, e.g. that the numbers
+ * of dedicated and shared IFLs add up to the total number of IFLs. Evaluates
+ * the same rules as qc_open() does when environment variable
+ * \c QC_CHECK_CONSISTENCY is set, but reports all violations instead of
+ * failing on the first one, and writes no log output for them.
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param out Return parameter for the violations. Can be \c NULL if \p max is 0.
+ * @param max Number of entries in \p out. Pass 0 to query the number of
+ * violations only.
+ * @return Returns the number of violations, which can exceed \p max, in which
+ * case only the first \p max violations are returned, or <0 in case of an
+ * error.
+ */
+int qc_check_consistency(void *hdl, struct qc_violation *out, int max);
+
+/** Phases of qc_open() as measured in struct qc_stats. For each data source,
+    the phases are consecutive in the order open, process, dump, close. */
+enum qc_stats_phases {
+	/** qc_open() or qc_open_from_buffers() as a whole, including retries */
+	QC_PHASE_OPEN = 0,
+	QC_PHASE_SYSINFO_OPEN = 1,
+	QC_PHASE_SYSINFO_PROCESS = 2,
+	QC_PHASE_SYSINFO_DUMP = 3,
+	QC_PHASE_SYSINFO_CLOSE = 4,
+	QC_PHASE_HYPFS_OPEN = 5,
+	QC_PHASE_HYPFS_PROCESS = 6,
+	QC_PHASE_HYPFS_DUMP = 7,
+	QC_PHASE_HYPFS_CLOSE = 8,
+	QC_PHASE_STHYI_OPEN = 9,
+	QC_PHASE_STHYI_PROCESS = 10,
+	QC_PHASE_STHYI_DUMP = 11,
+	QC_PHASE_STHYI_CLOSE = 12,
+	QC_PHASE_SYSFS_OPEN = 13,
+	QC_PHASE_SYSFS_PROCESS = 14,
+	QC_PHASE_SYSFS_DUMP = 15,
+	QC_PHASE_SYSFS_CLOSE = 16,
+	/** Live Guest Migration check */
+	QC_PHASE_LGM_CHECK = 17,
+	/** Post-processing of the data from all sources */
+	QC_PHASE_POST_PROCESSING = 18,
+	/** Consistency check, see qc_check_consistency() */
+	QC_PHASE_CONSISTENCY_CHECK = 19,
+	/** Number of phases */
+	QC_PHASE_NUM = 20,
+};
+
+/**
+ * Timings and I/O statistics as returned by qc_get_stats() and
+ * qc_get_global_stats().
+ */
+struct qc_stats {
+	/** Time spent in each phase in nanoseconds, indexed by enum #qc_stats_phases */
+	unsigned long long	phase_ns[QC_PHASE_NUM];
+	/** Number of times each phase was run */
+	unsigned long long	phase_count[QC_PHASE_NUM];
+	/** Bytes read from the data sources or dumps */
+	unsigned long long	bytes_read;
+	/** System calls issued to access the data sources or dumps */
+	unsigned long long	syscalls;
+	/** Reads of diag data via hypfs, each triggering a diagnose */
+	unsigned long long	diag_reads;
+	/** Reads of diag data repeated due to a too small buffer. The read of the
+	    data following an initial read of the header to learn the size is not
+	    counted. */
+	unsigned long long	diag_retries;
+	/** Attempts of qc_open() to gather data repeated due to inconsistent data */
+	unsigned long long	open_retries;
+	/** Live Guest Migrations detected while gathering data */
+	unsigned long long	lgm_detections;
+	/** Memory allocations for handles and data source buffers */
+	unsigned long long	allocations;
+};
+
+/**
+ * Retrieves the statistics of the qc_open() or qc_open_from_buffers() call
+ * that created \p hdl. All values are 0 for handles created otherwise, e.g.
+ * by qc_import_binary().
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param stats Return parameter for the statistics.
+ * @return Returns 0 on success, or <0 in case of an error.
+ */
+int qc_get_stats(void *hdl, struct qc_stats *stats);
+
+/**
+ * Retrieves the statistics accumulated over all calls of qc_open() and
+ * qc_open_from_buffers() in the current process. Can be called anytime,
+ * including concurrently to qc_open().
+ *
+ * @param stats Return parameter for the statistics.
+ */
+void qc_get_global_stats(struct qc_stats *stats);
+
+/**
+ * Writes the messages in the trace ring buffer (see environment variable
+ * \c QC_TRACE at qc_open()) to file descriptor \p fd in the format of the
+ * log file. Can be called anytime, including concurrently to other calls.
+ *
+ * @param fd File descriptor to write to.
+ * @return Returns the number of messages written, 0 if tracing was never
+ * enabled, or <0 in case of an error.
+ */
+int qc_trace_dump(int fd);
+
 /**
  * Prints the internal data in JSON format to stdout.
  * @param hdl Handle of the configuration to use.
  */
 void qc_export_json(void *hdl);
 
+/** Omit all whitespace in qc_export_json_ex() output */
+#define QC_JSON_COMPACT		0x1
+/** Emit numbers as JSON numbers in qc_export_json_ex() output instead of strings */
+#define QC_JSON_NATIVE		0x2
+
+/** Output types for qc_export_json_ex() */
+enum qc_json_target_types {
+	/** Write to a caller-provided buffer */
+	QC_JSON_TARGET_BUFFER = 0,
+	/** Write to a \c FILE stream */
+	QC_JSON_TARGET_FILE = 1,
+	/** Write to a file descriptor */
+	QC_JSON_TARGET_FD = 2,
+};
+
+/**
+ * Output target for qc_export_json_ex().
+ */
+struct qc_json_target {
+	/** Type of target, see enum #qc_json_target_types */
+	int		 type;
+	/** Buffer to write to for #QC_JSON_TARGET_BUFFER. Output is zero-terminated. */
+	char		*buf;
+	/** Size of \c buf in Bytes */
+	size_t		 size;
+	/** Returns the length of the output in Bytes, excluding the terminating zero Byte */
+	size_t		 len;
+	/** Stream to write to for #QC_JSON_TARGET_FILE */
+	FILE		*fp;
+	/** File descriptor to write to for #QC_JSON_TARGET_FD */
+	int		 fd;
+	/** Optional list of attributes to export. Set to \c NULL to export all attributes. */
+	const enum qc_attr_id *attrs;
+	/** Number of entries in \c attrs */
+	int		 num_attrs;
+};
+
+/**
+ * Like qc_export_json(), but writes to the specified target, with the
+ * output assembled in memory and written in one go.
+ *
+ * @see qc_export_json()
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param target Output target.
+ * @param flags Any combination of #QC_JSON_COMPACT and #QC_JSON_NATIVE, or 0 to
+ * produce the same output as qc_export_json().
+ * @return
+ * - 0 on success,
+ * - \c -ENOSPC if the buffer of a #QC_JSON_TARGET_BUFFER target is too small,
+ *   with \c len set to the required length, and
+ * - <0 in case of any other error.
+ */
+int qc_export_json_ex(void *hdl, struct qc_json_target *target, int flags);
+
+/**
+ * Serializes the configuration into a compact binary snapshot, which can be
+ * turned into a configuration handle again using qc_import_binary(), e.g.
+ * on a different system. The encoding is versioned and independent of
+ * endianness.
+ *
+ * @see qc_import_binary()
+ *
+ * @param hdl Handle of the configuration to use.
+ * @param buf Buffer to write the snapshot to. Pass \c NULL to query the required size.
+ * @param size Size of \c buf. Returns the size of the snapshot on success,
+ * or the required size if \c buf is too small.
+ * @return
+ * - 0 on success,
+ * - \c -ENOSPC if \c buf is too small or \c NULL, and
+ * - <0 in case of any other error.
+ */
+int qc_export_binary(void *hdl, void *buf, size_t *size);
+
+/**
+ * Creates a configuration handle from a snapshot written by qc_export_binary().
+ * The handle can be used with all functions like a handle returned by
+ * qc_open(), and has to be closed with qc_close().
+ *
+ * @see qc_export_binary()
+ *
+ * @param buf Snapshot data.
+ * @param size Size of \c buf.
+ * @param rc Return parameter indicating the return code. Set to
+ * - 0 on success, and
+ * - <0 in case of an error, e.g. \c -EINVAL if the snapshot is invalid.
+ * @return Returns a configuration handle, or NULL in case of an error.
+ */
+void *qc_import_binary(const void *buf, size_t size, int *rc);
+
+/**
+ * Creates a configuration handle from the JSON output of qc_export_json() or
+ * qc_export_json_ex(), with or without #QC_JSON_COMPACT and #QC_JSON_NATIVE.
+ * The input is parsed in place in a single pass. Unknown attributes are
+ * skipped, attributes with value \c null are left unset.
+ * The handle can be used with all functions like a handle returned by
+ * qc_open(), and has to be closed with qc_close().
+ *
+ * @see qc_export_json_ex()
+ *
+ * @param buf JSON data. Does not need to be zero-terminated.
+ * @param len Length of \c buf in Bytes.
+ * @param rc Return parameter indicating the return code. Set to
+ * - 0 on success, and
+ * - <0 in case of an error, e.g. \c -EINVAL if the input is invalid.
+ * @return Returns a configuration handle, or NULL in case of an error.
+ */
+void *qc_import_json(const char *buf, size_t len, int *rc);
+
+/** Types of events reported by qc_diff() and qc_watch(), usable as a bit mask */
+enum qc_event_types {
+	/** Layers were added or removed, or changed their type. \c layer is the lowest layer
+	    that differs, \c attr is #qc_layer_type_num, and the values are the layer types,
+	    or -1 if the layer does not exist. */
+	QC_EVENT_TOPOLOGY = 0x1,
+	/** The number of CPUs or cores of a type changed, e.g. due to cores being moved from
+	    standby to configured state. \c attr indicates the type and state, e.g. #qc_num_ifl_total. */
+	QC_EVENT_COUNT = 0x2,
+	/** Capping or weight of a layer changed, e.g. #qc_capping_num or #qc_ifl_weight_capping */
+	QC_EVENT_CAPPING = 0x4,
+	/** #qc_capacity_change_reason or #qc_capacity_adjustment_indication changed */
+	QC_EVENT_CAPACITY = 0x8,
+	/** A Live Guest Migration took place, i.e. the same guest runs on a different CEC,
+	    LPAR or hypervisor. \c layer and \c attr are -1. */
+	QC_EVENT_LGM = 0x10,
+	/** All of the above */
+	QC_EVENT_ALL = 0x1f,
+};
+
+/**
+ * Change between two configurations as reported by qc_diff() and qc_watch().
+ */
+struct qc_event {
+	/** Type of the event, see enum #qc_event_types */
+	int		 type;
+	/** Layer number, with 0 being the CEC layer, or -1 if not applicable */
+	int		 layer;
+	/** Attribute that changed as in enum #qc_attr_id, or -1 if not applicable */
+	int		 attr;
+	/** Previous value of the attribute, 0 if not set */
+	int		 old_value;
+	/** New value of the attribute, 0 if not set */
+	int		 new_value;
+};
+
+/**
+ * Compares two configurations and reports the differences as typed events,
+ * ordered by layer. Attributes are only compared in layers below a
+ * #QC_EVENT_TOPOLOGY event. Attributes that change on every call, like
+ * #qc_prorated_core_time, are ignored.
+ *
+ * @param old Handle of the previous configuration.
+ * @param cur Handle of the current configuration.
+ * @param mask Any combination of enum #qc_event_types to report.
+ * @param out Return parameter for the events. Can be \c NULL if \p max is 0.
+ * @param max Number of entries in \p out.
+ * @return Returns the number of events, which can exceed \p max, in which
+ * case only the first \p max events are returned, or <0 in case of an error.
+ */
+int qc_diff(void *old, void *cur, int mask, struct qc_event *out, int max);
+
+/**
+ * Callback for qc_watch(), called from the polling thread once per event.
+ *
+ * @param watch Handle returned by qc_watch().
+ * @param event The event.
+ * @param arg Argument passed to qc_watch().
+ */
+typedef void (*qc_watch_callback)(void *watch, const struct qc_event *event, void *arg);
+
+/**
+ * Watches the configuration for changes by polling it at a fixed interval in
+ * an internal thread, and reports changes as typed events like qc_diff() does.
+ * Initially, the configuration is read once, and no events are reported.
+ *
+ * Polling uses the cheapest sufficient data sources: If \p mask contains
+ * #QC_EVENT_CAPACITY and #QC_EVENT_LGM only, \c /proc/sysinfo is read first,
+ * and the full configuration is read via qc_open() only if it changed.
+ * When running on a dump, the full configuration is read on every poll.
+ *
+ * Events are reported via \p cb, or via \p efd, or both:
+ * - \p cb is called from the polling thread, and must not call qc_watch_poll()
+ *   or qc_unwatch() for the same watch.
+ * - If \p efd is an eventfd, the number of new events is added to its counter
+ *   whenever a poll found changes, and the events are queued to be retrieved
+ *   by qc_watch_read(). Events exceeding the queue length are dropped.
+ *
+ * @see qc_diff()
+ *
+ * @param interval Polling interval in milliseconds. Pass 0 to run no polling
+ * thread, in which case the caller polls via qc_watch_poll().
+ * @param mask Any combination of enum #qc_event_types to report.
+ * @param cb Callback to report events to, or \c NULL.
+ * @param arg Argument to pass to \p cb.
+ * @param efd eventfd to notify, or -1.
+ * @param rc Return parameter indicating the return code. Set to
+ * - 0 on success,
+ * - \c -EINVAL in case of invalid parameters, and
+ * - <0 in case of an error, e.g. the return code of qc_open() if reading the
+ *   configuration failed.
+ * @return Returns a watch handle, or NULL in case of an error.
+ */
+void *qc_watch(unsigned int interval, int mask, qc_watch_callback cb, void *arg, int efd, int *rc);
+
+/**
+ * Polls the configuration once and reports any changes, like the polling
+ * thread of qc_watch() does. Can be called concurrently to the polling thread.
+ *
+ * @param watch Handle returned by qc_watch().
+ * @return Returns the number of events reported, or <0 in case of an error,
+ * e.g. the return code of qc_open() if reading the configuration failed.
+ */
+int qc_watch_poll(void *watch);
+
+/**
+ * Retrieves and removes events queued for a watch with an eventfd, oldest first.
+ *
+ * @param watch Handle returned by qc_watch().
+ * @param out Return parameter for the events.
+ * @param max Number of entries in \p out.
+ * @return Returns the number of events retrieved, or <0 in case of an error.
+ */
+int qc_watch_read(void *watch, struct qc_event *out, int max);
+
+/**
+ * Stops the polling thread and releases all resources of a watch.
+ *
+ * @param watch Handle returned by qc_watch().
+ */
+void qc_unwatch(void *watch);
+
 #endif
@@ -0,0 +1,106 @@
+/* Copyright IBM Corp. 2026 */
+
+#ifndef QUERY_CAPACITY_ATTRS
+#define QUERY_CAPACITY_ATTRS
+
+/*
+ * Authoritative list of attribute metadata, with one entry per value of
+ * enum qc_attr_id, in numeric order:
+ *
+ *   QC_ATTR(id, name, type, scale, srcs)
+ *
+ * - name:  Name as used in JSON output and by qc_attr_from_name()
+ * - type:  INT, FLOAT or STRING, see enum qc_attr_types
+ * - scale: Value representing one unit, e.g. 0x10000 for attributes where
+ *          0x10000 equals one core, or 1 for plain values
+ * - srcs:  Data sources that set the attribute in any layer, or provide the
+ *          input for its post-processing, using the letters of the 'Src'
+ *          column in query_capacity.h. See qc_interest_plan().
+ *
+ * Expanded into the metadata table in query_capacity_data.c, into the lookup
+ * hash for names and enum value names by qc_gen_attrs at build time, and into
+ * the attribute traits of the C++ wrapper in qc.hpp. Layer types featuring an
+ * attribute are derived from the per-layer attribute lists.
+ */
+#define QC_ATTRS \
+	QC_ATTR(qc_adjustment,                     "adjustment",                     INT,    1000,    "S"   ) \
+	QC_ATTR(qc_capability,                     "capability",                     FLOAT,  1,       "S"   ) \
+	QC_ATTR(qc_capacity_adjustment_indication, "capacity_adjustment_indication", INT,    1,       "S"   ) \
+	QC_ATTR(qc_capacity_change_reason,         "capacity_change_reason",         INT,    1,       "S"   ) \
+	QC_ATTR(qc_capping,                        "capping",                        STRING, 1,       "H"   ) \
+	QC_ATTR(qc_capping_num,                    "capping_num",                    INT,    1,       "H"   ) \
+	QC_ATTR(qc_cluster_name,                   "cluster_name",                   STRING, 1,       "V"   ) \
+	QC_ATTR(qc_control_program_id,             "control_program_id",             STRING, 1,       "S"   ) \
+	QC_ATTR(qc_cp_absolute_capping,            "cp_absolute_capping",            INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_cp_capacity_cap,                "pool_cp_capacity_cap",           INT,    1,       "V"   ) \
+	QC_ATTR(qc_cp_capped_capacity,             "cp_capped_capacity",             INT,    0x10000, "V"   ) \
+	QC_ATTR(qc_cp_dispatch_limithard,          "cp_dispatch_limithard",          INT,    1,       "V"   ) \
+	QC_ATTR(qc_cp_dispatch_type,               "cp_dispatch_type",               INT,    1,       "V"   ) \
+	QC_ATTR(qc_cp_limithard_cap,               "pool_cp_limithard_cap",          INT,    1,       "V"   ) \
+	QC_ATTR(qc_cp_weight_capping,              "cp_weight_capping",              INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_limithard_consumption,          "limithard_consumption",          INT,    1,       "V"   ) \
+	QC_ATTR(qc_has_multiple_cpu_types,         "has_multiple_cpu_types",         INT,    1,       "V"   ) \
+	QC_ATTR(qc_ifl_absolute_capping,           "ifl_absolute_capping",           INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_ifl_capacity_cap,               "pool_ifl_capacity_cap",          INT,    1,       "V"   ) \
+	QC_ATTR(qc_ifl_capped_capacity,            "ifl_capped_capacity",            INT,    0x10000, "V"   ) \
+	QC_ATTR(qc_ifl_dispatch_limithard,         "ifl_dispatch_limithard",         INT,    1,       "V"   ) \
+	QC_ATTR(qc_ifl_dispatch_type,              "ifl_dispatch_type",              INT,    1,       "HV"  ) \
+	QC_ATTR(qc_ifl_limithard_cap,              "pool_ifl_limithard_cap",         INT,    1,       "V"   ) \
+	QC_ATTR(qc_ifl_weight_capping,             "ifl_weight_capping",             INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_layer_category,                 "layer_category",                 STRING, 1,       "S"   ) \
+	QC_ATTR(qc_layer_category_num,             "layer_category_num",             INT,    1,       "S"   ) \
+	QC_ATTR(qc_layer_extended_name,            "layer_extended_name",            STRING, 1,       "S"   ) \
+	QC_ATTR(qc_layer_name,                     "layer_name",                     STRING, 1,       "SHVF") \
+	QC_ATTR(qc_layer_type,                     "layer_type",                     STRING, 1,       "S"   ) \
+	QC_ATTR(qc_layer_type_num,                 "layer_type_num",                 INT,    1,       "S"   ) \
+	QC_ATTR(qc_layer_uuid,                     "layer_uuid",                     STRING, 1,       "S"   ) \
+	QC_ATTR(qc_manufacturer,                   "manufacturer",                   STRING, 1,       "SV"  ) \
+	QC_ATTR(qc_mobility_enabled,               "mobility_enabled",               INT,    1,       "V"   ) \
+	QC_ATTR(qc_model,                          "model",                          STRING, 1,       "S"   ) \
+	QC_ATTR(qc_model_capacity,                 "model_capacity",                 STRING, 1,       "S"   ) \
+	QC_ATTR(qc_num_cp_dedicated,               "num_cp_dedicated",               INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_cp_shared,                  "num_cp_shared",                  INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_cp_total,                   "num_cp_total",                   INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_cpu_configured,             "num_cpu_configured",             INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_cpu_dedicated,              "num_cpu_dedicated",              INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_cpu_reserved,               "num_cpu_reserved",               INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_cpu_shared,                 "num_cpu_shared",                 INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_cpu_standby,                "num_cpu_standby",                INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_cpu_total,                  "num_cpu_total",                  INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_ifl_dedicated,              "num_ifl_dedicated",              INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_ifl_shared,                 "num_ifl_shared",                 INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_ifl_total,                  "num_ifl_total",                  INT,    1,       "HV"  ) \
+	QC_ATTR(qc_partition_char,                 "partition_char",                 STRING, 1,       "S"   ) \
+	QC_ATTR(qc_partition_char_num,             "partition_char_num",             INT,    1,       "S"   ) \
+	QC_ATTR(qc_partition_number,               "partition_number",               INT,    1,       "SV"  ) \
+	QC_ATTR(qc_plant,                          "plant",                          STRING, 1,       "SV"  ) \
+	QC_ATTR(qc_secondary_capability,           "secondary_capability",           FLOAT,  1,       "S"   ) \
+	QC_ATTR(qc_sequence_code,                  "sequence_code",                  STRING, 1,       "SV"  ) \
+	QC_ATTR(qc_type,                           "type",                           STRING, 1,       "SV"  ) \
+	QC_ATTR(qc_prorated_core_time,             "prorated_core_time",             INT,    1,       "V"   ) \
+	QC_ATTR(qc_num_cp_threads,                 "num_cp_threads",                 INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_ifl_threads,                "num_ifl_threads",                INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_core_total,                 "num_core_total",                 INT,    1,       "SV"  ) \
+	QC_ATTR(qc_num_core_configured,            "num_core_configured",            INT,    1,       "S"   ) \
+	QC_ATTR(qc_num_core_standby,               "num_core_standby",               INT,    1,       "S"   ) \
+	QC_ATTR(qc_num_core_reserved,              "num_core_reserved",              INT,    1,       "S"   ) \
+	QC_ATTR(qc_num_core_dedicated,             "num_core_dedicated",             INT,    1,       "SHV" ) \
+	QC_ATTR(qc_num_core_shared,                "num_core_shared",                INT,    1,       "SHV" ) \
+	QC_ATTR(qc_type_name,                      "type_name",                      STRING, 1,       "S"   ) \
+	QC_ATTR(qc_lic_identifier,                 "lic_identifier",                 STRING, 1,       "S"   ) \
+	QC_ATTR(qc_type_family,                    "type_family",                    INT,    1,       "S"   ) \
+	QC_ATTR(qc_ziip_absolute_capping,          "ziip_absolute_capping",          INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_ziip_capacity_cap,              "ziip_capacity_cap",              INT,    1,       "V"   ) \
+	QC_ATTR(qc_ziip_capped_capacity,           "ziip_capped_capacity",           INT,    0x10000, "V"   ) \
+	QC_ATTR(qc_ziip_dispatch_limithard,        "ziip_dispatch_limithard",        INT,    1,       "V"   ) \
+	QC_ATTR(qc_ziip_dispatch_type,             "ziip_dispatch_type",             INT,    1,       "V"   ) \
+	QC_ATTR(qc_ziip_limithard_cap,             "ziip_limithard_cap",             INT,    1,       "V"   ) \
+	QC_ATTR(qc_ziip_weight_capping,            "ziip_weight_capping",            INT,    0x10000, "HV"  ) \
+	QC_ATTR(qc_num_ziip_dedicated,             "num_ziip_dedicated",             INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_ziip_shared,                "num_ziip_shared",                INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_ziip_total,                 "num_ziip_total",                 INT,    1,       "HV"  ) \
+	QC_ATTR(qc_num_ziip_threads,               "num_ziip_threads",               INT,    1,       "SHV" ) \
+	QC_ATTR(qc_has_secure,                     "has_secure",                     INT,    1,       "F"   ) \
+	QC_ATTR(qc_secure,                         "secure",                         INT,    1,       "F"   )
+
+#endif
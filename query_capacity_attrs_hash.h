@@ -0,0 +1,31 @@
+/* Generated by qc_gen_attrs from query_capacity_attrs.h, do not edit */
+
+#define QC_ATTR_HASH_SEED	0
+#define QC_ATTR_HASH_BUCKETS	64
+#define QC_ATTR_HASH_SLOTS	256
+
+static const unsigned char qc_attr_hash_disp[QC_ATTR_HASH_BUCKETS] = {
+	  1,   1,   1,   5,   1,   1,   5,   1,   1,   1,   1,   1,   4,   2,   5,   1,
+	  1,   9,   1,   3,   1,   2,   1,   4,   6,   2,   1,   7,   2,   3,   5,   1,
+	  1,   4,   3,   1,  11,   1,   1,   2,   7,   1,   1,   3,   5,   1,   1,   1,
+	  1,   3,   9,   1,   1,   1,  12,   2,   1,   3,   1,   2,   1,   1,   1,   5,
+};
+
+static const short qc_attr_hash_slots[QC_ATTR_HASH_SLOTS] = {
+	 -1,  61,  64,  -1,  -1,  74,  -1,  -1,  -1,  -1,  -1,  76,  25,   5,  41,  -1,
+	 16,  -1,  -1,  72,  73,  26,  50,  31,  -1,  -1,  28,  -1,  65,  -1,  34,  -1,
+	 -1,  -1,  -1,   3,  -1,  14,  57,  -1,  71,  -1,  -1,  75,  22,  -1,  21,   2,
+	 -1,  -1,  47,  17,   3,  -1,  -1,   4,  17,  -1,  23,  -1,  -1,   9,  -1,  45,
+	 -1,  27,  12,  -1,  -1,  78,  44,  39,  -1,   7,   6,  13,  -1,  -1,  67,  24,
+	 38,  -1,  56,  25,  29,   5,  -1,  66,  -1,  -1,  37,  23,  54,  51,   2,  -1,
+	 38,  49,  62,  -1,  20,  -1,  12,  -1,  -1,  57,  34,  30,  54,  -1,  -1,  10,
+	 -1,  -1,  -1,   4,  52,  78,  35,  43,  -1,  -1,   8,  -1,  69,  -1,  24,  -1,
+	 -1,  -1,  -1,  42,  -1,  27,  71,  15,  61,  -1,  56,  62,  63,  -1,  -1,  36,
+	 36,  63,  60,  40,  14,  -1,  -1,  72,  -1,  68,  55,  58,  -1,  77,  -1,  73,
+	 33,  30,  74,  16,  28,  43,  26,  60,  -1,  -1,  45,  29,  -1,  -1,  -1,   0,
+	 -1,   0,   1,  37,  32,  35,  -1,  44,  31,  52,  -1,   9,  11,  15,  47,  46,
+	 48,  -1,  -1,  -1,  18,  55,  -1,  -1,  -1,  69,  59,  49,  33,  -1,  51,  22,
+	 32,  59,  50,  67,  -1,  -1,  68,   7,  53,  -1,  -1,   8,  21,   1,  -1,  -1,
+	 70,  53,  65,  19,  -1,  18,  64,  13,  58,  75,  70,  11,  -1,  46,  42,  10,
+	 -1,  -1,  -1,  39,  19,  41,  -1,  -1,  76,  40,  20,  77,  -1,   6,  48,  66,
+};
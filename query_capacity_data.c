@@ -1,6 +1,12 @@
 /* Copyright IBM Corp. 2013, 2020 */
 
+#include <stdarg.h>
+#include <ctype.h>
+#include <limits.h>
+
 #include "query_capacity_data.h"
+#include "query_capacity_attrs.h"
+#include "query_capacity_attrs_hash.h"
 
 
 /*
@@ -644,94 +650,113 @@ static struct qc_attr kvm_guest_attrs[] = {
 };
 
 
+static struct {
+	int		 layer_type;
+	struct qc_attr	*attrs;
+} qc_layer_attrs[] = {
+	{QC_LAYER_TYPE_CEC, cec_attrs},
+	{QC_LAYER_TYPE_LPAR_GROUP, lpar_group_attrs},
+	{QC_LAYER_TYPE_LPAR, lpar_attrs},
+	{QC_LAYER_TYPE_ZVM_HYPERVISOR, zvm_hv_attrs},
+	{QC_LAYER_TYPE_ZVM_RESOURCE_POOL, zvm_pool_attrs},
+	{QC_LAYER_TYPE_ZVM_GUEST, zvm_guest_attrs},
+	{QC_LAYER_TYPE_ZOS_HYPERVISOR, zos_hv_attrs},
+	{QC_LAYER_TYPE_ZOS_TENANT_RESOURCE_GROUP, zos_tenant_resgroup_attrs},
+	{QC_LAYER_TYPE_KVM_HYPERVISOR, kvm_hv_attrs},
+	{QC_LAYER_TYPE_KVM_GUEST, kvm_guest_attrs},
+	{QC_LAYER_TYPE_ZOS_ZCX_SERVER, zos_zcx_server_attrs},
+};
+
+static const struct {
+	const char	*name;
+	const char	*id_name;	// name of the enum qc_attr_id value
+	int		 type;
+	int		 scale;
+	const char	*srcs;		// letters of the data sources providing the attribute
+} qc_attr_meta[QC_ATTR_ID_MAX + 1] = {
+#define QC_ATTR(id, name, type, scale, srcs)	[id] = {name, #id, QC_ATTR_TYPE_##type, scale, srcs},
+	QC_ATTRS
+#undef QC_ATTR
+};
+
 const char *qc_attr_id_to_char(struct qc_handle *hdl, enum qc_attr_id id) {
-	switch (id) {
-	case qc_layer_type_num: return "layer_type_num";
-	case qc_layer_category_num: return "layer_category_num";
-	case qc_layer_type: return "layer_type";
-	case qc_layer_category: return "layer_category";
-	case qc_layer_name: return "layer_name";
-	case qc_layer_extended_name: return "layer_extended_name";
-	case qc_layer_uuid: return "layer_uuid";
-	case qc_lic_identifier: return "lic_identifier";
-	case qc_manufacturer: return "manufacturer";
-	case qc_type: return "type";
-	case qc_model_capacity: return "model_capacity";
-	case qc_type_family: return "type_family";
-	case qc_model: return "model";
-	case qc_type_name: return "type_name";
-	case qc_sequence_code: return "sequence_code";
-	case qc_plant: return "plant";
-	case qc_num_cpu_total: return "num_cpu_total";
-	case qc_num_cpu_configured: return "num_cpu_configured";
-	case qc_num_cpu_standby: return "num_cpu_standby";
-	case qc_num_cpu_reserved: return "num_cpu_reserved";
-	case qc_num_cpu_dedicated: return "num_cpu_dedicated";
-	case qc_num_cpu_shared: return "num_cpu_shared";
-	case qc_num_cp_total: return "num_cp_total";
-	case qc_num_cp_dedicated: return "num_cp_dedicated";
-	case qc_num_cp_shared: return "num_cp_shared";
-	case qc_num_ifl_total: return "num_ifl_total";
-	case qc_num_ifl_dedicated: return "num_ifl_dedicated";
-	case qc_num_ifl_shared: return "num_ifl_shared";
-	case qc_capability: return "capability";
-	case qc_secondary_capability: return "secondary_capability";
-	case qc_capacity_adjustment_indication: return "capacity_adjustment_indication";
-	case qc_capacity_change_reason: return "capacity_change_reason";
-	case qc_partition_number: return "partition_number";
-	case qc_partition_char: return "partition_char";
-	case qc_partition_char_num: return "partition_char_num";
-	case qc_adjustment: return "adjustment";
-	case qc_cp_absolute_capping: return "cp_absolute_capping";
-	case qc_ifl_absolute_capping: return "ifl_absolute_capping";
-	case qc_cp_weight_capping: return "cp_weight_capping";
-	case qc_ifl_weight_capping: return "ifl_weight_capping";
-	case qc_cluster_name: return "cluster_name";
-	case qc_control_program_id: return "control_program_id";
-	case qc_limithard_consumption: return "limithard_consumption";
-	case qc_prorated_core_time: return "prorated_core_time";
-	case qc_cp_limithard_cap: return "pool_cp_limithard_cap";
-	case qc_cp_capacity_cap: return "pool_cp_capacity_cap";
-	case qc_ifl_limithard_cap: return "pool_ifl_limithard_cap";
-	case qc_ifl_capacity_cap: return "pool_ifl_capacity_cap";
-	case qc_capping: return "capping";
-	case qc_capping_num: return "capping_num";
-	case qc_mobility_enabled: return "mobility_enabled";
-        case qc_has_secure: return "has_secure";
-        case qc_secure: return "secure";
-	case qc_has_multiple_cpu_types: return "has_multiple_cpu_types";
-	case qc_cp_dispatch_limithard: return "cp_dispatch_limithard";
-	case qc_ifl_dispatch_limithard: return "ifl_dispatch_limithard";
-	case qc_cp_dispatch_type: return "cp_dispatch_type";
-	case qc_ifl_dispatch_type: return "ifl_dispatch_type";
-	case qc_cp_capped_capacity: return "cp_capped_capacity";
-	case qc_ifl_capped_capacity: return "ifl_capped_capacity";
-	case qc_num_cp_threads: return "num_cp_threads";
-	case qc_num_ifl_threads: return "num_ifl_threads";
-	case qc_num_core_total: return "num_core_total";
-	case qc_num_core_configured: return "num_core_configured";
-	case qc_num_core_standby: return "num_core_standby";
-	case qc_num_core_reserved: return "num_core_reserved";
-	case qc_num_core_dedicated: return "num_core_dedicated";
-	case qc_num_core_shared: return "num_core_shared";
-	case qc_ziip_absolute_capping: return "ziip_absolute_capping";
-	case qc_ziip_capacity_cap: return "ziip_capacity_cap";
-	case qc_ziip_capped_capacity: return "ziip_capped_capacity";
-	case qc_ziip_dispatch_limithard: return "ziip_dispatch_limithard";
-	case qc_ziip_dispatch_type: return "ziip_dispatch_type";
-	case qc_ziip_limithard_cap: return "ziip_limithard_cap";
-	case qc_ziip_weight_capping: return "ziip_weight_capping";
-	case qc_num_ziip_dedicated: return "num_ziip_dedicated";
-	case qc_num_ziip_shared: return "num_ziip_shared";
-	case qc_num_ziip_total: return "num_ziip_total";
-	case qc_num_ziip_threads: return "num_ziip_threads";
-	default: break;
-	}
+	if ((unsigned int)id <= QC_ATTR_ID_MAX)
+		return qc_attr_meta[id].name;
 	qc_debug(hdl, "Error: Cannot convert unknown attribute '%d' to char*\n", id);
 
 	return NULL;
 }
 
+static int qc_attr_name_equals(const char *a, const char *b, size_t len) {
+	return strncmp(a, b, len) == 0 && a[len] == '\0';
+}
+
+int qc_attr_char_to_id(const char *name, size_t len) {
+	unsigned int h;
+	int id;
+
+	h = qc_attr_hash(name, len, QC_ATTR_HASH_SEED) % QC_ATTR_HASH_BUCKETS;
+	h = qc_attr_hash(name, len, qc_attr_hash_disp[h]) % QC_ATTR_HASH_SLOTS;
+	id = qc_attr_hash_slots[h];
+	if (id < 0 || (!qc_attr_name_equals(qc_attr_meta[id].name, name, len) &&
+		       !qc_attr_name_equals(qc_attr_meta[id].id_name, name, len)))
+		return -1;
+
+	return id;
+}
+
+int qc_attr_get_meta(enum qc_attr_id id, struct qc_attr_info *info) {
+	struct qc_attr *attrs;
+	unsigned int i;
+
+	if ((unsigned int)id > QC_ATTR_ID_MAX)
+		return -1;
+	info->name = qc_attr_meta[id].name;
+	info->id_name = qc_attr_meta[id].id_name;
+	info->type = qc_attr_meta[id].type;
+	info->scale = qc_attr_meta[id].scale;
+	info->layer_types = 0;
+	for (i = 0; i < sizeof(qc_layer_attrs) / sizeof(qc_layer_attrs[0]); ++i) {
+		for (attrs = qc_layer_attrs[i].attrs; attrs->offset >= 0; ++attrs) {
+			if (attrs->id == id) {
+				info->layer_types |= 1 << qc_layer_attrs[i].layer_type;
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+const char *qc_attr_get_sources(enum qc_attr_id id) {
+	if ((unsigned int)id > QC_ATTR_ID_MAX)
+		return NULL;
+
+	return qc_attr_meta[id].srcs;
+}
+
+int qc_get_attrs(struct qc_handle *hdl, enum qc_attr_id *ids, int *types, int max) {
+	struct qc_attr *attr_list = hdl->attr_list;
+	int i;
+
+	for (i = 0; attr_list[i].offset >= 0; ++i) {
+		if (i >= max)
+			continue;
+		ids[i] = attr_list[i].id;
+		if (!types)
+			continue;
+		switch (attr_list[i].type) {
+		case integer: types[i] = QC_ATTR_TYPE_INT; break;
+		case floatingpoint: types[i] = QC_ATTR_TYPE_FLOAT; break;
+		case string: types[i] = QC_ATTR_TYPE_STRING; break;
+		}
+		if (hdl->attr_present[i])
+			types[i] |= QC_ATTR_SET;
+	}
+
+	return i;
+}
+
 struct qc_handle *qc_hdl_get_cec(struct qc_handle *hdl) {
 	return hdl ? hdl->root : hdl;
 }
@@ -846,6 +871,7 @@ int qc_hdl_new(struct qc_handle *hdl, struct qc_handle **tgthdl, int layer_no,
 		// Otherwise we'd change the handle which serves as an identified in
 		// our log output, which could be confusing.
 		*tgthdl = malloc(sizeof(struct qc_handle));
+		qc_stats_add(allocations, 1);
 		if (!*tgthdl) {
 			qc_debug(hdl, "Error: Failed to allocate handle\n");
 			return -2;
@@ -859,6 +885,7 @@ int qc_hdl_new(struct qc_handle *hdl, struct qc_handle **tgthdl, int layer_no,
 	else
 		(*tgthdl)->root = *tgthdl;
 	(*tgthdl)->layer = malloc(layer_sz);
+	qc_stats_add(allocations, 1);
 	if (!(*tgthdl)->layer) {
 		qc_debug(hdl, "Error: Failed to allocate layer\n");
 		free(*tgthdl);
@@ -868,6 +895,7 @@ int qc_hdl_new(struct qc_handle *hdl, struct qc_handle **tgthdl, int layer_no,
 	memset((*tgthdl)->layer, 0, layer_sz);
 	(*tgthdl)->attr_present = calloc(num_attrs, sizeof(int));
 	(*tgthdl)->src = calloc(num_attrs, sizeof(int));
+	qc_stats_add(allocations, 2);
 	if (!(*tgthdl)->attr_present || !(*tgthdl)->src) {
 		qc_debug(hdl, "Error: Failed to allocate attr_present array\n");
 		free((*tgthdl)->layer);
@@ -917,6 +945,8 @@ void qc_hdl_prune(struct qc_handle *hdl) {
 		free(ptr->src);
 		hdl = ptr->next;
 		if (ptr == skip) {
+			free(ptr->layers);
+			free(ptr->stats);
 			memset(ptr, 0, sizeof(struct qc_handle));
 			ptr->root = ptr;
 		} else
@@ -1152,6 +1182,38 @@ static int qc_get_attr_idx(struct qc_handle *hdl, enum qc_attr_id id, enum qc_da
 	return -1;
 }
 
+// Returns the index of attribute 'id' in layer 'hdl', its type as in enum qc_attr_types, and its offset
+int qc_get_attr_slot(struct qc_handle *hdl, enum qc_attr_id id, int *type, int *offset) {
+	struct qc_attr *attr_list = hdl->attr_list;
+	int idx;
+
+#ifdef CONFIG_V1_COMPATIBILITY
+	id = preserve_v1_attr_compatibility(hdl, id);
+#endif
+	for (idx = 0; attr_list[idx].offset >= 0; ++idx) {
+		if (attr_list[idx].id == id) {
+			*type = qc_attr_meta[id].type;
+			*offset = attr_list[idx].offset;
+			return idx;
+		}
+	}
+
+	return -1;
+}
+
+void qc_get_attr_int_slots(struct qc_handle *hdl, int **vals, char *srcs) {
+	struct qc_attr *attr_list = hdl->attr_list;
+	int idx;
+
+	memset(vals, 0, (qc_secure + 1) * sizeof(*vals));
+	for (idx = 0; attr_list[idx].offset >= 0; ++idx) {
+		if (attr_list[idx].type == integer && hdl->attr_present[idx]) {
+			vals[attr_list[idx].id] = (int *)((char *)hdl->layer + attr_list[idx].offset);
+			srcs[attr_list[idx].id] = hdl->src[idx];
+		}
+	}
+}
+
 /// Retrieve value of attribute 'id' of layer pointed at by 'hdl'
 static void *qc_get_attr_value(struct qc_handle *hdl, enum qc_attr_id id, enum qc_data_type type) {
 	struct qc_attr *attr_list = hdl->attr_list;
@@ -1202,26 +1264,510 @@ char qc_get_attr_value_src_string(struct qc_handle *hdl, enum qc_attr_id id) {
 	return qc_get_attr_value_src(hdl, id, string);
 }
 
-void qc_print_attrs_json(struct qc_handle *hdl, int indent) {
-        struct qc_attr *attr;
-        void *val;
-
-        for (attr = hdl->attr_list; attr->offset >= 0; attr++) {
-                if ((val = qc_get_attr_value(hdl, attr->id, attr->type)) == NULL)
-                        printf("%*s\"%s\": null", indent, "", qc_attr_id_to_char(hdl, attr->id));
-                else {
-                        switch (attr->type) {
-                        case integer:
-                                printf("%*s\"%s\": \"%d\"", indent, "", qc_attr_id_to_char(hdl, attr->id), *(int*)val);
-                                break;
-                        case floatingpoint:
-                                printf("%*s\"%s\": \"%f\"", indent, "", qc_attr_id_to_char(hdl, attr->id), *(float*)val);
-                                break;
-                        case string:
-                                printf("%*s\"%s\": \"%s\"", indent, "", qc_attr_id_to_char(hdl, attr->id), (char*)val);
-                                break;
-                        }
-                }
-                printf("%s\n", (attr + 1)->offset >= 0 ? "," : "");
-        }
+void qc_bin_put(struct qc_bin *b, const void *data, size_t len) {
+	size_t size;
+	char *p;
+
+	if (b->err)
+		return;
+	if (b->len + len > b->size) {
+		for (size = b->size ? b->size : 1024; size < b->len + len; size *= 2);
+		if ((p = realloc(b->buf, size)) == NULL) {
+			b->err = 1;
+			return;
+		}
+		b->buf = p;
+		b->size = size;
+	}
+	memcpy(b->buf + b->len, data, len);
+	b->len += len;
+}
+
+void qc_bin_put_u16(struct qc_bin *b, __u16 val) {
+	val = htobe16(val);
+	qc_bin_put(b, &val, sizeof(val));
+}
+
+void qc_bin_printf(struct qc_bin *b, const char *fmt, ...) {
+	char buf[STR_BUF_SIZE];
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	len = vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	if (len < 0)
+		b->err = 1;
+	else
+		qc_bin_put(b, buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
+
+static void qc_bin_put_u32(struct qc_bin *b, __u32 val) {
+	val = htobe32(val);
+	qc_bin_put(b, &val, sizeof(val));
+}
+
+// Returns index of 'str' in the string table, adding it if not present yet
+static int qc_bin_intern(struct qc_bin *b, const char *str) {
+	char **strs;
+	int i;
+
+	for (i = 0; i < b->num_strs; ++i)
+		if (strcmp(b->strs[i], str) == 0)
+			return i;
+	if ((strs = realloc(b->strs, (b->num_strs + 1) * sizeof(char *))) == NULL) {
+		b->err = 1;
+		return 0;
+	}
+	b->strs = strs;
+	b->strs[b->num_strs] = (char *)str;
+
+	return b->num_strs++;
+}
+
+void qc_bin_free(struct qc_bin *b) {
+	free(b->buf);
+	free(b->strs);
+	memset(b, 0, sizeof(*b));
+}
+
+void qc_attrs_to_binary(struct qc_handle *hdl, struct qc_bin *b) {
+	unsigned char bitmap[(QC_ATTR_ID_MAX + 8) / 8];
+	int idx[QC_ATTR_ID_MAX + 1];
+	struct qc_attr *attr;
+	char *val;
+	__u32 u;
+	int i;
+
+	memset(bitmap, 0, sizeof(bitmap));
+	for (attr = hdl->attr_list, i = 0; attr->offset >= 0; attr++, i++) {
+		if (!hdl->attr_present[i] || attr->id > QC_ATTR_ID_MAX)
+			continue;
+		bitmap[attr->id / 8] |= 1 << (attr->id % 8);
+		idx[attr->id] = i;
+	}
+	qc_bin_put(b, bitmap, sizeof(bitmap));
+	for (i = 0; i <= QC_ATTR_ID_MAX; ++i) {
+		if (!(bitmap[i / 8] & (1 << (i % 8))))
+			continue;
+		attr = &hdl->attr_list[idx[i]];
+		val = (char *)hdl->layer + attr->offset;
+		qc_bin_put(b, &hdl->src[idx[i]], 1);
+		switch (attr->type) {
+		case integer:
+		case floatingpoint:
+			memcpy(&u, val, sizeof(u));
+			qc_bin_put_u32(b, u);
+			break;
+		case string:
+			qc_bin_put_u16(b, qc_bin_intern(b, val));
+			break;
+		}
+	}
+}
+
+int qc_attrs_from_binary(struct qc_handle *hdl, const char *buf, size_t len, size_t *off, int num_ids,
+			 const struct qc_bin_str *strs, int num_strs) {
+	const unsigned char *bitmap = (const unsigned char *)buf + *off;
+	size_t pos = *off + (num_ids + 7) / 8, n;
+	struct qc_attr *attr;
+	char *val;
+	__u16 s;
+	__u32 u;
+	int id, i;
+
+	if (pos > len)
+		goto err;
+	for (id = 0; id < num_ids; ++id) {
+		if (!(bitmap[id / 8] & (1 << (id % 8))))
+			continue;
+		for (attr = hdl->attr_list, i = 0; attr->offset >= 0 && attr->id != id; attr++, i++);
+		if (attr->offset < 0) {
+			qc_debug(hdl, "Error: Attribute %d not defined in layer %d\n", id, hdl->layer_no);
+			return -1;
+		}
+		if (pos + 1 + (attr->type == string ? sizeof(s) : sizeof(u)) > len)
+			goto err;
+		hdl->src[i] = buf[pos++];
+		hdl->attr_present[i] = 1;
+		val = (char *)hdl->layer + attr->offset;
+		switch (attr->type) {
+		case integer:
+		case floatingpoint:
+			memcpy(&u, buf + pos, sizeof(u));
+			u = be32toh(u);
+			memcpy(val, &u, sizeof(u));
+			pos += sizeof(u);
+			break;
+		case string:
+			memcpy(&s, buf + pos, sizeof(s));
+			s = be16toh(s);
+			pos += sizeof(s);
+			if (s >= num_strs) {
+				qc_debug(hdl, "Error: Invalid string index %d\n", s);
+				return -2;
+			}
+			n = strs[s].len < qc_get_str_attr_len(id) - 1 ? strs[s].len : qc_get_str_attr_len(id) - 1;
+			memcpy(val, strs[s].str, n);
+			val[n] = '\0';
+			break;
+		}
+	}
+	*off = pos;
+
+	return 0;
+
+err:
+	qc_debug(hdl, "Error: Layer %d data is truncated\n", hdl->layer_no);
+
+	return -3;
+}
+
+// Appends 'str' as a json string, escaping as required
+static void qc_json_put_string(struct qc_bin *b, const char *str) {
+	const char *s;
+
+	qc_bin_put(b, "\"", 1);
+	for (s = str; *str; str++) {
+		if (*str != '"' && *str != '\\' && (unsigned char)*str >= 0x20)
+			continue;
+		qc_bin_put(b, s, str - s);
+		if (*str == '"' || *str == '\\')
+			qc_bin_printf(b, "\\%c", *str);
+		else
+			qc_bin_printf(b, "\\u%04x", (unsigned char)*str);
+		s = str + 1;
+	}
+	qc_bin_put(b, s, str - s);
+	qc_bin_put(b, "\"", 1);
 }
+
+static int qc_json_is_selected(enum qc_attr_id id, const enum qc_attr_id *attrs, int num_attrs) {
+	int i;
+
+	if (!attrs)
+		return 1;
+	for (i = 0; i < num_attrs; ++i)
+		if (attrs[i] == id)
+			return 1;
+
+	return 0;
+}
+
+void qc_attrs_to_json(struct qc_handle *hdl, struct qc_bin *b, int indent, int flags,
+		      const enum qc_attr_id *attrs, int num_attrs) {
+	const char *quote = flags & QC_JSON_NATIVE ? "" : "\"";
+	const char *sep = flags & QC_JSON_COMPACT ? ":" : ": ";
+	struct qc_attr *attr;
+	int first = 1;
+	void *val;
+
+	for (attr = hdl->attr_list; attr->offset >= 0; attr++) {
+		if (!qc_json_is_selected(attr->id, attrs, num_attrs))
+			continue;
+		if (!first)
+			qc_bin_put(b, ",", 1);
+		if (!first && !(flags & QC_JSON_COMPACT))
+			qc_bin_put(b, "\n", 1);
+		first = 0;
+		if (!(flags & QC_JSON_COMPACT))
+			qc_bin_printf(b, "%*s", indent, "");
+		qc_bin_printf(b, "\"%s\"%s", qc_attr_id_to_char(hdl, attr->id), sep);
+		if ((val = qc_get_attr_value(hdl, attr->id, attr->type)) == NULL) {
+			qc_bin_put(b, "null", 4);
+			continue;
+		}
+		switch (attr->type) {
+		case integer:
+			qc_bin_printf(b, "%s%d%s", quote, *(int *)val, quote);
+			break;
+		case floatingpoint:
+			qc_bin_printf(b, "%s%f%s", quote, *(float *)val, quote);
+			break;
+		case string:
+			qc_json_put_string(b, (char *)val);
+			break;
+		}
+	}
+	if (!first && !(flags & QC_JSON_COMPACT))
+		qc_bin_put(b, "\n", 1);
+}
+
+/* Parser for the output of qc_export_json_ex(), working on the input in place */
+struct qc_json {
+	const char	*p;
+	const char	*end;
+};
+
+static void qc_json_ws(struct qc_json *j) {
+	while (j->p < j->end && (*j->p == ' ' || *j->p == '\n' || *j->p == '\t' || *j->p == '\r'))
+		j->p++;
+}
+
+// Consumes character 'c', skipping leading whitespace
+static int qc_json_expect(struct qc_json *j, char c) {
+	qc_json_ws(j);
+	if (j->p >= j->end || *j->p != c)
+		return -1;
+	j->p++;
+
+	return 0;
+}
+
+// Returns the raw content of a string in 's' and 'len', leaving any escape sequences as is
+static int qc_json_string(struct qc_json *j, const char **s, size_t *len) {
+	if (qc_json_expect(j, '"'))
+		return -1;
+	for (*s = j->p; j->p < j->end && *j->p != '"'; j->p++)
+		if (*j->p == '\\')
+			j->p++;
+	if (j->p >= j->end)
+		return -1;
+	*len = j->p - *s;
+	j->p++;
+
+	return 0;
+}
+
+// Copies raw string content 's' to 'buf' of size 'size', resolving escape sequences
+static void qc_json_unescape(char *buf, size_t size, const char *s, size_t len) {
+	const char *end = s + len;
+	size_t n = 0;
+	char *e;
+
+	for (; s < end && n < size - 1; s++) {
+		if (*s != '\\' || s + 1 >= end) {
+			buf[n++] = *s;
+			continue;
+		}
+		switch (*++s) {
+		case 'n': buf[n++] = '\n'; break;
+		case 't': buf[n++] = '\t'; break;
+		case 'r': buf[n++] = '\r'; break;
+		case 'b': buf[n++] = '\b'; break;
+		case 'f': buf[n++] = '\f'; break;
+		case 'u':
+			if (s + 4 < end) {
+				char hex[5] = {s[1], s[2], s[3], s[4], '\0'};
+				unsigned long c = strtoul(hex, &e, 16);
+				buf[n++] = (*e == '\0' && c < 0x100) ? (char)c : '?';
+				s += 4;
+			}
+			break;
+		default: buf[n++] = *s; break;
+		}
+	}
+	buf[n] = '\0';
+}
+
+static int qc_json_is_number_char(char c) {
+	return isdigit((unsigned char)c) || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Returns a number, quoted or not, zero-terminated in 'tok' of size 'size'
+static int qc_json_number(struct qc_json *j, char *tok, size_t size) {
+	const char *s;
+	size_t len;
+
+	qc_json_ws(j);
+	if (j->p < j->end && *j->p == '"') {
+		if (qc_json_string(j, &s, &len))
+			return -1;
+	} else {
+		for (s = j->p; j->p < j->end && qc_json_is_number_char(*j->p); j->p++);
+		len = j->p - s;
+	}
+	// an embedded NUL would truncate the token unnoticed
+	if (len == 0 || len >= size || memchr(s, '\0', len))
+		return -1;
+	memcpy(tok, s, len);
+	tok[len] = '\0';
+
+	return 0;
+}
+
+// Returns whether the next value is 'null', consuming it if so
+static int qc_json_null(struct qc_json *j) {
+	qc_json_ws(j);
+	if (j->end - j->p >= 4 && strncmp(j->p, "null", 4) == 0) {
+		j->p += 4;
+		return 1;
+	}
+
+	return 0;
+}
+
+// Skips a value of a type that qc_export_json_ex() can produce
+static int qc_json_skip_value(struct qc_json *j) {
+	char tok[64];
+	const char *s;
+	size_t len;
+
+	if (qc_json_null(j))
+		return 0;
+	if (j->p < j->end && *j->p == '"')
+		return qc_json_string(j, &s, &len);
+
+	return qc_json_number(j, tok, sizeof(tok));
+}
+
+// Returns the index of the attribute named 's' in layer 'hdl', trying the one following 'prev' first
+static int qc_json_find_attr(struct qc_handle *hdl, int prev, const char *s, size_t len) {
+	struct qc_attr *attr_list = hdl->attr_list;
+	int id, idx;
+
+	if (prev >= 0 && attr_list[prev + 1].offset >= 0 &&
+	    qc_attr_name_equals(qc_attr_meta[attr_list[prev + 1].id].name, s, len))
+		return prev + 1;
+	if ((id = qc_attr_char_to_id(s, len)) < 0)
+		return -1;
+	for (idx = 0; attr_list[idx].offset >= 0; ++idx)
+		if (attr_list[idx].id == id)
+			return idx;
+
+	return -1;
+}
+
+static int qc_json_attr_value(struct qc_handle *hdl, struct qc_json *j, int idx) {
+	struct qc_attr *attr = &hdl->attr_list[idx];
+	char *val = (char *)hdl->layer + attr->offset;
+	char tok[64], *e;
+	const char *s;
+	size_t len;
+	long l;
+
+	if (qc_json_null(j))
+		return 0;
+	switch (attr->type) {
+	case integer:
+		if (qc_json_number(j, tok, sizeof(tok)))
+			return -1;
+		errno = 0;
+		l = strtol(tok, &e, 10);
+		if (errno == ERANGE || l < INT_MIN || l > INT_MAX)
+			return -1;
+		*(int *)val = l;
+		break;
+	case floatingpoint:
+		if (qc_json_number(j, tok, sizeof(tok)))
+			return -1;
+		*(float *)val = strtof(tok, &e);
+		break;
+	case string:
+		if (qc_json_string(j, &s, &len))
+			return -1;
+		qc_json_unescape(val, qc_get_str_attr_len(attr->id), s, len);
+		e = "";
+		break;
+	}
+	if (*e != '\0')
+		return -1;
+	hdl->attr_present[idx] = 1;
+	hdl->src[idx] = ATTR_SRC_UNDEF;
+
+	return 0;
+}
+
+// Retrieves the value of 'layer_type_num' in the layer object at the current position
+static int qc_json_layer_type(struct qc_json *j, int *type) {
+	struct qc_json l = *j;
+	char tok[64], *e;
+	const char *s;
+	size_t len;
+
+	if (qc_json_expect(&l, '{'))
+		return -1;
+	do {
+		if (qc_json_string(&l, &s, &len) || qc_json_expect(&l, ':'))
+			return -1;
+		if (len == strlen("layer_type_num") && strncmp(s, "layer_type_num", len) == 0) {
+			if (qc_json_number(&l, tok, sizeof(tok)))
+				return -1;
+			*type = strtol(tok, &e, 10);
+			return *e != '\0';
+		}
+		if (qc_json_skip_value(&l))
+			return -1;
+	} while (qc_json_expect(&l, ',') == 0);
+
+	return -1;
+}
+
+// Parses the attributes of layer 'hdl' from the object at the current position
+static int qc_attrs_from_json(struct qc_handle *hdl, struct qc_json *j) {
+	int idx = -1, prev = -1;
+	const char *s;
+	size_t len;
+
+	if (qc_json_expect(j, '{'))
+		return -1;
+	if (qc_json_expect(j, '}') == 0)
+		return 0;
+	do {
+		if (qc_json_string(j, &s, &len) || qc_json_expect(j, ':'))
+			return -1;
+		if ((idx = qc_json_find_attr(hdl, prev, s, len)) < 0) {
+			qc_debug(hdl, "Unknown attribute '%.*s' in layer %d, skipping\n", (int)len, s, hdl->layer_no);
+			if (qc_json_skip_value(j))
+				return -1;
+			continue;
+		}
+		if (qc_json_attr_value(hdl, j, idx)) {
+			qc_debug(hdl, "Error: Invalid value for attribute '%.*s' in layer %d\n", (int)len, s,
+				 hdl->layer_no);
+			return -1;
+		}
+		prev = idx;
+	} while (qc_json_expect(j, ',') == 0);
+
+	return qc_json_expect(j, '}');
+}
+
+int qc_layers_from_json(const char *buf, size_t len, struct qc_handle **hdl) {
+	struct qc_handle *prev = NULL, *layer;
+	struct qc_json j = {buf, buf + len};
+	int rc = -1, type, i = 0;
+	const char *s;
+	size_t n;
+
+	*hdl = NULL;
+	if (qc_json_expect(&j, '{'))
+		goto out;
+	do {
+		if (qc_json_string(&j, &s, &n) || n < 7 || strncmp(s, "Layer ", 6) ||
+		    strtol(s + 6, NULL, 10) != i || qc_json_expect(&j, ':')) {
+			qc_debug(NULL, "Error: Expected 'Layer %d'\n", i);
+			goto out;
+		}
+		if (qc_json_layer_type(&j, &type)) {
+			qc_debug(NULL, "Error: No layer type in layer %d\n", i);
+			goto out;
+		}
+		layer = NULL;
+		if (qc_hdl_new(prev, &layer, i, type))
+			goto out;
+		if (prev)
+			prev->next = layer;
+		else
+			*hdl = layer;
+		prev = layer;
+		if (qc_attrs_from_json(layer, &j)) {
+			qc_debug(layer, "Error: Failed to parse layer %d\n", i);
+			goto out;
+		}
+		i++;
+	} while (qc_json_expect(&j, ',') == 0);
+	if (qc_json_expect(&j, '}'))
+		goto out;
+	rc = 0;
+
+out:
+	if (rc && *hdl) {
+		qc_hdl_prune(*hdl);
+		free(*hdl);
+		*hdl = NULL;
+	}
+
+	return rc;
+}
+
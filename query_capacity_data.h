@@ -17,6 +17,16 @@ int qc_is_attr_set_float(struct qc_handle *hdl, enum qc_attr_id id);
 int qc_is_attr_set_string(struct qc_handle *hdl, enum qc_attr_id id);
 
 const char *qc_attr_id_to_char(struct qc_handle *hdl, enum qc_attr_id id);
+// returns the attribute with name 'name' of length 'len' as in JSON or enum qc_attr_id, or <0 if not found
+int qc_attr_char_to_id(const char *name, size_t len);
+int qc_attr_get_meta(enum qc_attr_id id, struct qc_attr_info *info);
+// returns the letters of the data sources that attribute 'id' depends on, see ATTR_SRC_*, or NULL if invalid
+const char *qc_attr_get_sources(enum qc_attr_id id);
+// lists the attributes of layer 'hdl', returns the total number of attributes
+int qc_get_attrs(struct qc_handle *hdl, enum qc_attr_id *ids, int *types, int max);
+int qc_get_attr_slot(struct qc_handle *hdl, enum qc_attr_id id, int *type, int *offset);
+// sets vals[id] and srcs[id] for all integer attributes of layer 'hdl' that are set, and vals[id] to NULL for all others
+void qc_get_attr_int_slots(struct qc_handle *hdl, int **vals, char *srcs);
 
 int   *qc_get_attr_value_int(struct qc_handle *hdl, enum qc_attr_id id);
 float *qc_get_attr_value_float(struct qc_handle *hdl, enum qc_attr_id id);
@@ -27,6 +37,33 @@ char qc_get_attr_value_src_int(struct qc_handle *hdl, enum qc_attr_id id);
 char qc_get_attr_value_src_float(struct qc_handle *hdl, enum qc_attr_id id);
 char qc_get_attr_value_src_string(struct qc_handle *hdl, enum qc_attr_id id);
 
-// print all attributes in the list in json format
-void qc_print_attrs_json(struct qc_handle *hdl, int indent);
+/* Binary snapshot encoding, see qc_export_binary() */
+struct qc_bin {
+	char	 *buf;
+	size_t	  len;
+	size_t	  size;
+	char	**strs;		// interned strings, referenced by index
+	int	  num_strs;
+	int	  err;		// set if any allocation failed
+};
+
+struct qc_bin_str {
+	const char	*str;	// not zero-terminated
+	size_t		 len;
+};
+
+void qc_bin_put(struct qc_bin *b, const void *data, size_t len);
+void qc_bin_put_u16(struct qc_bin *b, __u16 val);
+void qc_bin_printf(struct qc_bin *b, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+void qc_bin_free(struct qc_bin *b);
+// append bitmap and values of all attributes set in layer 'hdl' to 'b'
+void qc_attrs_to_binary(struct qc_handle *hdl, struct qc_bin *b);
+// set attributes of layer 'hdl' from 'buf' at offset 'off', advancing 'off'
+int qc_attrs_from_binary(struct qc_handle *hdl, const char *buf, size_t len, size_t *off, int num_ids,
+			 const struct qc_bin_str *strs, int num_strs);
+// append attributes of layer 'hdl' in json format to 'b', see qc_export_json_ex()
+void qc_attrs_to_json(struct qc_handle *hdl, struct qc_bin *b, int indent, int flags,
+		      const enum qc_attr_id *attrs, int num_attrs);
+// create layers from json as produced by qc_export_json_ex()
+int qc_layers_from_json(const char *buf, size_t len, struct qc_handle **hdl);
 #endif
@@ -0,0 +1,453 @@
+/* Copyright IBM Corp. 2026 */
+
+#define _GNU_SOURCE
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <endian.h>
+
+#include "query_capacity_data.h"
+
+
+/* Single-file dump container. All integers are big endian. The header is followed by
+   'count' sections, each consisting of a section header and 'len' Bytes of payload,
+   followed by at least one zero Byte and padded with zeros to a multiple of
+   QC_DUMP_ALIGN Bytes. Hence every payload is zero-terminated and 8-Byte aligned
+   in the file, and can be parsed in place when mapped. Sections of type
+   QC_DUMP_SEC_INCOMPLETE carry the name of a component that could not be dumped. */
+#define QC_DUMP_MAGIC		"QCLIBDMP"
+#define QC_DUMP_VERSION		1
+#define QC_DUMP_ALIGN		8
+
+struct qc_dump_hdr {
+	char	magic[8];
+	__u32	version;
+	__u32	count;
+	__u64	timestamp;	// time of the dump in ns since the epoch
+	char	qc_version[16];	// version of qclib that wrote the dump
+} __attribute__ ((packed));
+
+struct qc_dump_sec_hdr {
+	__u32	type;
+	__u32	reserved;
+	__u64	len;
+} __attribute__ ((packed));
+
+struct qc_dump_buf {
+	char	*buf;
+	size_t	 len;
+	size_t	 size;
+	int	 err;		// set if a section could not be added
+};
+
+static struct qc_dump_buf qc_dump_out;	// dump being assembled
+static struct qc_dump_buf qc_dump_in;	// dump file mapped via QC_USE_DUMP
+
+/* Index of the sections of a dump file or of buffers passed to qc_open_from_buffers() */
+struct qc_dump_sec {
+	const char	*buf;
+	size_t		 len;
+	char		*copy;	// set if 'buf' is a zero-terminated copy that we allocated
+};
+static struct qc_dump_sec qc_dump_secs[QC_DUMP_SEC_MAX + 1];
+static int qc_dump_indexed;
+
+/* Files mapped from a dump directory, kept until qc_dump_unload() */
+struct qc_dump_map {
+	void	*addr;
+	size_t	 size;
+};
+static struct qc_dump_map *qc_dump_maps;
+static int qc_dump_num_maps;
+
+static const char *qc_dump_sec_names[] = {
+	[QC_DUMP_SEC_SYSINFO]		= "sysinfo",
+	[QC_DUMP_SEC_DIAG_204]		= "diag_204",
+	[QC_DUMP_SEC_DIAG_2FC]		= "diag_2fc",
+	[QC_DUMP_SEC_STHYI]		= "sthyi",
+	[QC_DUMP_SEC_CPC_NAME]		= "cpc_name",
+	[QC_DUMP_SEC_HAS_SECURE]	= "has_secure",
+	[QC_DUMP_SEC_SECURE]		= "secure",
+	[QC_DUMP_SEC_INCOMPLETE]	= "incomplete",
+};
+
+// Returns the size of a payload of 'len' Bytes in the file, including terminator and padding
+static size_t qc_dump_pad(size_t len) {
+	return (len + QC_DUMP_ALIGN) & ~(size_t)(QC_DUMP_ALIGN - 1);
+}
+
+static int qc_dump_reserve(struct qc_dump_buf *d, size_t len) {
+	size_t size;
+	char *p;
+
+	if (d->len + len <= d->size)
+		return 0;
+	for (size = d->size ? d->size : 16384; size < d->len + len; size *= 2);
+	if ((p = realloc(d->buf, size)) == NULL)
+		return -1;
+	d->buf = p;
+	d->size = size;
+
+	return 0;
+}
+
+int qc_dump_begin(struct qc_handle *hdl) {
+	free(qc_dump_out.buf);
+	memset(&qc_dump_out, 0, sizeof(qc_dump_out));
+	if (qc_dump_reserve(&qc_dump_out, sizeof(struct qc_dump_hdr))) {
+		qc_debug(hdl, "Error: Failed to allocate dump buffer\n");
+		return -1;
+	}
+	memset(qc_dump_out.buf, 0, sizeof(struct qc_dump_hdr));
+	qc_dump_out.len = sizeof(struct qc_dump_hdr);
+
+	return 0;
+}
+
+void qc_dump_add(struct qc_handle *hdl, int type, const void *data, size_t len) {
+	struct qc_dump_sec_hdr *sec;
+	struct qc_dump_hdr *hdr;
+
+	if (!qc_dump_out.buf)
+		return;
+	if (qc_dump_reserve(&qc_dump_out, sizeof(struct qc_dump_sec_hdr) + qc_dump_pad(len))) {
+		qc_debug(hdl, "Error: Failed to add %zd Bytes of %s to dump\n", len, qc_dump_sec_names[type]);
+		qc_dump_out.err = 1;
+		return;
+	}
+	sec = (struct qc_dump_sec_hdr *)(qc_dump_out.buf + qc_dump_out.len);
+	sec->type = htobe32(type);
+	sec->reserved = 0;
+	sec->len = htobe64(len);
+	qc_dump_out.len += sizeof(struct qc_dump_sec_hdr);
+	memcpy(qc_dump_out.buf + qc_dump_out.len, data, len);
+	memset(qc_dump_out.buf + qc_dump_out.len + len, 0, qc_dump_pad(len) - len);
+	qc_dump_out.len += qc_dump_pad(len);
+	hdr = (struct qc_dump_hdr *)qc_dump_out.buf;
+	hdr->count = htobe32(be32toh(hdr->count) + 1);
+	qc_debug(hdl, "Added %zd Bytes of %s to dump\n", len, qc_dump_sec_names[type]);
+}
+
+/* Write the dump assembled since qc_dump_begin() to a new file 'path' in one go.
+   Returns 0 on success, >0 if the file exists already, and <0 on error. */
+int qc_dump_write(struct qc_handle *hdl, const char *path) {
+	struct qc_dump_hdr *hdr = (struct qc_dump_hdr *)qc_dump_out.buf;
+	struct timespec ts;
+	ssize_t lrc;
+	int fd, rc = -1;
+
+	if (!hdr)
+		return -1;
+	if (qc_dump_out.err)
+		qc_debug(hdl, "Warning: Dump is missing sections\n");
+	memcpy(hdr->magic, QC_DUMP_MAGIC, sizeof(hdr->magic));
+	hdr->version = htobe32(QC_DUMP_VERSION);
+	clock_gettime(CLOCK_REALTIME, &ts);
+	hdr->timestamp = htobe64((__u64)ts.tv_sec * 1000000000 + ts.tv_nsec);
+	strncpy(hdr->qc_version, QC_VERSION, sizeof(hdr->qc_version) - 1);
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		if (errno == EEXIST)
+			return 1;
+		qc_debug(hdl, "Error: Failed to create dump file '%s': %s\n", path, strerror(errno));
+		return -1;
+	}
+	lrc = write(fd, qc_dump_out.buf, qc_dump_out.len);
+	if (lrc != (ssize_t)qc_dump_out.len) {
+		qc_debug(hdl, "Error: Failed to write dump to '%s': %s\n", path,
+			 lrc == -1 ? strerror(errno) : "short write");
+		unlink(path);
+	} else {
+		qc_debug(hdl, "Dumped %zd Bytes in %u section(s) to '%s'\n", qc_dump_out.len,
+			 be32toh(hdr->count), path);
+		rc = 0;
+	}
+	close(fd);
+
+	return rc;
+}
+
+void qc_dump_end(void) {
+	free(qc_dump_out.buf);
+	memset(&qc_dump_out, 0, sizeof(qc_dump_out));
+}
+
+// Returns the payload of the first section of 'type' in the loaded dump, or NULL
+static const char *qc_dump_find(int type, size_t *len) {
+	if (type <= 0 || type > QC_DUMP_SEC_MAX || !qc_dump_secs[type].buf)
+		return NULL;
+	*len = qc_dump_secs[type].len;
+
+	return qc_dump_secs[type].buf;
+}
+
+/* Maps the dump file at 'path' and validates its structure.
+   Returns 0 on success, >0 if the dump is incomplete, and <0 on error. */
+int qc_dump_load(struct qc_handle *hdl, const char *path) {
+	struct qc_dump_sec_hdr *sec;
+	struct qc_dump_hdr *hdr;
+	size_t off, len;
+	struct stat buf;
+	int fd, rc = -1;
+	const char *s;
+	__u32 i;
+
+	qc_dump_unload();
+	if ((fd = open(path, O_RDONLY)) == -1 || fstat(fd, &buf)) {
+		qc_debug(hdl, "Error: Failed to open dump file '%s': %s\n", path, strerror(errno));
+		goto out;
+	}
+	if ((size_t)buf.st_size < sizeof(struct qc_dump_hdr)) {
+		qc_debug(hdl, "Error: Dump file '%s' is too short\n", path);
+		goto out;
+	}
+	// private writable mapping, so parsers could even modify the data in place
+	qc_dump_in.buf = mmap(NULL, buf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (qc_dump_in.buf == MAP_FAILED) {
+		qc_debug(hdl, "Error: Failed to map dump file '%s': %s\n", path, strerror(errno));
+		qc_dump_in.buf = NULL;
+		goto out;
+	}
+	qc_dump_in.size = buf.st_size;
+	qc_dump_in.len = buf.st_size;
+	qc_stats_add(syscalls, 3);	// open, fstat and mmap
+	qc_stats_add(bytes_read, buf.st_size);
+	hdr = (struct qc_dump_hdr *)qc_dump_in.buf;
+	if (memcmp(hdr->magic, QC_DUMP_MAGIC, sizeof(hdr->magic)) ||
+	    be32toh(hdr->version) != QC_DUMP_VERSION) {
+		qc_debug(hdl, "Error: '%s' is not a dump file of a supported version\n", path);
+		goto out;
+	}
+	for (i = 0, off = sizeof(struct qc_dump_hdr); i < be32toh(hdr->count); ++i) {
+		sec = (struct qc_dump_sec_hdr *)(qc_dump_in.buf + off);
+		if (off + sizeof(struct qc_dump_sec_hdr) > qc_dump_in.len ||
+		    be64toh(sec->len) >= qc_dump_in.len - off - sizeof(struct qc_dump_sec_hdr) ||
+		    qc_dump_pad(be64toh(sec->len)) > qc_dump_in.len - off - sizeof(struct qc_dump_sec_hdr)) {
+			qc_debug(hdl, "Error: Section %u in dump file '%s' is truncated\n", i, path);
+			goto out;
+		}
+		if (((char *)(sec + 1))[be64toh(sec->len)] != '\0') {
+			qc_debug(hdl, "Error: Section %u in dump file '%s' is not terminated\n", i, path);
+			goto out;
+		}
+		if (be32toh(sec->type) > 0 && be32toh(sec->type) <= QC_DUMP_SEC_MAX &&
+		    !qc_dump_secs[be32toh(sec->type)].buf) {
+			qc_dump_secs[be32toh(sec->type)].buf = (char *)(sec + 1);
+			qc_dump_secs[be32toh(sec->type)].len = be64toh(sec->len);
+		}
+		off += sizeof(struct qc_dump_sec_hdr) + qc_dump_pad(be64toh(sec->len));
+	}
+	qc_dump_in.len = off;
+	qc_dump_indexed = 1;
+	qc_debug(hdl, "Mapped dump file '%s' with %u section(s), written by qclib v%.16s\n", path,
+		 be32toh(hdr->count), hdr->qc_version);
+	rc = 0;
+	if ((s = qc_dump_find(QC_DUMP_SEC_INCOMPLETE, &len)) != NULL) {
+		qc_debug(hdl, "Error: Dump at %s is incomplete, cannot use. Missing: %.*s\n", path,
+			 (int)len, s);
+		rc = 1;
+	}
+
+out:
+	if (fd != -1)
+		close(fd);
+	if (rc)
+		qc_dump_unload();
+
+	return rc;
+}
+
+// Add 'len' Bytes at 'buf' as section 'type'. Text is copied to add a terminating zero Byte.
+static int qc_dump_add_buffer(struct qc_handle *hdl, int type, const void *buf, size_t len, int text) {
+	struct qc_dump_sec *sec = &qc_dump_secs[type];
+
+	if (!buf)
+		return 0;
+	if (text) {
+		if ((sec->copy = malloc(len + 1)) == NULL) {
+			qc_debug(hdl, "Error: Mem alloc failed, cannot copy %s\n", qc_dump_sec_names[type]);
+			return -1;
+		}
+		memcpy(sec->copy, buf, len);
+		sec->copy[len] = '\0';
+		buf = sec->copy;
+	}
+	sec->buf = buf;
+	sec->len = len;
+	qc_debug(hdl, "Use %zd Bytes of %s\n", len, qc_dump_sec_names[type]);
+
+	return 0;
+}
+
+/* Makes the data in 'bufs' available as if it was read from a dump file. Binary data is
+   used in place, hence must remain valid until qc_dump_unload().
+   Returns 0 on success, and <0 on error. */
+int qc_dump_use_buffers(struct qc_handle *hdl, const struct qc_buffers *bufs) {
+	qc_dump_unload();
+	qc_dump_indexed = 1;
+	if (qc_dump_add_buffer(hdl, QC_DUMP_SEC_SYSINFO, bufs->sysinfo, bufs->sysinfo_len, 1) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_DIAG_204, bufs->diag_204, bufs->diag_204_len, 0) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_DIAG_2FC, bufs->diag_2fc, bufs->diag_2fc_len, 0) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_STHYI, bufs->sthyi, bufs->sthyi_len, 0) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_CPC_NAME, bufs->cpc_name, bufs->cpc_name_len, 1) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_HAS_SECURE, bufs->has_secure, bufs->has_secure_len, 1) ||
+	    qc_dump_add_buffer(hdl, QC_DUMP_SEC_SECURE, bufs->secure, bufs->secure_len, 1)) {
+		qc_dump_unload();
+		return -1;
+	}
+
+	return 0;
+}
+
+void qc_dump_unload(void) {
+	int i;
+
+	if (qc_dump_in.buf)
+		munmap(qc_dump_in.buf, qc_dump_in.size);
+	memset(&qc_dump_in, 0, sizeof(qc_dump_in));
+	for (i = 0; i < qc_dump_num_maps; ++i)
+		munmap(qc_dump_maps[i].addr, qc_dump_maps[i].size);
+	free(qc_dump_maps);
+	qc_dump_maps = NULL;
+	qc_dump_num_maps = 0;
+	for (i = 0; i <= QC_DUMP_SEC_MAX; ++i)
+		free(qc_dump_secs[i].copy);
+	memset(qc_dump_secs, 0, sizeof(qc_dump_secs));
+	qc_dump_indexed = 0;
+}
+
+/* Returns whether the dump data is held in memory, i.e. stems from a dump file or
+   from qc_open_from_buffers() rather than from a dump directory */
+int qc_dump_in_memory(void) {
+	return qc_dump_indexed;
+}
+
+/* Returns whether 'p' points into data handed out by qc_dump_map(), i.e. must not be freed */
+int qc_dump_owns(const void *p) {
+	const char *c = p;
+	int i;
+
+	for (i = 0; i <= QC_DUMP_SEC_MAX; ++i)
+		if (qc_dump_secs[i].buf && c >= qc_dump_secs[i].buf &&
+		    c <= qc_dump_secs[i].buf + qc_dump_secs[i].len)
+			return 1;
+	for (i = 0; i < qc_dump_num_maps; ++i)
+		if (c >= (char *)qc_dump_maps[i].addr && c < (char *)qc_dump_maps[i].addr + qc_dump_maps[i].size)
+			return 1;
+
+	return 0;
+}
+
+/* Returns whether the dump contains data for section 'type', stored in 'file'
+   relative to the dump directory when using the directory format. */
+int qc_dump_has(int type, const char *file) {
+	char *path;
+	size_t len;
+	int rc;
+
+	if (qc_dump_in_memory())
+		return qc_dump_find(type, &len) != NULL;
+	if (asprintf(&path, "%s/%s", qc_dbg_use_dump, file) == -1)
+		return 0;
+	rc = access(path, R_OK) == 0;
+	free(path);
+
+	return rc;
+}
+
+/* Maps 'path' followed by a zero Byte. The zero Byte is provided by an anonymous
+   mapping that the file is mapped over, since the file's size might be a multiple
+   of the page size. */
+static int qc_dump_map_file(struct qc_handle *hdl, const char *path, const char **buf, size_t *len) {
+	struct qc_dump_map *maps;
+	struct stat sb;
+	size_t size;
+	char *addr;
+	int fd, rc = -1;
+
+	if ((fd = open(path, O_RDONLY)) == -1) {
+		qc_debug(hdl, "File '%s' not available\n", path);
+		return 1;
+	}
+	if (fstat(fd, &sb)) {
+		qc_debug(hdl, "Error: Failed to stat '%s': %s\n", path, strerror(errno));
+		goto out;
+	}
+	if ((maps = realloc(qc_dump_maps, (qc_dump_num_maps + 1) * sizeof(*maps))) == NULL) {
+		qc_debug(hdl, "Error: Mem alloc failed, cannot map '%s'\n", path);
+		goto out;
+	}
+	qc_dump_maps = maps;
+	size = sb.st_size + 1;
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) {
+		qc_debug(hdl, "Error: Failed to map '%s': %s\n", path, strerror(errno));
+		goto out;
+	}
+	if (sb.st_size && mmap(addr, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+			       fd, 0) == MAP_FAILED) {
+		qc_debug(hdl, "Error: Failed to map '%s': %s\n", path, strerror(errno));
+		munmap(addr, size);
+		goto out;
+	}
+	qc_stats_add(syscalls, 4);	// open, fstat and two mmaps
+	qc_stats_add(bytes_read, sb.st_size);
+	qc_dump_maps[qc_dump_num_maps].addr = addr;
+	qc_dump_maps[qc_dump_num_maps].size = size;
+	++qc_dump_num_maps;
+	*buf = addr;
+	*len = sb.st_size;
+	rc = 0;
+
+out:
+	close(fd);
+
+	return rc;
+}
+
+/* Maps section 'type' of the dump, or 'file' when using the directory format.
+   Returns 0 on success with 'buf' pointing to the data and its length in 'len', >0 if the
+   data is not available, and <0 on error. The data stays valid until qc_dump_unload().
+   Text sections are always zero-terminated. Data read from dumps is also zero-terminated
+   and 8-Byte aligned, while binary data passed to qc_open_from_buffers() is used as is.
+   Use qc_dump_owns() to tell it from data that was allocated otherwise. */
+int qc_dump_map(struct qc_handle *hdl, int type, const char *file, const char **buf, size_t *len) {
+	char *path = NULL;
+	int rc;
+
+	*buf = NULL;
+	*len = 0;
+	if (qc_dump_in_memory()) {
+		if ((*buf = qc_dump_find(type, len)) == NULL) {
+			qc_debug(hdl, "No %s data in dump\n", qc_dump_sec_names[type]);
+			return 1;
+		}
+		return 0;
+	}
+	if (asprintf(&path, "%s/%s", qc_dbg_use_dump, file) == -1) {
+		qc_debug(hdl, "Error: Mem alloc failed, cannot read dump\n");
+		return -1;
+	}
+	rc = qc_dump_map_file(hdl, path, buf, len);
+	free(path);
+
+	return rc;
+}
+
+/* Like qc_dump_map(), but returns a malloc'd copy of the data in 'buf' */
+int qc_dump_read(struct qc_handle *hdl, int type, const char *file, char **buf, size_t *len) {
+	const char *p;
+	int rc;
+
+	*buf = NULL;
+	if ((rc = qc_dump_map(hdl, type, file, &p, len)) != 0)
+		return rc;
+	if ((*buf = malloc(*len + 1)) == NULL) {
+		qc_debug(hdl, "Error: Mem alloc failed, cannot read dump\n");
+		return -1;
+	}
+	memcpy(*buf, p, *len + 1);
+
+	return 0;
+}
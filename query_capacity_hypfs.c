@@ -4,101 +4,58 @@
 #define _DEFAULT_SOURCE
 
 #include <sys/stat.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
 #include <fcntl.h>
 #include <dirent.h>
-#include <mntent.h>
 #include <endian.h>
 
 #include "query_capacity_data.h"
+#include "query_capacity_hypfs.h"
 
 
 #define QC_HYPFS_LPAR		"/s390_hypfs/diag_204"
 #define QC_HYPFS_ZVM		"/s390_hypfs/diag_2fc"
-#define QC_NAME_LEN		8
-#define QC_CPU_TYPE_CP		0
-#define QC_CPU_TYPE_IFL		3
-#define QC_CPU_TYPE_ZIIP	5
-
-#define QC_FLAG_PHYS		0x80
-#define QC_CPU_DEDICATED	0xffff
-#define QC_CPU_CONFIGURED	0x20
-#define QC_CPU_CAPPED		0x40
+#define QC_DEBUGFS_DEFAULT	"/sys/kernel/debug"
+#define QC_MOUNTINFO		"/proc/self/mountinfo"
 
 #define HYPFS_NA		0
 #define HYPFS_AVAIL_BIN_LPAR	3
 #define HYPFS_AVAIL_BIN_ZVM	4
 
+#define QC_IDX_CP		0
+#define QC_IDX_IFL		1
+#define QC_IDX_ZIIP		2
+#define QC_NUM_IDX		3
+
+static const __u8 qc_cpu_types[QC_NUM_IDX] = {QC_CPU_TYPE_CP, QC_CPU_TYPE_IFL, QC_CPU_TYPE_ZIIP};
+
+// Per-section entry of the decoded diag_204 data
+struct hypfs_lpar {
+	struct dfs_sys_hdr *hdr;	// points into the raw buffer, used for names only
+	int	first;			// index of the section's first CPU in the CPU columns
+	int	num;			// number of CPUs in the section
+};
 
-struct dfs_diag_hdr {
-	__u64     len;
-	__u16     version;
-	__u8      tod_ext[16];
-	__u64     count;
-	__u8      reserved[30];
-} __attribute__ ((packed));
-
-struct dfs_info_blk_hdr {
-	__u8      npar;
-	__u8      flags;
-	__u8      reserved1[4];
-	__u16     thispart;
-	__u64     curtod1;
-	__u64     curtod2;
-	__u8      reserved[40];
-} __attribute__ ((packed));
-
-struct dfs_sys_hdr {
-	__u8      reserved1;
-	__u8      cpus;
-	__u8      rcpus;
-	__u8      reserved2[5];
-	char      sys_name[8];
-	__u8      reserved3[48];
-	char      grp_name[8];
-	__u8      reserved4[24];
-} __attribute__ ((packed));
-
-// Note: We do with a single struct for CPU info only, though formally each section type
-//       has its own struct defined. However, all relevant parts match across all sections.
-struct dfs_cpu_info {
-	__u16     cpu_addr;
-	__u16     reserved1;
-	__u8      ctidx;
-	__u8      cflag;
-	__u16	  weight;
-	__u64     acc_time;
-	__u64     lp_time;
-	__u64     reserved3;
-	__u64     online_time;
-	__u32     reserved4[4];
-	__u32     cpuTypeCap;
-	__u32     groupCpuTypeCap;
-	__u32     reserved5[8];
-} __attribute__ ((packed));
-
-struct dfs_diag2fc {
-	__u32     version;
-	__u32     flags;
-	__u64     used_cpu;
-	__u64     el_time;
-	__u64     mem_min_kb;
-	__u64     mem_max_kb;
-	__u64     mem_share_kb;
-	__u64     mem_used_kb;
-	__u32     pcpus;
-	__u32     lcpus;
-	__u32     vcpus;
-	__u32     ocpus;
-	__u32     cpu_max;
-	__u32     cpu_shares;
-	__u32     cpu_use_samp;
-	__u32     cpu_delay_samp;
-	__u32     page_wait_samp;
-	__u32     idle_samp;
-	__u32     other_samp;
-	__u32     total_samp;
-	char    guest_name[QC_NAME_LEN];
-} __attribute__ ((packed));
+/* Columnar representation of a diag_204 buffer, decoded in a single pass with all
+   fields in host byte order. Sections 0..npar-1 are the LPARs, followed by the
+   physical section at index npar if gpd is set. */
+struct hypfs_diag204 {
+	int	npar;
+	int	gpd;
+	int	tgt;			// index of our own LPAR, -1 if not found
+	struct dfs_sys_hdr *tgt_hdr;
+	struct hypfs_lpar  *lpars;
+	int	num_cpus;
+	__u64  *acc_time;
+	__u64  *lp_time;
+	__u64  *online_time;
+	__u32  *abs_cap;
+	__u32  *grp_cap;
+	__u16  *weight;
+	__u8   *type;
+	__u8   *cflag;
+};
 
 struct hypfs_priv {
 	char   *data;
@@ -106,80 +63,74 @@ struct hypfs_priv {
 	ssize_t len;
 	char   *diag;
 	char   *hypfs;
+	long	size;		// allocated size of data
+	int	diag_reads;	// number of reads, each triggering a diagnose
+	struct hypfs_diag204 d204;
 };
 
-// Returns a malloc'd string with the concatenated path
-static char *qc_get_path(struct qc_handle *hdl, const char *dbgfs, const char *file) {
-	char *buf;
+/* Buffer and size learned per diag file across qc_open() calls, so we can usually
+   read the data in one go instead of reading the header first. The buffer is handed
+   out to hypfs_priv while in use. */
+struct hypfs_diag_cache {
+	const char *diag;
+	char	   *buf;
+	long	    size;	// allocated size of buf
+	long	    learned;	// size of the last complete read, 0 if unknown
+};
 
-	if (asprintf(&buf, "%s%s", dbgfs, file) == -1) {
-		qc_debug(hdl, "Error: Buffer allocation failed\n");
-		buf = NULL;
+static struct hypfs_diag_cache qc_diag_cache[] = {
+	{QC_HYPFS_LPAR, NULL, 0, 0},
+	{QC_HYPFS_ZVM, NULL, 0, 0},
+};
+
+// debugfs mount point found by the last qc_get_mountpoint() call
+static char *qc_dbgfs_mp;
+
+static void __attribute__((destructor)) qc_hypfs_destructor(void) {
+	unsigned int i;
+
+	free(qc_dbgfs_mp);
+	qc_dbgfs_mp = NULL;
+	for (i = 0; i < sizeof(qc_diag_cache) / sizeof(qc_diag_cache[0]); ++i) {
+		free(qc_diag_cache[i].buf);
+		qc_diag_cache[i].buf = NULL;
 	}
+}
 
-	return buf;
+static struct hypfs_diag_cache *qc_get_diag_cache(const char *diag) {
+	return strcmp(diag, QC_HYPFS_LPAR) ? &qc_diag_cache[1] : &qc_diag_cache[0];
 }
 
-static void qc_dump_hypfs_bin(struct qc_handle *hdl, const char *diag, __u8 *data, ssize_t len) {
-	char *fname = NULL, *cmd;
-	int fd, rc, success = 0;
+// Return a buffer that was read via qc_read_diag_file() to the cache
+static void qc_put_diag_buf(struct hypfs_priv *priv) {
+	struct hypfs_diag_cache *cache;
 
-	/* We re-create the same directory/file structure that we read from */
-	// first off, create a subdirectory so the files look exactly like on dbgfs
-	if (!data) {
-		qc_debug(hdl, "Error: No data passed in, cannot write binary dump\n");
-		goto out;
-	}
-	if (asprintf(&fname, "%s/s390_hypfs", qc_dbg_dump_dir) == -1) {
-		qc_debug(hdl, "Error: Mem alloc error, cannot create dump dir\n");
-		goto out;
-	}
-	mkdir(fname, S_IRWXU);	// we don't care about a failure - could exist from a previous dump,
-				// and we'll know when we store the actual data if things are good
-	free(fname);
-	if (asprintf(&fname, "%s/%s", qc_dbg_dump_dir,
-		strcmp(diag, QC_HYPFS_LPAR) ? QC_HYPFS_ZVM : QC_HYPFS_LPAR) == -1) {
-		qc_debug(hdl, "Error: Mem alloc error, cannot write dump\n");
-		goto out;
-	}
-	fd = open(fname, O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR);
-	if (fd == -1) {
-		qc_debug(hdl, "Error: Failed to open file '%s' to write dump\n", fname);
-		goto out;
+	if (!priv->data)
+		return;
+	if (qc_dump_owns(priv->data)) {
+		priv->data = NULL;
+		return;
 	}
-	rc = write(fd, data, len);
-	close(fd);
-	if (rc == -1) {
-		qc_debug(hdl, "Error: Failed to write binary hypfs data into dump: %s\n",
-									strerror(errno));
+	cache = qc_get_diag_cache(priv->diag);
+	if (!cache->buf) {
+		cache->buf = priv->data;
+		cache->size = priv->size;
 	} else {
-		qc_debug(hdl, "hypfs binary data dumped to '%s'\n", fname);
-		success = 1;
-	}
-
-	if (strcmp(diag, QC_HYPFS_ZVM) == 0) {
-		// if we're on z/VM, we need to make sure that the LPAR file exists, as logic
-		// uses it as a flag to indicate presence of the binary hypfs API
-		if (asprintf(&cmd, "/bin/touch %s/%s > /dev/null 2>&1", qc_dbg_dump_dir,
-								QC_HYPFS_LPAR) == -1) {
-			qc_debug(hdl, "Error: Mem alloc failure, could not touch '%s'. "
-				"Dump will not work without, fix by adding it manually later on.\n",
-				QC_HYPFS_LPAR);
-			qc_mark_dump_incomplete(hdl, QC_HYPFS_LPAR);
-			goto out;
-		}
-		if ((rc = system(cmd)) != 0) {
-			qc_debug(hdl, "Error: Command '%s' failed, rc=%d. Dump will not work "
-				"without, fix by adding it manually later on.\n", cmd, rc);
-			qc_mark_dump_incomplete(hdl, QC_HYPFS_LPAR);
-		}
-		free(cmd);
+		free(priv->data);
 	}
+	priv->data = NULL;
+}
 
-out:
-	free(fname);
-	if (!success)
-		qc_mark_dump_incomplete(hdl, "hypfs binary");
+// Returns a malloc'd string with the concatenated path
+static char *qc_get_path(struct qc_handle *hdl, const char *dbgfs, const char *file) {
+	char *buf;
+
+	if (asprintf(&buf, "%s%s", dbgfs, file) == -1) {
+		qc_debug(hdl, "Error: Buffer allocation failed\n");
+		buf = NULL;
+	}
+
+	return buf;
 }
 
 static void qc_hypfs_dump(struct qc_handle *hdl, char *buf) {
@@ -192,7 +143,8 @@ static void qc_hypfs_dump(struct qc_handle *hdl, char *buf) {
 	switch(priv->avail) {
 	case HYPFS_AVAIL_BIN_LPAR:
 	case HYPFS_AVAIL_BIN_ZVM:
-		qc_dump_hypfs_bin(hdl, priv->diag, (__u8 *)priv->data, priv->len);
+		qc_dump_add(hdl, strcmp(priv->diag, QC_HYPFS_LPAR) ? QC_DUMP_SEC_DIAG_2FC : QC_DUMP_SEC_DIAG_204,
+			    priv->data, priv->len);
 		break;
 	case HYPFS_NA:
 	default:
@@ -205,122 +157,188 @@ out:
 	return;
 }
 
-static int qc_fill_in_hypfs_lpar_values_bin(struct qc_handle *hdl, __u8 *data) {
-	int ziip = 0, ziip_ded = 0, ziip_cap = 0, ziip_weight = 0, ziip_abs_cap = 0, ziip_all_weight = 0, ziip_w, *ziip_sh;
-	int ifl = 0, ifl_ded = 0, ifl_cap = 0, ifl_weight = 0, ifl_abs_cap = 0, ifl_all_weight = 0, ifl_w, *ifl_sh;
-	int cp = 0, cp_ded = 0, cp_cap = 0, cp_weight = 0, cp_abs_cap = 0, cp_all_weight = 0, cp_w, *cp_sh;
-	int un = 0, i, j, rc = -1, gpd_available;
-	struct dfs_sys_hdr *sys_hdr, *tgt_lpar;
+static void qc_hypfs_free_diag204(struct hypfs_diag204 *d) {
+	free(d->lpars);
+	free(d->acc_time);	// start of the column block
+	bzero(d, sizeof(struct hypfs_diag204));
+}
+
+/* Decode the diag_204 buffer into columns in one pass. Sections are validated
+   against the buffer length, so consumers can index the columns without checks. */
+static int qc_hypfs_decode_diag204(struct qc_handle *hdl, struct hypfs_priv *priv) {
+	struct hypfs_diag204 *d = &priv->d204;
+	__u8 *end = (__u8 *)priv->data + priv->len;
 	struct dfs_info_blk_hdr *time_hdr;
+	struct dfs_sys_hdr *sys_hdr;
 	struct dfs_cpu_info *cpu;
+	int i, j, n, max, num;
+
+	if (priv->len < (ssize_t)(sizeof(struct dfs_diag_hdr) + sizeof(struct dfs_info_blk_hdr))) {
+		qc_debug(hdl, "Error: diag_204 data too short (%zd Bytes)\n", priv->len);
+		return -1;
+	}
+	time_hdr = (struct dfs_info_blk_hdr *)(priv->data + sizeof(struct dfs_diag_hdr));
+	d->npar = time_hdr->npar;
+	d->gpd = time_hdr->flags & QC_FLAG_PHYS;
+	d->tgt = -1;
+	d->tgt_hdr = (struct dfs_sys_hdr *)((__u8 *)time_hdr + htobe16(time_hdr->thispart));
+	// upper bound for the number of CPU records, so we can allocate everything up front
+	max = (end - (__u8 *)(time_hdr + 1)) / sizeof(struct dfs_cpu_info) + 1;
+	d->lpars = malloc((d->npar + 1) * sizeof(struct hypfs_lpar));
+	d->acc_time = malloc(max * (3 * sizeof(__u64) + 2 * sizeof(__u32) + sizeof(__u16) + 2 * sizeof(__u8)));
+	if (!d->lpars || !d->acc_time) {
+		qc_debug(hdl, "Error: Failed to allocate diag_204 columns\n");
+		goto out_err;
+	}
+	d->lp_time = d->acc_time + max;
+	d->online_time = d->lp_time + max;
+	d->abs_cap = (__u32 *)(d->online_time + max);
+	d->grp_cap = d->abs_cap + max;
+	d->weight = (__u16 *)(d->grp_cap + max);
+	d->type = (__u8 *)(d->weight + max);
+	d->cflag = d->type + max;
+
+	sys_hdr = (struct dfs_sys_hdr *)(time_hdr + 1);
+	for (i = 0, n = 0; i < d->npar + (d->gpd ? 1 : 0); ++i) {
+		cpu = (struct dfs_cpu_info *)(sys_hdr + 1);
+		if ((__u8 *)cpu > end)
+			goto out_trunc;
+		// physical section lists all CPUs, LPAR sections only the reported ones
+		num = i < d->npar ? sys_hdr->rcpus : sys_hdr->cpus;
+		if ((__u8 *)(cpu + num) > end)
+			goto out_trunc;
+		if (i < d->npar && sys_hdr == d->tgt_hdr)
+			d->tgt = i;
+		d->lpars[i].hdr = sys_hdr;
+		d->lpars[i].first = n;
+		d->lpars[i].num = num;
+		for (j = 0; j < num; ++j, ++cpu, ++n) {
+			d->type[n] = cpu->ctidx;
+			d->cflag[n] = cpu->cflag;
+			d->weight[n] = htobe16(cpu->weight);
+			d->abs_cap[n] = htobe32(cpu->cpuTypeCap);
+			d->grp_cap[n] = htobe32(cpu->groupCpuTypeCap);
+			d->acc_time[n] = htobe64(cpu->acc_time);
+			d->lp_time[n] = htobe64(cpu->lp_time);
+			d->online_time[n] = htobe64(cpu->online_time);
+		}
+		sys_hdr = (struct dfs_sys_hdr *)cpu;
+	}
+	d->num_cpus = n;
+	qc_debug(hdl, "Decoded %d LPAR(s) with %d cpus total, own LPAR at index %d\n", d->npar, n, d->tgt);
+
+	return 0;
+
+out_trunc:
+	qc_debug(hdl, "Error: diag_204 section %d exceeds data length of %zd Bytes\n", i, priv->len);
+out_err:
+	qc_hypfs_free_diag204(d);
+
+	return -1;
+}
+
+/* Count CPUs of 'type' (any type if <0) in section 'lpar' whose cflag has all bits
+   of 'mask' set, with the number of dedicated ones in 'ded'. Branch-free over the
+   columns so the compiler can vectorize the loop. */
+static int qc_hypfs_count_cpus(struct hypfs_diag204 *d, int lpar, int type, __u8 mask, int *ded) {
+	int i, c, num = 0, num_ded = 0, last = d->lpars[lpar].first + d->lpars[lpar].num;
+
+	for (i = d->lpars[lpar].first; i < last; ++i) {
+		c = (type < 0 || d->type[i] == type) & ((d->cflag[i] & mask) == mask);
+		num += c;
+		num_ded += c & (d->weight[i] == QC_CPU_DEDICATED);
+	}
+	if (ded)
+		*ded = num_ded;
+
+	return num;
+}
+
+/* Returns the column index of the last configured CPU of 'type' in section 'lpar',
+   skipping dedicated CPUs if 'shared' is set, or -1 if there is none. */
+static int qc_hypfs_last_cpu(struct hypfs_diag204 *d, int lpar, __u8 type, int shared) {
+	int i;
+
+	for (i = d->lpars[lpar].first + d->lpars[lpar].num - 1; i >= d->lpars[lpar].first; --i) {
+		if (d->type[i] == type && d->cflag[i] & QC_CPU_CONFIGURED &&
+		    (!shared || d->weight[i] != QC_CPU_DEDICATED))
+			return i;
+	}
+
+	return -1;
+}
+
+static int qc_fill_in_hypfs_lpar_values_bin(struct qc_handle *hdl, struct hypfs_diag204 *d) {
+	int num[QC_NUM_IDX] = {0}, ded[QC_NUM_IDX] = {0}, cap[QC_NUM_IDX] = {0}, abs_cap[QC_NUM_IDX] = {0};
+	int weight[QC_NUM_IDX] = {0}, all_weight[QC_NUM_IDX] = {0}, *cp_sh, *ifl_sh, *ziip_sh;
+	int un = 0, i, t, c, rc = -1, cap_active = 0;
 	struct qc_handle *group;
-	int cap_active = 0;
 
 	qc_debug(hdl, "Add LPAR values from binary hypfs API\n");
 	qc_debug_indent_inc();
-	time_hdr = (struct dfs_info_blk_hdr *)(data + sizeof(struct dfs_diag_hdr));
-	sys_hdr = (struct dfs_sys_hdr *)(time_hdr + 1);
-	tgt_lpar = (void *)(struct dfs_info_blk_hdr *)(data + sizeof(struct dfs_diag_hdr)) + htobe16(time_hdr->thispart);
-	gpd_available = time_hdr->flags & QC_FLAG_PHYS;
-	qc_debug(hdl, "Found data for %d LPAR(s), GPD data is %savailable\n", time_hdr->npar, gpd_available ? "" : "NOT ");
-	for (i = 0; i < time_hdr->npar; ++i) {
-		cpu = (struct dfs_cpu_info*)(sys_hdr + 1);
-		cp_w = ifl_w = 0, ziip_w = 0;
-		for (j = 0; j < sys_hdr->rcpus; ++j, ++cpu) {
-			if (!(cpu->cflag & QC_CPU_CONFIGURED))
-				continue;
-			if (sys_hdr == tgt_lpar && cpu->cflag & QC_CPU_CAPPED)
-				cap_active = 1;
-			switch (cpu->ctidx) {
-			case QC_CPU_TYPE_CP:
-				if (sys_hdr == tgt_lpar) {
-					cp++;
-					cp_cap = htobe32(cpu->groupCpuTypeCap);
-					cp_abs_cap = htobe32(cpu->cpuTypeCap);
-					if (cpu->weight == QC_CPU_DEDICATED)
-						cp_ded++;
-					else
-						cp_weight = htobe16(cpu->weight);
-				}
-				if (cpu->weight != QC_CPU_DEDICATED)
-					cp_w = htobe16(cpu->weight);
-				break;
-			case QC_CPU_TYPE_IFL:
-				if (sys_hdr == tgt_lpar) {
-					ifl++;
-					ifl_cap = htobe32(cpu->groupCpuTypeCap);
-					ifl_abs_cap = htobe32(cpu->cpuTypeCap);
-					if (cpu->weight == QC_CPU_DEDICATED)
-						ifl_ded++;
-					else
-						ifl_weight = htobe16(cpu->weight);
-				}
-				if (cpu->weight != QC_CPU_DEDICATED)
-					ifl_w = htobe16(cpu->weight);
-				break;
-			case QC_CPU_TYPE_ZIIP:
-				if (sys_hdr == tgt_lpar) {
-					ziip++;
-					ziip_cap = htobe32(cpu->groupCpuTypeCap);
-					ziip_abs_cap = htobe32(cpu->cpuTypeCap);
-					if (cpu->weight == QC_CPU_DEDICATED)
-						ziip_ded++;
-					else
-						ziip_weight = htobe16(cpu->weight);
-				}
-				if (cpu->weight != QC_CPU_DEDICATED)
-					ziip_w = htobe16(cpu->weight);
-				break;
-			default:
-				if (sys_hdr == tgt_lpar)
-					un++;
-				break;
+	qc_debug(hdl, "Found data for %d LPAR(s), GPD data is %savailable\n", d->npar, d->gpd ? "" : "NOT ");
+	if (d->tgt >= 0) {
+		for (t = 0; t < QC_NUM_IDX; ++t) {
+			num[t] = qc_hypfs_count_cpus(d, d->tgt, qc_cpu_types[t], QC_CPU_CONFIGURED, &ded[t]);
+			if ((c = qc_hypfs_last_cpu(d, d->tgt, qc_cpu_types[t], 0)) >= 0) {
+				cap[t] = d->grp_cap[c];
+				abs_cap[t] = d->abs_cap[c];
 			}
+			if ((c = qc_hypfs_last_cpu(d, d->tgt, qc_cpu_types[t], 1)) >= 0)
+				weight[t] = d->weight[c];
+		}
+		un = qc_hypfs_count_cpus(d, d->tgt, -1, QC_CPU_CONFIGURED, NULL) -
+			num[QC_IDX_CP] - num[QC_IDX_IFL] - num[QC_IDX_ZIIP];
+		cap_active = qc_hypfs_count_cpus(d, d->tgt, -1, QC_CPU_CONFIGURED | QC_CPU_CAPPED, NULL) > 0;
+	}
+	// each LPAR contributes the weight of its last shared CPU per type
+	for (i = 0; (qc_plan & QC_PLAN_HYPFS_WEIGHTS) && i < d->npar; ++i) {
+		for (t = 0; t < QC_NUM_IDX; ++t) {
+			if ((c = qc_hypfs_last_cpu(d, i, qc_cpu_types[t], 1)) >= 0)
+				all_weight[t] += d->weight[c];
 		}
-		cp_all_weight += cp_w;
-		ifl_all_weight += ifl_w;
-		ziip_all_weight += ziip_w;
-		sys_hdr = (struct dfs_sys_hdr *)cpu;
 	}
-	qc_debug(hdl, "Found %d cpus total (%d CP, %d IFL, %d zIIP, %d UN)\n", cp + ifl + ziip + un, cp, ifl, ziip, un);
+	qc_debug(hdl, "Found %d cpus total (%d CP, %d IFL, %d zIIP, %d UN)\n",
+		num[QC_IDX_CP] + num[QC_IDX_IFL] + num[QC_IDX_ZIIP] + un,
+		num[QC_IDX_CP], num[QC_IDX_IFL], num[QC_IDX_ZIIP], un);
 	hdl = qc_hdl_get_lpar(hdl);
-	if (qc_set_attr_int(hdl, qc_num_cp_total, cp, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_cp_dedicated, cp_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_cp_shared, cp - cp_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_total, ifl, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_dedicated, ifl_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_shared, ifl - ifl_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_total, ziip, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_dedicated, ziip_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_shared, ziip - ziip_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_cp_absolute_capping, cp_abs_cap * 0x10000 / 100, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_ifl_absolute_capping, ifl_abs_cap * 0x10000 / 100, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_ziip_absolute_capping, ziip_abs_cap * 0x10000 / 100, ATTR_SRC_HYPFS))
+	if (qc_set_attr_int(hdl, qc_num_cp_total, num[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_cp_dedicated, ded[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_cp_shared, num[QC_IDX_CP] - ded[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_total, num[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_dedicated, ded[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_shared, num[QC_IDX_IFL] - ded[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_total, num[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_dedicated, ded[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_shared, num[QC_IDX_ZIIP] - ded[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_cp_absolute_capping, abs_cap[QC_IDX_CP] * 0x10000 / 100, ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_ifl_absolute_capping, abs_cap[QC_IDX_IFL] * 0x10000 / 100, ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_ziip_absolute_capping, abs_cap[QC_IDX_ZIIP] * 0x10000 / 100, ATTR_SRC_HYPFS))
 		goto out_err;
-	if (gpd_available) {
+	if (d->gpd && (qc_plan & QC_PLAN_HYPFS_WEIGHTS)) {
 		cp_sh = qc_get_attr_value_int(qc_hdl_get_cec(hdl), qc_num_cp_shared);
 		ifl_sh = qc_get_attr_value_int(qc_hdl_get_cec(hdl), qc_num_ifl_shared);
 		ziip_sh = qc_get_attr_value_int(qc_hdl_get_cec(hdl), qc_num_ziip_shared);
 		if (cap_active && cp_sh && ifl_sh &&
-		    (qc_set_attr_int(hdl, qc_cp_weight_capping, cp_weight ? *cp_sh * 0x10000 * cp_weight / cp_all_weight : 0, ATTR_SRC_HYPFS) ||
-		     qc_set_attr_int(hdl, qc_ifl_weight_capping, ifl_weight ? *ifl_sh * 0x10000 * ifl_weight / ifl_all_weight : 0, ATTR_SRC_HYPFS) ||
-		     qc_set_attr_int(hdl, qc_ziip_weight_capping, ziip_weight ? *ziip_sh * 0x10000 * ziip_weight / ziip_all_weight : 0, ATTR_SRC_HYPFS)))
+		    (qc_set_attr_int(hdl, qc_cp_weight_capping, weight[QC_IDX_CP] ? *cp_sh * 0x10000 * weight[QC_IDX_CP] / all_weight[QC_IDX_CP] : 0, ATTR_SRC_HYPFS) ||
+		     qc_set_attr_int(hdl, qc_ifl_weight_capping, weight[QC_IDX_IFL] ? *ifl_sh * 0x10000 * weight[QC_IDX_IFL] / all_weight[QC_IDX_IFL] : 0, ATTR_SRC_HYPFS) ||
+		     qc_set_attr_int(hdl, qc_ziip_weight_capping, weight[QC_IDX_ZIIP] ? *ziip_sh * 0x10000 * weight[QC_IDX_ZIIP] / all_weight[QC_IDX_ZIIP] : 0, ATTR_SRC_HYPFS)))
 			goto out_err;
 	}
-	if (qc_is_nonempty_ebcdic((__u64*)tgt_lpar->grp_name)) {
+	if (d->tgt >= 0 && qc_is_nonempty_ebcdic((__u64*)d->tgt_hdr->grp_name)) {
 		/* LPAR group is only defined in case group name is not binary zero */
 		qc_debug(hdl, "Insert LPAR group layer\n");
 		if (qc_hdl_insert(hdl, &group, QC_LAYER_TYPE_LPAR_GROUP)) {
 			qc_debug(hdl, "Error: Failed to insert LPAR group layer\n");
 			goto out_err;
 		}
-		rc = qc_set_attr_ebcdic_string(group, qc_layer_name, (unsigned char *)tgt_lpar->grp_name, sizeof(tgt_lpar->grp_name), ATTR_SRC_STHYI);
-		if (cp_cap)
-			rc |= qc_set_attr_int(group, qc_cp_absolute_capping, cp_cap * 0x10000 / 100, ATTR_SRC_STHYI);
-		if (ifl_cap)
-			rc |= qc_set_attr_int(group, qc_ifl_absolute_capping, ifl_cap * 0x10000 / 100, ATTR_SRC_STHYI);
-		if (ziip_cap)
-			rc |= qc_set_attr_int(group, qc_ziip_absolute_capping, ziip_cap * 0x10000 / 100, ATTR_SRC_STHYI);
+		rc = qc_set_attr_ebcdic_string(group, qc_layer_name, (unsigned char *)d->tgt_hdr->grp_name, sizeof(d->tgt_hdr->grp_name), ATTR_SRC_STHYI);
+		if (cap[QC_IDX_CP])
+			rc |= qc_set_attr_int(group, qc_cp_absolute_capping, cap[QC_IDX_CP] * 0x10000 / 100, ATTR_SRC_STHYI);
+		if (cap[QC_IDX_IFL])
+			rc |= qc_set_attr_int(group, qc_ifl_absolute_capping, cap[QC_IDX_IFL] * 0x10000 / 100, ATTR_SRC_STHYI);
+		if (cap[QC_IDX_ZIIP])
+			rc |= qc_set_attr_int(group, qc_ziip_absolute_capping, cap[QC_IDX_ZIIP] * 0x10000 / 100, ATTR_SRC_STHYI);
 	}
 	rc = 0;
 
@@ -330,61 +348,33 @@ out_err:
 	return rc;
 }
 
-static int qc_fill_in_hypfs_cec_values_bin(struct qc_handle *hdl, __u8 *data) {
-	int num_ifl = 0, num_ifl_ded = 0, num_ziip = 0, num_ziip_ded = 0, num_cp = 0, num_cp_ded = 0, num_un = 0, i, rc = 0;
-	struct dfs_sys_hdr *sys_hdr = NULL;
-	struct dfs_info_blk_hdr *time_hdr;
-	struct dfs_cpu_info *cpu;
+static int qc_fill_in_hypfs_cec_values_bin(struct qc_handle *hdl, struct hypfs_diag204 *d) {
+	int num[QC_NUM_IDX], ded[QC_NUM_IDX], num_un, t, rc = 0;
 
 	qc_debug(hdl, "Add CEC values from binary hypfs API\n");
 	qc_debug_indent_inc();
-	time_hdr = (struct dfs_info_blk_hdr *)(data + sizeof(struct dfs_diag_hdr));
-	if (!(time_hdr->flags & QC_FLAG_PHYS)) {
+	if (!d->gpd) {
 		qc_debug(hdl, "GPD data is NOT available\n");
 		goto out;
 	}
 
-	data = (__u8 *)(time_hdr + 1);
-	for (i = 0; i < time_hdr->npar; ++i) {
-		sys_hdr = (struct dfs_sys_hdr*)data;
-		data += (sizeof(struct dfs_sys_hdr) + (sys_hdr->rcpus * sizeof(struct dfs_cpu_info)));
-	}
-	sys_hdr = (struct dfs_sys_hdr*)data;
-	cpu = (struct dfs_cpu_info*)(sys_hdr + 1);
-	for (i = 0; i < sys_hdr->cpus; ++i, ++cpu) {
-		switch (cpu->ctidx) {
-		case QC_CPU_TYPE_CP:
-			num_cp++;
-			if (cpu->weight == QC_CPU_DEDICATED)
-				num_cp_ded++;
-			break;
-		case QC_CPU_TYPE_IFL:
-			num_ifl++;
-			if (cpu->weight == QC_CPU_DEDICATED)
-				num_ifl_ded++;
-			break;
-		case QC_CPU_TYPE_ZIIP:
-			num_ziip++;
-			if (cpu->weight == QC_CPU_DEDICATED)
-				num_ziip_ded++;
-			break;
-		default:
-			num_un++;
-			break;
-		}
-	}
-	qc_debug(hdl, "CPs=%d, dedicated CPs=%d, IFLs=%d, dedicated IFLs=%d, zIIPs=%d, dedicated zIIPs=%d, unknown=%d\n", num_cp, num_cp_ded, num_ifl, num_ifl_ded, num_ziip, num_ziip_ded, num_un);
-	if (qc_set_attr_int(hdl, qc_num_cp_total, num_cp, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_cp_dedicated, num_cp_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_cp_shared, num_cp - num_cp_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_total, num_ifl, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_dedicated, num_ifl_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ifl_shared, num_ifl - num_ifl_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_total, num_ziip, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_dedicated, num_ziip_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_ziip_shared, num_ziip - num_ziip_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_core_dedicated, num_cp_ded + num_ifl_ded, ATTR_SRC_HYPFS) ||
-	    qc_set_attr_int(hdl, qc_num_core_shared, num_ifl + num_cp - num_cp_ded - num_ifl_ded, ATTR_SRC_HYPFS))
+	// physical section is located right after the LPAR sections
+	for (t = 0; t < QC_NUM_IDX; ++t)
+		num[t] = qc_hypfs_count_cpus(d, d->npar, qc_cpu_types[t], 0, &ded[t]);
+	num_un = d->lpars[d->npar].num - num[QC_IDX_CP] - num[QC_IDX_IFL] - num[QC_IDX_ZIIP];
+	qc_debug(hdl, "CPs=%d, dedicated CPs=%d, IFLs=%d, dedicated IFLs=%d, zIIPs=%d, dedicated zIIPs=%d, unknown=%d\n",
+		num[QC_IDX_CP], ded[QC_IDX_CP], num[QC_IDX_IFL], ded[QC_IDX_IFL], num[QC_IDX_ZIIP], ded[QC_IDX_ZIIP], num_un);
+	if (qc_set_attr_int(hdl, qc_num_cp_total, num[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_cp_dedicated, ded[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_cp_shared, num[QC_IDX_CP] - ded[QC_IDX_CP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_total, num[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_dedicated, ded[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ifl_shared, num[QC_IDX_IFL] - ded[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_total, num[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_dedicated, ded[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_ziip_shared, num[QC_IDX_ZIIP] - ded[QC_IDX_ZIIP], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_core_dedicated, ded[QC_IDX_CP] + ded[QC_IDX_IFL], ATTR_SRC_HYPFS) ||
+	    qc_set_attr_int(hdl, qc_num_core_shared, num[QC_IDX_IFL] + num[QC_IDX_CP] - ded[QC_IDX_CP] - ded[QC_IDX_IFL], ATTR_SRC_HYPFS))
 		rc = -1;
 
 out:
@@ -393,49 +383,108 @@ out:
 	return rc;
 }
 
+// Decode the dumped diag data in place, see qc_dump_map()
+static int qc_read_diag_dump(struct qc_handle *hdl, struct hypfs_priv *priv) {
+	const struct dfs_diag_hdr *hdr;
+	const char *data;
+	size_t len;
+
+	if (qc_dump_map(hdl, strcmp(priv->diag, QC_HYPFS_LPAR) ? QC_DUMP_SEC_DIAG_2FC : QC_DUMP_SEC_DIAG_204,
+			priv->diag, &data, &len))
+		return 1;
+	hdr = (const struct dfs_diag_hdr *)data;
+	if (len < sizeof(struct dfs_diag_hdr) || sizeof(struct dfs_diag_hdr) + htobe64(hdr->len) != len ||
+	    (strcmp(priv->diag, QC_HYPFS_LPAR) &&
+	     htobe64(hdr->count) > (len - sizeof(struct dfs_diag_hdr)) / sizeof(struct dfs_diag2fc))) {
+		qc_debug(hdl, "Error: Inconsistent content of %s in dump\n", priv->diag);
+		return 1;
+	}
+	priv->data = (char *)data;
+	priv->len = len;
+
+	return 0;
+}
+
+/* Reads the diag file, which needs to happen in one(!) go. If we know the size from
+   a previous call, we read with some headroom right away. Otherwise, or if the data
+   turns out to be truncated, we read the header first to learn the required size. */
 static int qc_read_diag_file(struct qc_handle *hdl, const char *dbgfs, struct hypfs_priv *priv) {
-	long buflen = sizeof(struct dfs_diag_hdr);
+	struct hypfs_diag_cache *cache = qc_get_diag_cache(priv->diag);
 	struct dfs_diag_hdr *hdr;
-	int fh, i = 0, rc = 0;
+	long buflen;
+	int fh, probe, i = 0, rc = 0;
 	char *fpath = NULL;
 	ssize_t lrc;
 
+	qc_inject_delay(hdl, QC_PHASE_HYPFS_OPEN);
+	if (qc_dbg_use_dump)
+		return qc_read_diag_dump(hdl, priv);
 	if ((fpath = qc_get_path(hdl, dbgfs, priv->diag)) == NULL)
 		goto out_fail;
 	qc_debug(hdl, "Read in file '%s'\n", fpath);
-	// file content needs to be read in one(!) go
+	// take over the cached buffer, so we won't lose it in case of errors
+	priv->data = cache->buf;
+	priv->size = cache->size;
+	cache->buf = NULL;
+	cache->size = 0;
+	probe = !cache->learned;	// reading the header only doesn't make the next read a retry
+	if (cache->learned)
+		buflen = cache->learned + cache->learned / 8;
+	else
+		buflen = sizeof(struct dfs_diag_hdr);
 	for (i = 0; i < 10; ++i) {
+		if (buflen > priv->size) {
+			free(priv->data);
+			priv->size = 0;
+			priv->data = malloc(buflen);
+			qc_stats_add(allocations, 1);
+			if (!priv->data) {
+				qc_debug(hdl, "Error: Failed to allocate '%ld' Bytes for file content\n",
+											buflen);
+				goto out_fail;
+			}
+			priv->size = buflen;
+		}
 		fh = open(fpath, O_RDONLY);
 		if (fh == -1) {
 			qc_debug(hdl, "Error: Failed to open file '%s'\n", fpath);
 			goto out_fail;
 		}
-		priv->data = malloc(buflen);
-		if (!priv->data) {
-			qc_debug(hdl, "Error: Failed to allocate '%ld' Bytes for file content\n",
-											buflen);
-			goto out_fail;
-		}
 		lrc = read(fh, priv->data, buflen);
 		close(fh);
+		priv->diag_reads++;
+		qc_stats_add(diag_reads, 1);
+		qc_stats_add(syscalls, 3);	// open, read and close
+		if (i > probe) {
+			qc_stats_add(diag_retries, 1);
+			qc_probe3(diag__retry, hdl, i, buflen);
+		}
 		if (lrc == -1) {
 			qc_debug(hdl, "Error: Failed to read '%ld' Bytes from '%s'\n", buflen, priv->diag);
-			close(fh);
+			goto out_fail;
+		}
+		if (lrc < (ssize_t)sizeof(struct dfs_diag_hdr)) {
+			qc_debug(hdl, "Error: Read only %zd Bytes from '%s'\n", lrc, priv->diag);
 			goto out_fail;
 		}
 		hdr = (struct dfs_diag_hdr*)priv->data;
-		if ((buflen = sizeof(struct dfs_diag_hdr) + htobe64(hdr->len)) == lrc) {
+		qc_stats_add(bytes_read, lrc);
+		if (sizeof(struct dfs_diag_hdr) + htobe64(hdr->len) == lrc) {
 			priv->len = lrc;
+			cache->learned = lrc;
 			break;
 		}
-		free(priv->data);
-		priv->data = NULL;
+		// truncated: retry with the size we just learned, plus some headroom
+		buflen = sizeof(struct dfs_diag_hdr) + htobe64(hdr->len);
+		buflen += buflen / 8;
 	}
 	if (i >= 10) {
 		qc_debug(hdl, "Error: Tried %d times, still no consistent content "
 			"- giving up\n", i + 1);
-		rc = 1;
+		cache->learned = 0;
+		goto out_fail;
 	}
+	qc_debug(hdl, "Read %zd Bytes with %d diagnose(s)\n", priv->len, priv->diag_reads);
 	goto out;
 
 out_fail:
@@ -475,21 +524,30 @@ static struct qc_handle *qc_get_zvm_hdl(struct qc_handle *hdl, const char **s) {
 
 // Returns diag data for highest layer z/VM instance in var 'data', with pointer to entire data
 // stored in 'buf' (must be free()'d), and updates hdl to point to respective handle.
+// We convert our own name to EBCDIC once and compare raw 8-byte names, accepting blank
+// as well as binary zero padding.
 static int qc_get_zvm_diag_data(struct qc_handle **hdl, struct dfs_diag_hdr *hdr, struct dfs_diag2fc **data) {
-	char name[QC_NAME_LEN + 1];
+	__u64 key_blank, key_zero, name;
+	char ebcdic[QC_NAME_LEN];
+	struct dfs_diag2fc *rec;
+	uint64_t i, count;
 	const char *s;
-	int i;
 
 	if ((*hdl = qc_get_zvm_hdl(*hdl, &s)) == NULL)
 		return -1;
-	qc_debug(*hdl, "Found data for %" PRIu64 " z/VM guest(s)\n", htobe64((uint64_t)hdr->count));
-	for (i = 0, *data = (struct dfs_diag2fc*)(hdr + 1); i < htobe64(hdr->count); ++i, ++*data) {
-		memset(&name, 0, QC_NAME_LEN + 1);
-		memcpy(name, (*data)->guest_name, QC_NAME_LEN);
-		if (qc_ebcdic_to_ascii(*hdl, name, QC_NAME_LEN) != 0)
-			return -2;
-		if (strcmp(name, s) == 0)
+	count = htobe64((uint64_t)hdr->count);
+	qc_debug(*hdl, "Found data for %" PRIu64 " z/VM guest(s)\n", count);
+	if (qc_ascii_to_ebcdic(*hdl, s, ebcdic, QC_NAME_LEN) != 0)
+		return -2;
+	memcpy(&key_blank, ebcdic, QC_NAME_LEN);
+	memset(ebcdic + strlen(s), 0, QC_NAME_LEN - strlen(s));
+	memcpy(&key_zero, ebcdic, QC_NAME_LEN);
+	for (i = 0, rec = (struct dfs_diag2fc *)(hdr + 1); i < count; ++i, ++rec) {
+		memcpy(&name, rec->guest_name, QC_NAME_LEN);
+		if (name == key_blank || name == key_zero) {
+			*data = rec;
 			return 0;
+		}
 	}
 	qc_debug(*hdl, "Error: No matching data found for z/VM guest '%s'\n", s);
 	return -3;
@@ -544,59 +602,122 @@ out:
 	return rc;
 }
 
-/* Retrieve mountpoint of fstype from /etc/mtab.
+/* Returns whether diag file 'diag' is available. When running on a dump file, the
+   LPAR diag file only serves as an indicator of the binary API and is therefore not
+   stored on z/VM. */
+static int qc_hypfs_has_diag(struct qc_handle *hdl, const char *dbgfs, const char *diag) {
+	char *fpath;
+	int rc;
+
+	if (qc_dbg_use_dump) {
+		if (strcmp(diag, QC_HYPFS_LPAR))
+			return qc_dump_has(QC_DUMP_SEC_DIAG_2FC, diag);
+		return qc_dump_has(QC_DUMP_SEC_DIAG_204, diag) ||
+		       (qc_dump_in_memory() && qc_dump_has(QC_DUMP_SEC_DIAG_2FC, QC_HYPFS_ZVM));
+	}
+	if ((fpath = qc_get_path(hdl, dbgfs, diag)) == NULL)
+		return 0;
+	rc = access(fpath, R_OK) == 0;
+	free(fpath);
+
+	return rc;
+}
+
+static int qc_is_debugfs(const char *path) {
+	struct statfs buf;
+
+	return statfs(path, &buf) == 0 && buf.f_type == DEBUGFS_MAGIC;
+}
+
+// Undo the octal escaping of blanks etc. in mountinfo paths, in place
+static void qc_unescape_mountinfo(char *s) {
+	char *d = s;
+
+	for (; *s; ++s, ++d) {
+		if (s[0] == '\\' && s[1] >= '0' && s[1] <= '3' && s[2] >= '0' && s[2] <= '7' &&
+		    s[3] >= '0' && s[3] <= '7') {
+			*d = (s[1] - '0') << 6 | (s[2] - '0') << 3 | (s[3] - '0');
+			s += 3;
+		} else
+			*d = *s;
+	}
+	*d = '\0';
+}
+
+/* Retrieve the first mountpoint of fstype from /proc/self/mountinfo.
    Returns 0 on success with malloc'd mountpoint in 'mp', >0 if not found and
    <0 in case of an error. */
-static int qc_get_mountpoint(struct qc_handle *hdl, char *fstype, char **mp) {
-	struct mntent *mntbuf;
+static int qc_scan_mountinfo(struct qc_handle *hdl, const char *fstype, char **mp) {
+	char *line = NULL, *sptr, *tok, *dir;
+	size_t n = 0;
 	FILE *mounts;
-	char *fname;
+	int i, rc = 1;
+
+	mounts = fopen(QC_MOUNTINFO, "r");
+	if (!mounts) {
+		qc_debug(hdl, "Error: Failed to open %s\n", QC_MOUNTINFO);
+		return -1;
+	}
+	// Format: id parent major:minor root mountpoint options [optional fields] - fstype source superoptions
+	while (rc > 0 && getline(&line, &n, mounts) != -1) {
+		dir = NULL;
+		for (i = 0, tok = strtok_r(line, " \n", &sptr); tok; tok = strtok_r(NULL, " \n", &sptr), ++i) {
+			if (i == 4)
+				dir = tok;
+			if (i > 5 && strcmp(tok, "-") == 0)
+				break;
+		}
+		if (!tok || !dir || (tok = strtok_r(NULL, " \n", &sptr)) == NULL || strcmp(tok, fstype))
+			continue;
+		qc_unescape_mountinfo(dir);
+		if ((*mp = strdup(dir)) == NULL) {
+			qc_debug(hdl, "Error: Failed to allocate buffer\n");
+			rc = -2;
+		} else
+			rc = 0;
+	}
+	free(line);
+	fclose(mounts);
+
+	return rc;
+}
+
+/* Retrieve mountpoint of fstype, trying the conventional location and a cached
+   result first, and falling back to /proc/self/mountinfo.
+   Returns 0 on success with malloc'd mountpoint in 'mp', >0 if not found and
+   <0 in case of an error. */
+static int qc_get_mountpoint(struct qc_handle *hdl, char *fstype, char **mp) {
 	int rc;
 
 	if (qc_dbg_use_dump) {
-		// dumped data will look exactly like if on dbgfs or hypfs, so all we need
-		// to do is point *mp to the right directory - if the respective data is present,
-		// which we check with a simple sanity check
+		// dumped data will look exactly like if on dbgfs, so all we need to do is
+		// point *mp to the dump - if the respective data is present
 		qc_debug(hdl, "Read hypfs from dump\n");
-		if (strcmp(fstype, "s390_hypfs") == 0) {
-			if (asprintf(&fname, "%s/hyp", qc_dbg_use_dump) == -1) {
-				qc_debug(hdl, "Error: Mem alloc failed, cannot read dump\n");
-				return -1;
-			}
-		} else {
-			if (asprintf(&fname, "%s/%s", qc_dbg_use_dump, QC_HYPFS_LPAR) == -1) {
-				qc_debug(hdl, "Error: Mem alloc failed, cannot read dump\n");
-				return -1;
-			}
-		}
-		rc = access(fname, R_OK);
-		free(fname);
-		if (rc)
+		if (!qc_hypfs_has_diag(hdl, NULL, QC_HYPFS_LPAR))
 			return 1;
 		*mp = strdup(qc_dbg_use_dump);
 		return 0;
 	}
 	qc_debug(hdl, "Locate mount point of %s\n", fstype);
 	*mp = NULL;
-	mounts = setmntent(_PATH_MOUNTED, "r");
-	if (!mounts) {
-		qc_debug(hdl, "Error: Failed to open %s\n", _PATH_MOUNTED);
-		return -1;
-	}
-	while ((mntbuf = getmntent(mounts)) != NULL) {
-		if (strcmp(mntbuf->mnt_type, fstype) == 0) {
-			*mp = strdup(mntbuf->mnt_dir);
-			if (!*mp) {
-				qc_debug(hdl, "Error: Failed to allocate buffer\n");
-				endmntent(mounts);
-				return -2;
-			}
-			break;
+	if (strcmp(fstype, "debugfs") == 0) {
+		// a single statfs() tells whether the cached or default location is still good
+		if (!qc_dbgfs_mp || !qc_is_debugfs(qc_dbgfs_mp)) {
+			free(qc_dbgfs_mp);
+			qc_dbgfs_mp = NULL;
+			if (qc_is_debugfs(QC_DEBUGFS_DEFAULT))
+				qc_dbgfs_mp = strdup(QC_DEBUGFS_DEFAULT);
+			else if ((rc = qc_scan_mountinfo(hdl, fstype, &qc_dbgfs_mp)) < 0)
+				return rc;
 		}
-	}
-	endmntent(mounts);
+		if (qc_dbgfs_mp && (*mp = strdup(qc_dbgfs_mp)) == NULL) {
+			qc_debug(hdl, "Error: Failed to allocate buffer\n");
+			return -2;
+		}
+	} else if ((rc = qc_scan_mountinfo(hdl, fstype, mp)) < 0)
+		return rc;
 	if (!*mp) {
-		qc_debug(hdl, "%s not mounted according to '%s'\n", fstype, _PATH_MOUNTED);
+		qc_debug(hdl, "%s not mounted according to '%s'\n", fstype, QC_MOUNTINFO);
 		return 1;
 	}
 	qc_debug(hdl, "%s mounted at '%s'\n", fstype, *mp);
@@ -605,8 +726,8 @@ static int qc_get_mountpoint(struct qc_handle *hdl, char *fstype, char **mp) {
 }
 
 static int qc_hypfs_open(struct qc_handle *hdl, char **buf) {
-	char *dbgfs = NULL, *fpath = NULL;
 	struct hypfs_priv *priv;
+	char *dbgfs = NULL;
 	int rc = 0;
 
 	qc_debug(hdl, "Retrieve hypfs information\n");
@@ -624,20 +745,9 @@ static int qc_hypfs_open(struct qc_handle *hdl, char **buf) {
 		goto out;
 	if (rc == 0) {
 		// LPAR diag file is always present if binary interface is available
-		if ((fpath = qc_get_path(hdl, dbgfs, QC_HYPFS_LPAR)) == NULL) {
-			rc = -2;
-			goto out;
-		}
-		rc = access(fpath, R_OK);
-		free(fpath);
-		fpath = NULL;
-		if (rc == 0) {
+		if (qc_hypfs_has_diag(hdl, dbgfs, QC_HYPFS_LPAR)) {
 			qc_debug(hdl, "Use binary hypfs API\n");
-			if ((fpath = qc_get_path(hdl, dbgfs, QC_HYPFS_ZVM)) == NULL) {
-				rc = -3;
-				goto out;
-			}
-			if (access(fpath, R_OK) == 0) {
+			if (qc_hypfs_has_diag(hdl, dbgfs, QC_HYPFS_ZVM)) {
 				/* if z/VM diag file exists, the LPAR diag file's content
 				   isn't valid, so we're done after handling the z/VM file */
 				priv->diag = QC_HYPFS_ZVM;
@@ -665,7 +775,6 @@ static int qc_hypfs_open(struct qc_handle *hdl, char **buf) {
 out:
 	qc_debug_indent_dec();
 	free(dbgfs);
-	free(fpath);
 
 	return rc;
 }
@@ -673,7 +782,8 @@ out:
 static void qc_hypfs_close(struct qc_handle *hdl, char *buf) {
 	struct hypfs_priv *priv = (struct hypfs_priv *)buf;
 	if (priv) {
-		free(priv->data);
+		qc_hypfs_free_diag204(&priv->d204);
+		qc_put_diag_buf(priv);
 		free(priv->hypfs);
 		free(priv);
 	}
@@ -690,8 +800,12 @@ static int qc_hypfs_process(struct qc_handle *hdl, char *buf) {
 		goto out;
 	}
 	if (priv->avail == HYPFS_AVAIL_BIN_LPAR) {
-		rc = qc_fill_in_hypfs_cec_values_bin(hdl->root, (__u8 *)priv->data) ||
-		    qc_fill_in_hypfs_lpar_values_bin(hdl, (__u8 *)priv->data);
+		if (!priv->d204.lpars && qc_hypfs_decode_diag204(hdl, priv)) {
+			rc = -1;
+			goto out;
+		}
+		rc = qc_fill_in_hypfs_cec_values_bin(hdl->root, &priv->d204) ||
+		    qc_fill_in_hypfs_lpar_values_bin(hdl, &priv->d204);
 		goto out;
 	}
 	if (priv->avail == HYPFS_AVAIL_BIN_ZVM) {
@@ -710,4 +824,5 @@ struct qc_data_src hypfs = {qc_hypfs_open,
 			    qc_hypfs_dump,
 			    qc_hypfs_close,
 			    NULL,
-			    NULL};
+			    NULL,
+			    QC_PHASE_HYPFS_OPEN};
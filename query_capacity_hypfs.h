@@ -0,0 +1,91 @@
+/* Copyright IBM Corp. 2013, 2026 */
+
+/* Binary format of the diag data in s390_hypfs, as found in debugfs and in dumps */
+
+#ifndef QUERY_CAPACITY_HYPFS
+#define QUERY_CAPACITY_HYPFS
+
+#include <linux/types.h>
+
+#define QC_NAME_LEN		8
+#define QC_CPU_TYPE_CP		0
+#define QC_CPU_TYPE_IFL		3
+#define QC_CPU_TYPE_ZIIP	5
+
+#define QC_FLAG_PHYS		0x80
+#define QC_CPU_DEDICATED	0xffff
+#define QC_CPU_CONFIGURED	0x20
+#define QC_CPU_CAPPED		0x40
+
+struct dfs_diag_hdr {
+	__u64     len;
+	__u16     version;
+	__u8      tod_ext[16];
+	__u64     count;
+	__u8      reserved[30];
+} __attribute__ ((packed));
+
+struct dfs_info_blk_hdr {
+	__u8      npar;
+	__u8      flags;
+	__u8      reserved1[4];
+	__u16     thispart;
+	__u64     curtod1;
+	__u64     curtod2;
+	__u8      reserved[40];
+} __attribute__ ((packed));
+
+struct dfs_sys_hdr {
+	__u8      reserved1;
+	__u8      cpus;
+	__u8      rcpus;
+	__u8      reserved2[5];
+	char      sys_name[8];
+	__u8      reserved3[48];
+	char      grp_name[8];
+	__u8      reserved4[24];
+} __attribute__ ((packed));
+
+// Note: We do with a single struct for CPU info only, though formally each section type
+//       has its own struct defined. However, all relevant parts match across all sections.
+struct dfs_cpu_info {
+	__u16     cpu_addr;
+	__u16     reserved1;
+	__u8      ctidx;
+	__u8      cflag;
+	__u16	  weight;
+	__u64     acc_time;
+	__u64     lp_time;
+	__u64     reserved3;
+	__u64     online_time;
+	__u32     reserved4[4];
+	__u32     cpuTypeCap;
+	__u32     groupCpuTypeCap;
+	__u32     reserved5[8];
+} __attribute__ ((packed));
+
+struct dfs_diag2fc {
+	__u32     version;
+	__u32     flags;
+	__u64     used_cpu;
+	__u64     el_time;
+	__u64     mem_min_kb;
+	__u64     mem_max_kb;
+	__u64     mem_share_kb;
+	__u64     mem_used_kb;
+	__u32     pcpus;
+	__u32     lcpus;
+	__u32     vcpus;
+	__u32     ocpus;
+	__u32     cpu_max;
+	__u32     cpu_shares;
+	__u32     cpu_use_samp;
+	__u32     cpu_delay_samp;
+	__u32     page_wait_samp;
+	__u32     idle_samp;
+	__u32     other_samp;
+	__u32     total_samp;
+	char    guest_name[QC_NAME_LEN];
+} __attribute__ ((packed));
+
+#endif
@@ -19,6 +19,7 @@
 
 /* Miscellaneous structures and constants */
 #define STR_BUF_SIZE		257
+#define QC_ATTR_ID_MAX		qc_secure	// highest value in enum qc_attr_id
 
 #define ATTR_SRC_SYSINFO	'S'
 #define ATTR_SRC_SYSFS		'F'
@@ -26,6 +27,7 @@
 #define ATTR_SRC_STHYI		'V'
 #define ATTR_SRC_POSTPROC	'P'	// Note: Post-processed attributes can have multiple origins - would be
 					//       complicated to figure out accurately. We leave it at 'P' for now
+#define ATTR_SRC_EXTERNAL	'X'	// see qc_register_source()
 #define ATTR_SRC_UNDEF		'_'
 
 #ifndef htobe16	// fallbacks for systems with a glibc < 2.9
@@ -49,6 +51,10 @@ struct qc_handle {
 	char		 *src;		// array indicating the source of the attribute's value, see ATTR_SRC_*
 	struct qc_handle *next;
 	struct qc_handle *root;		// points to top handle
+	struct qc_handle **layers;	// root only: all layers indexed by layer_no, see qc_hdl_register()
+	int		  num_layers;	// root only
+	unsigned int	  topology;	// root only: fingerprint of the layer types, see qc_resolve()
+	struct qc_stats	 *stats;	// root only: statistics of qc_open(), see qc_get_stats()
 };
 
 struct qc_data_src {
@@ -58,12 +64,20 @@ struct qc_data_src {
 	void (*close)(struct qc_handle *, char *);
 	int  (*lgm_check)(struct qc_handle *, const char *);
 	char *priv;
+	int   phase;	// QC_PHASE_*_OPEN of the source, followed by process, dump and close
 };
 
+/* Offsets of the per-source phases relative to qc_data_src.phase */
+#define QC_SRC_OPEN		0
+#define QC_SRC_PROCESS		1
+#define QC_SRC_DUMP		2
+#define QC_SRC_CLOSE		3
+
 extern struct qc_data_src sysinfo, sysfs, hypfs, sthyi;
 
 /* Utility functions */
 int qc_ebcdic_to_ascii(struct qc_handle *hdl, char *inbuf, size_t insz);
+int qc_ascii_to_ebcdic(struct qc_handle *hdl, const char *in, char *out, size_t outsz);
 int qc_is_nonempty_ebcdic(__u64 *str);
 int qc_hdl_new(struct qc_handle *hdl, struct qc_handle **tgthdl, int layer_no, int layer_type);
 // Insert new layer 'inserted_hdl' of type 'type' before 'hdl'. Won't support inserting a new root
@@ -82,18 +96,103 @@ int qc_hdl_get_layer_no(struct qc_handle *hdl);
 /* Debugging-related functions and variables */
 extern long  qc_dbg_level;
 extern FILE *qc_dbg_file;
-extern char *qc_dbg_dump_dir;
 extern char *qc_dbg_use_dump;
 extern int   qc_dbg_indent;
 extern int   qc_dbg_console;
 extern int   qc_consistency_check_requested;
+extern int   qc_plan;
 void qc_debug_indent_inc();
 void qc_debug_indent_dec();
-void qc_mark_dump_incomplete(struct qc_handle *hdl, char *missing_component);
+void qc_inject_delay(struct qc_handle *hdl, int phase);
+int  qc_sysinfo_changed(char **prev);
+
+/* Binary trace ring, see query_capacity_trace.c */
+extern int qc_trace_enabled;
+int  qc_trace_init(long num, int sig);
+void qc_trace_log(const void *hdl, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+void qc_trace_flush(void);
+void qc_mark_dump_incomplete(struct qc_handle *hdl, const char *missing_component);
+
+/* Single-file dump container, see query_capacity_dump.c */
+#define QC_DUMP_SEC_SYSINFO	1
+#define QC_DUMP_SEC_DIAG_204	2
+#define QC_DUMP_SEC_DIAG_2FC	3
+#define QC_DUMP_SEC_STHYI	4
+#define QC_DUMP_SEC_CPC_NAME	5
+#define QC_DUMP_SEC_HAS_SECURE	6
+#define QC_DUMP_SEC_SECURE	7
+#define QC_DUMP_SEC_INCOMPLETE	8
+#define QC_DUMP_SEC_MAX		QC_DUMP_SEC_INCOMPLETE
+int  qc_dump_begin(struct qc_handle *hdl);
+void qc_dump_add(struct qc_handle *hdl, int type, const void *data, size_t len);
+int  qc_dump_write(struct qc_handle *hdl, const char *path);
+void qc_dump_end(void);
+int  qc_dump_load(struct qc_handle *hdl, const char *path);
+int  qc_dump_use_buffers(struct qc_handle *hdl, const struct qc_buffers *bufs);
+void qc_dump_unload(void);
+int  qc_dump_in_memory(void);
+int  qc_dump_has(int type, const char *file);
+int  qc_dump_owns(const void *p);
+int  qc_dump_map(struct qc_handle *hdl, int type, const char *file, const char **buf, size_t *len);
+int  qc_dump_read(struct qc_handle *hdl, int type, const char *file, char **buf, size_t *len);
+
+/* Statistics, see query_capacity_stats.c. Global counters are updated with relaxed atomics, so
+   they can be read anytime. 'qc_stats_cur' collects the statistics of the qc_open() call in progress
+   in the current thread, if any. */
+extern struct qc_stats qc_stats_global;
+extern __thread struct qc_stats *qc_stats_cur;
+unsigned long long qc_stats_now(void);
+// Returns the time since 'start' in nanoseconds
+unsigned long long qc_stats_phase(int phase, unsigned long long start);
+
+#define qc_stats_add(field, n)	do { \
+	unsigned long long qc_stats_n = (n); \
+	__atomic_fetch_add(&qc_stats_global.field, qc_stats_n, __ATOMIC_RELAXED); \
+	if (qc_stats_cur) \
+		qc_stats_cur->field += qc_stats_n; \
+	} while (0)
+
+/* USDT probes of provider 'qclib' for SystemTap, bpftrace and perf, see README.md for a list.
+   Compiled out if <sys/sdt.h> is not available, or when building with -DQC_NO_PROBES. */
+#if !defined(QC_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define QC_HAVE_PROBES
+#endif
+#endif
+#ifdef QC_HAVE_PROBES
+#define qc_probe1(name, a)		DTRACE_PROBE1(qclib, name, a)
+#define qc_probe2(name, a, b)		DTRACE_PROBE2(qclib, name, a, b)
+#define qc_probe3(name, a, b, c)	DTRACE_PROBE3(qclib, name, a, b, c)
+#define qc_probe4(name, a, b, c, d)	DTRACE_PROBE4(qclib, name, a, b, c, d)
+#else
+// Arguments are never evaluated, but still count as used
+#define qc_probe1(name, a)		do { if (0) { (void)(a); } } while (0)
+#define qc_probe2(name, a, b)		do { if (0) { (void)(a); (void)(b); } } while (0)
+#define qc_probe3(name, a, b, c)	do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+#define qc_probe4(name, a, b, c, d)	do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+#endif
+
+// Hash function for the attribute name lookup, shared with qc_gen_attrs
+static inline unsigned int qc_attr_hash(const char *s, size_t len, unsigned int seed) {
+	unsigned int h = 2166136261u ^ (seed * 0x9e3779b9u);
+
+	while (len--) {
+		h ^= (unsigned char)*s++;
+		h *= 16777619u;
+	}
+	h ^= h >> 15;
+	h *= 0x2c1b3c6du;
+	h ^= h >> 12;
+
+	return h;
+}
 
 
 #define qc_debug(hdl, arg, ...)	do { \
-	if (qc_dbg_level > 0) { \
+	if (qc_trace_enabled) { \
+		qc_trace_log(qc_hdl_get_root(hdl), arg, ##__VA_ARGS__); \
+	} else if (qc_dbg_level > 0) { \
 		if (qc_dbg_console) { \
 			fprintf(stderr, "%*s" arg, qc_dbg_indent, "", ##__VA_ARGS__); \
 		} else { \
@@ -0,0 +1,38 @@
+/* Copyright IBM Corp. 2026 */
+
+#include "query_capacity_int.h"
+
+
+struct qc_stats qc_stats_global;
+__thread struct qc_stats *qc_stats_cur;
+
+// Returns a monotonic timestamp in nanoseconds
+unsigned long long qc_stats_now(void) {
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts))
+		return 0;
+
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Accounts the time since 'start' as returned by qc_stats_now() to 'phase'
+unsigned long long qc_stats_phase(int phase, unsigned long long start) {
+	unsigned long long ns = qc_stats_now() - start;
+
+	qc_stats_add(phase_ns[phase], ns);
+	qc_stats_add(phase_count[phase], 1);
+
+	return ns;
+}
+
+__attribute__ ((visibility ("default"))) void qc_get_global_stats(struct qc_stats *stats) {
+	unsigned long long *src = (unsigned long long *)&qc_stats_global, *tgt = (unsigned long long *)stats;
+	size_t i;
+
+	if (!stats)
+		return;
+	// all members are counters of the same type, so we can read them one by one
+	for (i = 0; i < sizeof(struct qc_stats) / sizeof(unsigned long long); ++i)
+		tgt[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
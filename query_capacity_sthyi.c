@@ -113,6 +113,7 @@ static int qc_sthyi_lpar(struct qc_handle *hdl, struct sthyi_priv *priv) {
 	sthyi_syscall = __NR_s390_sthyi
 #endif
 	qc_debug(hdl, "Try STHYI syscall\n");
+	qc_stats_add(syscalls, 1);
 	if (syscall(sthyi_syscall, 0, priv->data, &cc, 0) || cc) {
 		if (errno == ENOSYS) {
 			qc_debug(hdl, "STHYI syscall is not available\n");
@@ -562,80 +563,79 @@ out:
 
 static void qc_sthyi_dump(struct qc_handle *hdl, char *buf) {
 	struct sthyi_priv *priv = (struct sthyi_priv *)buf;
-	int fd, rc, success = 0;
-	char *fname = NULL;
 
 	qc_debug(hdl, "Dump STHYI\n");
 	qc_debug_indent_inc();
 	if (!priv || priv->avail != STHYI_AVAILABLE) {
 		qc_debug(hdl, "No data available\n");
-		success = 1;
 		goto out;
 	}
 	if (!priv->data) {
 		qc_debug(hdl, "Error: Cannot dump sthyi, since priv->buf == NULL\n");
+		qc_mark_dump_incomplete(hdl, "sthyi");
 		goto out;
 	}
-	if (asprintf(&fname, "%s/sthyi", qc_dbg_dump_dir) == -1) {
-		qc_debug(hdl, "Error: Mem alloc error, cannot write dump\n");
-		goto out;
-	}
-	fd = open(fname, O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR);
-	if (fd == -1) {
-		qc_debug(hdl, "Error: Failed to open file '%s' to write dump\n", fname);
-		goto out;
-	}
-	rc = write(fd, priv->data, STHYI_BUF_SIZE);
-	close(fd);
-	if (rc == -1) {
-		qc_debug(hdl, "Error: Failed to write STHYI data into dump: %s\n", strerror(errno));
-	} else {
-		qc_debug(hdl, "STHYI data dumped to '%s'\n", fname);
-		success = 1;
-	}
+	qc_dump_add(hdl, QC_DUMP_SEC_STHYI, priv->data, STHYI_BUF_SIZE);
 
 out:
-	free(fname);
-	if (!success)
-		qc_mark_dump_incomplete(hdl, "sthyi");
 	qc_debug_indent_dec();
 }
 
-static int qc_read_sthyi_dump(struct qc_handle *hdl, char *buf) {
-	char *fname = NULL;
-	int fd , rc = -1;
-	ssize_t lrc;
+// Returns 1 if 'size' bytes at big-endian offset 'off' exceed a buffer of 'len' bytes
+static int qc_sthyi_exceeds(size_t len, short int off, size_t size) {
+	return (unsigned short)htobe16(off) + size > len;
+}
 
-	if (asprintf(&fname, "%s/sthyi", qc_dbg_use_dump) == -1) {
-		qc_debug(hdl, "Error: Mem alloc error, cannot read dump\n");
-		goto out;
-	}
-	if (access(fname, F_OK)) {
-		qc_debug(hdl, "No STHYI dump available\n");
-		rc = 1;
-		goto out;
+// Verifies that all sections referenced by the STHYI header lie within the 'len' bytes at 'data'
+static int qc_verify_sthyi(struct qc_handle *hdl, const char *data, size_t len) {
+	const struct inf0hdr *header = (const struct inf0hdr *)data;
+	int num = (unsigned char)header->infhygct;
+
+	if (num > inf0ygmx || qc_sthyi_exceeds(len, header->infmoff, sizeof(struct inf0mac)) ||
+	    qc_sthyi_exceeds(len, header->infpoff, sizeof(struct inf0par)) ||
+	    (num > 0 && (qc_sthyi_exceeds(len, header->infhoff1, sizeof(struct inf0hyp)) ||
+			 qc_sthyi_exceeds(len, header->infgoff1, sizeof(struct inf0gst)))) ||
+	    (num > 1 && (qc_sthyi_exceeds(len, header->infhoff2, sizeof(struct inf0hyp)) ||
+			 qc_sthyi_exceeds(len, header->infgoff2, sizeof(struct inf0gst)))) ||
+	    (num > 2 && (qc_sthyi_exceeds(len, header->infhoff3, sizeof(struct inf0hyp)) ||
+			 qc_sthyi_exceeds(len, header->infgoff3, sizeof(struct inf0gst))))) {
+		qc_debug(hdl, "Error: Inconsistent content of sthyi in dump\n");
+		return -1;
 	}
-	if ((fd = open(fname, O_RDONLY)) == -1) {
-		qc_debug(hdl, "Error: Failed to open file '%s' to read dump\n", fname);
-		goto out;
+
+	return 0;
+}
+
+/* Points 'priv->data' to the dumped STHYI data. Short dumps are copied into the
+   zero-initialized buffer that 'priv->data' points to on entry. */
+static int qc_read_sthyi_dump(struct qc_handle *hdl, struct sthyi_priv *priv) {
+	const char *data;
+	size_t len;
+	int rc;
+
+	if ((rc = qc_dump_map(hdl, QC_DUMP_SEC_STHYI, "sthyi", &data, &len)) != 0) {
+		if (rc > 0)
+			qc_debug(hdl, "No STHYI dump available\n");
+		return rc;
 	}
-	lrc = read(fd, buf, STHYI_BUF_SIZE);
-	close(fd);
-	if (lrc == -1) {
-		qc_debug(hdl, "Error: Failed to read STHYI data dump: %s\n", strerror(errno));
+	if (len >= STHYI_BUF_SIZE) {
+		if (qc_verify_sthyi(hdl, data, len))
+			return -1;
+		free(priv->data);
+		priv->data = (char *)data;
 	} else {
-		qc_debug(hdl, "STHYI data read from '%s'\n", fname);
-		rc = 0;
+		memcpy(priv->data, data, len);
+		if (qc_verify_sthyi(hdl, priv->data, STHYI_BUF_SIZE))
+			return -1;
 	}
+	qc_debug(hdl, "STHYI data read from dump\n");
 
-out:
-	free(fname);
-
-	return rc;
+	return 0;
 }
 
 static int qc_sthyi_open(struct qc_handle *hdl, char **buf) {
 	struct sthyi_priv *priv = NULL;
+	unsigned long long t;
 	void *p = NULL;
 	int rc = 0;
 
@@ -657,25 +657,30 @@ static int qc_sthyi_open(struct qc_handle *hdl, char **buf) {
 	priv->data = (char *)p;
 	bzero(priv->data, STHYI_BUF_SIZE);
 
+	qc_inject_delay(hdl, QC_PHASE_STHYI_OPEN);
 	if (qc_dbg_use_dump) {
-		if (qc_read_sthyi_dump(hdl, priv->data) != 0)
+		if ((rc = qc_read_sthyi_dump(hdl, priv)) != 0) {
+			if (rc > 0)
+				rc = 0;	// no STHYI data in dump
 			goto out;
+		}
 		priv->avail = STHYI_AVAILABLE;
 	} else {
 		/* There is no way for us to check programmatically whether
 		   we're in an LPAR or in a VM, so we simply try out both */
+		t = qc_stats_now();
 		if (qc_is_sthyi_available_vm(hdl)) {
 			qc_debug(hdl, "Executing STHYI instruction\n");
 			/* we assume we are not relocated at this spot, between STFLE and STHYI */
 			if (qc_sthyi_vm(priv)) {
 				qc_debug(hdl, "Error: STHYI instruction execution failed\n");
 				rc = -3;
-				goto out;
 			}
 		} else {
 			qc_debug(hdl, "STHYI instruction is not available\n");
 			rc = qc_sthyi_lpar(hdl, priv);
 		}
+		qc_probe4(sthyi, hdl, rc, priv->avail, qc_stats_now() - t);
 	}
 
 out:
@@ -686,7 +691,8 @@ out:
 
 static void qc_sthyi_close(struct qc_handle *hdl, char *priv) {
 	if (priv) {
-		free(((struct sthyi_priv *)priv)->data);
+		if (!qc_dump_owns(((struct sthyi_priv *)priv)->data))
+			free(((struct sthyi_priv *)priv)->data);
 		free(priv);
 	}
 }
@@ -696,4 +702,5 @@ struct qc_data_src sthyi = {qc_sthyi_open,
 			    qc_sthyi_dump,
 			    qc_sthyi_close,
 			    NULL,
-			    NULL};
+			    NULL,
+			    QC_PHASE_STHYI_OPEN};
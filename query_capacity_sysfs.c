@@ -15,13 +15,6 @@
 #define FILE_SEC_IPL_HAS_SEC	"/sys/firmware/ipl/has_secure"
 #define FILE_SEC_IPL_SEC	"/sys/firmware/ipl/secure"
 
-static const char *sysfs_dirs[] = {"/sys",
-				   "/sys/firmware",
-				   "/sys/firmware/ocf",
-				   "/sys/firmware/ipl",
-				   NULL
-				  };
-
 struct sysfs_priv {
 	int		avail;
 	char	       *cpc_name;	// NULL if n/a
@@ -41,85 +34,15 @@ static int qc_sysfs_mkpath(struct qc_handle *hdl, const char *a, const char *b,
 	return 0;
 }
 
-/** Create directory structure that we need for our dumps - if we don't have any content later on,
-    then there simply won't be any files in there */
-static int qc_sysfs_create_dump_dirs(struct qc_handle *hdl) {
-	char *path = NULL;
-	int rc = -1, i;
-
-	for (i = 0; sysfs_dirs[i]; ++i) {
-		if (qc_sysfs_mkpath(hdl, qc_dbg_dump_dir, sysfs_dirs[i], &path))
-			goto out;
-		if (mkdir(path, 0700) == -1) {
-			qc_debug(hdl, "Error: Could not create directory %s for sysfs dump: %s\n", path, strerror(errno));
-			goto out;
-		}
-	}
-	rc = 0;
-
-out:
-	free(path);
-
-	return rc;
-}
-
-static FILE *qc_sysfs_open_dump_file(struct qc_handle *hdl, const char* file) {
-	char *path = NULL;
-	FILE *fp = NULL;
-
-	if (qc_sysfs_mkpath(hdl, qc_dbg_dump_dir, file, &path))
-		goto out;
-	if ((fp = fopen(path, "w")) == NULL) {
-		qc_debug(hdl, "Error: Failed to open '%s' to write sysfs dump\n", path);
-		goto out;
-	}
-
-out:
-	free(path);
-
-	return fp;
-}
-
-static int qc_sysfs_dump_file_char(struct qc_handle *hdl, const char* file, const char *val) {
-	FILE *fp;
-	int rc;
-
-	if (!val) {
-		qc_debug(hdl, "No data for '%s', skipping\n", file);
-		return 0;
-	}
-	fp = qc_sysfs_open_dump_file(hdl, file);
-	if (!fp)
-		return -1;
-	rc = fprintf(fp, "%s", val);
-	fclose(fp);
-	if (rc < 0) {
-		qc_debug(hdl, "Error: Failed to write dump to '%s'\n", file);
-		return -1;
-	}
-
-	return 0;
-}
-
-static int qc_sysfs_dump_file_int(struct qc_handle *hdl, const char* file, int val) {
-	FILE *fp;
-	int rc;
+static void qc_sysfs_dump_int(struct qc_handle *hdl, int type, int val) {
+	char buf[16];
 
 	if (val < 0) {
-		qc_debug(hdl, "No data for '%s', skipping\n", file);
-		return 0;
+		qc_debug(hdl, "No data for section %d, skipping\n", type);
+		return;
 	}
-	fp = qc_sysfs_open_dump_file(hdl, file);
-	if (!fp)
-		return -1;
-	rc = fprintf(fp, "%d", val);
-	fclose(fp);
-	if (rc < 0) {
-		qc_debug(hdl, "Error: Failed to write dump to '%s'\n", file);
-		return -1;
-	}
-
-	return 0;
+	snprintf(buf, sizeof(buf), "%d", val);
+	qc_dump_add(hdl, type, buf, strlen(buf));
 }
 
 static void qc_sysfs_dump(struct qc_handle *hdl, char *data) {
@@ -130,19 +53,11 @@ static void qc_sysfs_dump(struct qc_handle *hdl, char *data) {
 	if (!data)
 		goto out;
 	p = (struct sysfs_priv *)data;
-	if (qc_sysfs_create_dump_dirs(hdl)) {
-		qc_debug(hdl, "Error: Failed to create directory structure\n");
-		goto out_err;
-	}
-	if (qc_sysfs_dump_file_char(hdl, FILE_CPC_NAME, p->cpc_name) ||
-	    qc_sysfs_dump_file_int(hdl, FILE_SEC_IPL_HAS_SEC, p->has_secure) ||
-	    qc_sysfs_dump_file_int(hdl, FILE_SEC_IPL_SEC, p->secure))
-	    	goto out_err;
-	qc_debug(hdl, "sysfs data dumped to '%s%s'\n", qc_dbg_dump_dir, *sysfs_dirs);
-	goto out;
-
-out_err:
-	qc_mark_dump_incomplete(hdl, "sysfs");
+	if (p->cpc_name)
+		qc_dump_add(hdl, QC_DUMP_SEC_CPC_NAME, p->cpc_name, strlen(p->cpc_name));
+	qc_sysfs_dump_int(hdl, QC_DUMP_SEC_HAS_SECURE, p->has_secure);
+	qc_sysfs_dump_int(hdl, QC_DUMP_SEC_SECURE, p->secure);
+
 out:
 	qc_debug_indent_dec();
 
@@ -153,6 +68,8 @@ static int qc_sysfs_is_old_dump_format(struct qc_handle *hdl) {
 	char *fname = NULL;
 	int rc = -1;
 
+	if (qc_dump_in_memory())
+		return 0;
 	if (qc_sysfs_mkpath(hdl, qc_dbg_use_dump, "ocf", &fname))
 		goto out;
 	if (access(fname, F_OK) == 0) {
@@ -186,11 +103,13 @@ static int qc_sysfs_get_file_content(struct qc_handle *hdl, char *file, char **c
 	}
 	rc = getline(content, &n, fp);
 	fclose(fp);
+	qc_stats_add(syscalls, 4);	// access, open, read and close
 	if (rc == -1) {
 		qc_debug(hdl, "Error: Failed to read content of '%s': %s\n", file, strerror(errno));
 		*content = NULL;
 		return -2;
 	}
+	qc_stats_add(bytes_read, rc);
 	rc = 0;
 	if (strcmp(*content, "\n") == 0 || **content == '\0') {
 		qc_debug(hdl, "'%s' contains no data, discarding\n", file);
@@ -203,12 +122,36 @@ static int qc_sysfs_get_file_content(struct qc_handle *hdl, char *file, char **c
 	return 0;
 }
 
+/** Like qc_sysfs_get_file_content(), but reads section 'type' or 'file' from the dump
+    when running on a dump. */
+static int qc_sysfs_get_content(struct qc_handle *hdl, int type, char *file, char **content) {
+	size_t len;
+	char *p;
+	int rc;
+
+	if (!qc_dbg_use_dump)
+		return qc_sysfs_get_file_content(hdl, file, content);
+	if ((rc = qc_dump_read(hdl, type, file, content, &len)) != 0)
+		return rc;
+	// match getline() semantics
+	if ((p = strchr(*content, '\n')) != NULL)
+		p[1] = '\0';
+	if (strcmp(*content, "\n") == 0 || **content == '\0') {
+		qc_debug(hdl, "'%s' contains no data, discarding\n", file);
+		free(*content);
+		*content = NULL;
+		return 2;
+	}
+
+	return 0;
+}
+
 /** Handle numeric attributes */
-static int qc_sysfs_num_attr(struct qc_handle *hdl, char *file, int *attr) {
+static int qc_sysfs_num_attr(struct qc_handle *hdl, int type, char *file, int *attr) {
 	char *content = NULL;
 	int rc;
 
-	rc = qc_sysfs_get_file_content(hdl, file, &content);
+	rc = qc_sysfs_get_content(hdl, type, file, &content);
 	if (rc) {
 		*attr = -1;
 		if (rc > 0)
@@ -246,7 +189,6 @@ static struct sysfs_priv *qc_sysfs_init_data(struct qc_handle *hdl, char **data)
 
 static int qc_sysfs_open(struct qc_handle *hdl, char **data) {
 	struct sysfs_priv *p;
-	char *path = NULL;
 	int rc = 0, lrc;
 
 	qc_debug(hdl, "Retrieve sysfs data\n");
@@ -256,40 +198,22 @@ static int qc_sysfs_open(struct qc_handle *hdl, char **data) {
 		rc = -1;
 		goto out;
 	}
-	if (qc_dbg_use_dump) {
-		qc_debug(hdl, "Read sysfs from dump\n");
-		if (qc_sysfs_is_old_dump_format(hdl)) {
-			// Note: previously, we had a directory called 'ocf' where only one piece of data was
-			//       residing. But we have switched over to a more general sys directory instead.
-			qc_debug(hdl, "Old, ocf-based format\n");
-			if (qc_sysfs_mkpath(hdl, qc_dbg_use_dump, "ocf/cpc_name", &path)) {
-				rc = -1;
-				goto out;
-			}
-			lrc = qc_sysfs_get_file_content(hdl, path, &p->cpc_name);
-			if (lrc != 0) {
-				rc = (lrc < 0 ? -1 : 0);
-				goto out;
-			}
-			p->avail = SYSFS_AVAILABLE;
-		} else {
-			qc_debug(hdl, "New, sysfs-based format\n");
-			if (qc_sysfs_mkpath(hdl, qc_dbg_use_dump, FILE_CPC_NAME, &path) ||
-			    qc_sysfs_get_file_content(hdl, path, &p->cpc_name) < 0 ||
-			    qc_sysfs_mkpath(hdl, qc_dbg_use_dump, FILE_SEC_IPL_HAS_SEC, &path) ||
-			    qc_sysfs_num_attr(hdl, path, &p->has_secure) ||
-			    qc_sysfs_mkpath(hdl, qc_dbg_use_dump, FILE_SEC_IPL_SEC, &path) ||
-			    qc_sysfs_num_attr(hdl, path, &p->secure))
-				rc = -1;
-			else
-				p->avail = SYSFS_AVAILABLE;
+	if (qc_dbg_use_dump && qc_sysfs_is_old_dump_format(hdl)) {
+		// Note: previously, we had a directory called 'ocf' where only one piece of data was
+		//       residing. But we have switched over to a more general sys directory instead.
+		qc_debug(hdl, "Read sysfs from dump in old, ocf-based format\n");
+		lrc = qc_sysfs_get_content(hdl, QC_DUMP_SEC_CPC_NAME, "ocf/cpc_name", &p->cpc_name);
+		if (lrc != 0) {
+			rc = (lrc < 0 ? -1 : 0);
+			goto out;
 		}
+		p->avail = SYSFS_AVAILABLE;
 	} else {
-		qc_debug(hdl, "Read sysfs from system\n");
-		if (qc_sysfs_get_file_content(hdl, FILE_CPC_NAME, &p->cpc_name) < 0 ||
-		    qc_sysfs_num_attr(hdl, FILE_SEC_IPL_HAS_SEC, &p->has_secure) ||
-		    qc_sysfs_num_attr(hdl, FILE_SEC_IPL_SEC, &p->secure))
-		    	rc = -1;
+		qc_debug(hdl, "Read sysfs from %s\n", qc_dbg_use_dump ? "dump" : "system");
+		if (qc_sysfs_get_content(hdl, QC_DUMP_SEC_CPC_NAME, FILE_CPC_NAME, &p->cpc_name) < 0 ||
+		    qc_sysfs_num_attr(hdl, QC_DUMP_SEC_HAS_SECURE, FILE_SEC_IPL_HAS_SEC, &p->has_secure) ||
+		    qc_sysfs_num_attr(hdl, QC_DUMP_SEC_SECURE, FILE_SEC_IPL_SEC, &p->secure))
+			rc = -1;
 		else
 			p->avail = SYSFS_AVAILABLE;
 	}
@@ -297,7 +221,6 @@ static int qc_sysfs_open(struct qc_handle *hdl, char **data) {
 out:
 	qc_debug(hdl, "Done reading sysfs data\n");
 	qc_debug_indent_dec();
-	free(path);
 
 	return rc;
 }
@@ -348,4 +271,5 @@ struct qc_data_src sysfs = {qc_sysfs_open,
 			    qc_sysfs_dump,
 			    qc_sysfs_close,
 			    NULL,
-			    NULL};
+			    NULL,
+			    QC_PHASE_SYSFS_OPEN};
@@ -14,47 +14,23 @@ static const char *qc_sysinfo_delim = "\n";
 
 
 static void qc_sysinfo_dump(struct qc_handle *hdl, char *sysinfo) {
-	char *path;
-	FILE *f;
-
 	qc_debug(hdl, "Dump sysinfo\n");
 	qc_debug_indent_inc();
 	if (!sysinfo) {
 		// /proc/sysinfo is guaranteed to exist - if not, something went wrong
 		qc_debug(hdl, "Error: Failed to dump sysinfo, as sysinfo == NULL\n");
 		qc_mark_dump_incomplete(hdl, "sysinfo");
-		qc_debug_indent_dec();
-		return;
-	}
-	if (asprintf(&path, "%s/sysinfo", qc_dbg_dump_dir) == -1) {
-		qc_debug(hdl, "Error: Mem alloc failure, cannot dump sysinfo\n");
-		qc_mark_dump_incomplete(hdl, "sysinfo");
-		qc_debug_indent_dec();
-		return;
-	}
-	f = fopen(path, "w");
-	if (f) {
-		if (fprintf(f, "%s", sysinfo) >= 0) {
-			qc_debug(hdl, "sysinfo dumped to '%s'\n", path);
-		} else {
-			qc_debug(hdl, "Error: Failed to write dump to '%s'\n", path);
-			qc_mark_dump_incomplete(hdl, "sysinfo");
-		}
-		fclose(f);
-	} else {
-		qc_debug(hdl, "Error: Failed to open %s to write sysinfo dump\n", path);
-		qc_mark_dump_incomplete(hdl, "sysinfo");
-	}
-	free(path);
+	} else
+		qc_dump_add(hdl, QC_DUMP_SEC_SYSINFO, sysinfo, strlen(sysinfo));
 	qc_debug_indent_dec();
 
 	return;
 }
 
 static int qc_sysinfo_open(struct qc_handle *hdl, char **sysinfo) {
-	char *fname = NULL;
-	ssize_t lrc = 1, sysinfo_sz;
-	struct stat buf;
+	ssize_t lrc = 1, sysinfo_sz = 4096;
+	const char *data;
+	size_t len;
 	int fd;
 
 	qc_debug(hdl, "Retrieve sysinfo\n");
@@ -62,44 +38,41 @@ static int qc_sysinfo_open(struct qc_handle *hdl, char **sysinfo) {
 	*sysinfo = NULL;
 	if (qc_dbg_use_dump) {
 		qc_debug(hdl, "Read sysinfo from dump\n");
-		if (asprintf(&fname, "%s/sysinfo", qc_dbg_use_dump) == -1) {
-			qc_debug(hdl, "Error: Mem alloc failed, cannot open dump\n");
-			goto out_early;
-		}
-		if (stat(fname, &buf)) {
-			qc_debug(hdl, "Error: Failed to stat file '%s'\n", fname);
-			goto out_early;
-		}
-		sysinfo_sz = buf.st_size + 1;
-	} else {
-		qc_debug(hdl, "Read sysinfo from /proc/sysinfo\n");
-		sysinfo_sz = 4096;
+		// parsers work on copies, so we can use the mapped data as is
+		if (qc_dump_map(hdl, QC_DUMP_SEC_SYSINFO, "sysinfo", &data, &len))
+			qc_debug(hdl, "Error: Failed to read sysinfo from dump\n");
+		*sysinfo = (char *)data;
+		goto out_early;
 	}
+	qc_debug(hdl, "Read sysinfo from /proc/sysinfo\n");
 
 	for (lrc = sysinfo_sz; lrc >= sysinfo_sz; sysinfo_sz *= 2, lrc *= 2) {
-		fd = open(fname ? fname : "/proc/sysinfo", O_RDONLY);
-		if (!fd) {
-			qc_debug(hdl, "Error: Failed to open file '%s': %s\n",
-				 fname ? fname : "/proc/sysinfo", strerror(errno));
-			goto out;
+		fd = open("/proc/sysinfo", O_RDONLY);
+		if (fd == -1) {
+			qc_debug(hdl, "Error: Failed to open file '/proc/sysinfo': %s\n",
+				 strerror(errno));
+			goto out_early;
 		}
 
 		free(*sysinfo);
 		qc_debug(hdl, "Read sysinfo using buffer size %zu\n", sysinfo_sz);
 		*sysinfo = malloc(sysinfo_sz);
+		qc_stats_add(allocations, 1);
 		if (!*sysinfo) {
 			qc_debug(hdl, "Error: Failed to alloc buffer for sysinfo file\n");
 			goto out;
 		}
 		lrc = read(fd, *sysinfo, sysinfo_sz);
+		qc_stats_add(syscalls, 3);	// open, read and close
 		if (lrc == -1) {
-			qc_debug(hdl, "Error: Failed to read %s file: %s\n",
-				 fname ? fname : "/proc/sysinfo", strerror(errno));
+			qc_debug(hdl, "Error: Failed to read /proc/sysinfo file: %s\n",
+				 strerror(errno));
 			free(*sysinfo);
 			*sysinfo = NULL;
 			goto out;
 		}
 		(*sysinfo)[lrc] = '\0';
+		qc_stats_add(bytes_read, lrc);
 		close(fd);
 	}
 	goto out_early;
@@ -108,13 +81,17 @@ out:
 	close(fd);
 
 out_early:
-	free(fname);
 	qc_debug(hdl, "Done reading sysinfo, sysinfo=%p\n", *sysinfo);
 	qc_debug_indent_dec();
 
 	return *sysinfo == NULL;
 }
 
+static void qc_sysinfo_close(struct qc_handle *hdl, char *sysinfo) {
+	if (!qc_dump_owns(sysinfo))
+		free(sysinfo);
+}
+
 static int qc_sysinfo_lgm_check(struct qc_handle *hdl, const char *sysinfo) {
 	char *lsysinfo = NULL;
 	int rc = 0;
@@ -122,6 +99,10 @@ static int qc_sysinfo_lgm_check(struct qc_handle *hdl, const char *sysinfo) {
 	// Live Guest Migration check: If we were migrated, /proc/sysinfo will have changed
 	qc_debug(hdl, "Run LGM check\n");
 	qc_debug_indent_inc();
+	if (qc_dbg_use_dump) {
+		qc_debug(hdl, "Running on a dump, skipping\n");
+		goto out;
+	}
 	if (qc_sysinfo_open(hdl, &lsysinfo)) {
 		qc_debug(hdl, "Error: Failed to open /proc/sysinfo\n");
 		rc = -1;
@@ -137,15 +118,11 @@ static int qc_sysinfo_lgm_check(struct qc_handle *hdl, const char *sysinfo) {
 
 out:
 	qc_debug_indent_dec();
-	free(lsysinfo);
+	qc_sysinfo_close(hdl, lsysinfo);
 
 	return rc;
 }
 
-static void qc_sysinfo_close(struct qc_handle *hdl, char *sysinfo) {
-	free(sysinfo);
-}
-
 /* Whenever we're using strtok_r() to parse sysinfo, we're messing up the string, since
    strtok_r() will insert '\0's, so this function will create a fresh copy to work on. */
 static char *qc_copy_sysinfo(struct qc_handle *hdl, char *sysinfo) {
@@ -464,4 +441,5 @@ struct qc_data_src sysinfo = {qc_sysinfo_open,
 			      qc_sysinfo_dump,
 			      qc_sysinfo_close,
 			      qc_sysinfo_lgm_check,
-			      NULL};
+			      NULL,
+			      QC_PHASE_SYSINFO_OPEN};
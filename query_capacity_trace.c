@@ -0,0 +1,450 @@
+/* Copyright IBM Corp. 2026 */
+
+#include <stdarg.h>
+#include <signal.h>
+
+#include "query_capacity_int.h"
+
+
+/* Binary trace ring: Records hold the format string of a log message, plus its arguments in binary
+   form, and are only formatted when the ring is written out. Writers reserve a record by atomically
+   incrementing the position, and mark it complete by setting its sequence number to position + 1,
+   so the ring can be written out anytime without stopping writers. */
+#define QC_TRACE_ARGS		10
+#define QC_TRACE_STRLEN		96
+#define QC_TRACE_DEFAULT	1024
+
+struct qc_trace_rec {
+	unsigned long		 seq;		// position + 1 once complete, 0 while being written
+	unsigned long long	 ts;		// see qc_stats_now()
+	const char		*fmt;		// event id: format string of the message
+	const void		*hdl;
+	int			 indent;
+	int			 nargs;
+	union {
+		long long	 i;
+		double		 f;
+		const void	*p;
+		unsigned int	 s;		// offset in 'strs'
+	}			 args[QC_TRACE_ARGS];
+	char			 strs[QC_TRACE_STRLEN];
+};
+
+int qc_trace_enabled;
+static struct qc_trace_rec *qc_trace_ring;
+static unsigned long qc_trace_mask;
+static unsigned long qc_trace_pos;
+static unsigned long qc_trace_flushed;	// position up to which the ring was written to the log file
+static long long qc_trace_wall_offset;	// offset of qc_stats_now() to the wall clock in seconds
+static int qc_trace_signal;
+
+// Returns the length modifier 'spec' points at, and advances 'spec' beyond it
+static int qc_trace_length(const char **spec) {
+	const char *p = *spec;
+
+	switch (*p) {
+	case 'h': *spec += (p[1] == 'h') ? 2 : 1; return 'h';
+	case 'l': *spec += (p[1] == 'l') ? 2 : 1; return p[1] == 'l' ? 'L' : 'l';
+	case 'q':
+	case 'L': *spec += 1; return 'L';
+	case 'j':
+	case 'z':
+	case 't': *spec += 1; return *p;
+	default: return 0;
+	}
+}
+
+/* Skips flags, field width and precision of the conversion that 'p' points at, past the '%'.
+   Returns the precision in 'prec' if specified literally, or -1 otherwise. */
+static const char *qc_trace_skip_spec(const char *p, int *width_arg, int *prec_arg, int *has_prec, int *prec) {
+	*width_arg = *prec_arg = *has_prec = 0;
+	*prec = -1;
+	while (strchr("-+ #0'", *p) && *p)
+		++p;
+	if (*p == '*') {
+		*width_arg = 1;
+		++p;
+	} else
+		while (*p >= '0' && *p <= '9')
+			++p;
+	if (*p == '.') {
+		*has_prec = 1;
+		if (*++p == '*') {
+			*prec_arg = 1;
+			++p;
+		} else
+			for (*prec = 0; *p >= '0' && *p <= '9'; ++p)
+				*prec = *prec * 10 + *p - '0';
+	}
+
+	return p;
+}
+
+void qc_trace_log(const void *hdl, const char *fmt, ...) {
+	int width_arg, prec_arg, has_prec, len, prec, n = 0;
+	unsigned long pos, strs = 0;
+	struct qc_trace_rec *rec;
+	const char *p, *s;
+	va_list ap;
+
+	pos = __atomic_fetch_add(&qc_trace_pos, 1, __ATOMIC_RELAXED);
+	rec = &qc_trace_ring[pos & qc_trace_mask];
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	rec->ts = qc_stats_now();
+	rec->fmt = fmt;
+	rec->hdl = hdl;
+	rec->indent = qc_dbg_indent;
+
+	va_start(ap, fmt);
+	for (p = fmt; (p = strchr(p, '%')) != NULL && n < QC_TRACE_ARGS; ) {
+		if (*++p == '%') {
+			++p;
+			continue;
+		}
+		p = qc_trace_skip_spec(p, &width_arg, &prec_arg, &has_prec, &prec);
+		if (width_arg)
+			rec->args[n++].i = va_arg(ap, int);
+		if (prec_arg && n < QC_TRACE_ARGS)
+			prec = rec->args[n++].i = va_arg(ap, int);
+		if (n >= QC_TRACE_ARGS)
+			break;
+		len = qc_trace_length(&p);
+		switch (*p++) {
+		case 'd':
+		case 'i':
+		case 'c':
+			switch (len) {
+			case 'l': rec->args[n++].i = va_arg(ap, long); break;
+			case 'L': rec->args[n++].i = va_arg(ap, long long); break;
+			case 'j': rec->args[n++].i = va_arg(ap, intmax_t); break;
+			case 'z': rec->args[n++].i = va_arg(ap, ssize_t); break;
+			case 't': rec->args[n++].i = va_arg(ap, ptrdiff_t); break;
+			default: rec->args[n++].i = va_arg(ap, int); break;
+			}
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			switch (len) {
+			case 'l': rec->args[n++].i = va_arg(ap, unsigned long); break;
+			case 'L': rec->args[n++].i = va_arg(ap, unsigned long long); break;
+			case 'j': rec->args[n++].i = va_arg(ap, uintmax_t); break;
+			case 'z': rec->args[n++].i = va_arg(ap, size_t); break;
+			case 't': rec->args[n++].i = va_arg(ap, ptrdiff_t); break;
+			default: rec->args[n++].i = va_arg(ap, unsigned int); break;
+			}
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (len == 'L')
+				rec->args[n++].f = va_arg(ap, long double);
+			else
+				rec->args[n++].f = va_arg(ap, double);
+			break;
+		case 's':
+			// copy strings, as they might be gone by the time the ring is written out
+			s = va_arg(ap, const char *);
+			if (!s)
+				s = "(null)";
+			len = strnlen(s, prec >= 0 ? prec : QC_TRACE_STRLEN);
+			if (len >= (int)(QC_TRACE_STRLEN - strs))
+				len = QC_TRACE_STRLEN - strs - 1;
+			memcpy(rec->strs + strs, s, len);
+			rec->strs[strs + len] = '\0';
+			rec->args[n++].s = strs;
+			strs += len + (strs + len < QC_TRACE_STRLEN - 1);
+			break;
+		case 'p':
+			rec->args[n++].p = va_arg(ap, void *);
+			break;
+		default:
+			// unsupported conversion: we cannot tell the size of the argument, hence stop here
+			goto out;
+		}
+	}
+out:
+	va_end(ap);
+	rec->nargs = n;
+	__atomic_store_n(&rec->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+// Appends the result of snprintf() to 'buf', truncating if necessary
+#define qc_trace_append(buf, size, off, ...)	do { \
+	if ((off) < (size)) { \
+		int _rc = snprintf((buf) + (off), (size) - (off), ##__VA_ARGS__); \
+		if (_rc > 0) \
+			(off) += _rc; \
+	} } while (0)
+
+// Formats record 'rec' into 'buf', returns the length
+static int qc_trace_format(const struct qc_trace_rec *rec, char *buf, int size) {
+	int width_arg, prec_arg, has_prec, prec, n = 0, off = 0;
+	char spec[32], *q;
+	const char *p, *start;
+	struct tm tm;
+	time_t t;
+
+	t = rec->ts / 1000000000ULL + qc_trace_wall_offset;
+	localtime_r(&t, &tm);
+	qc_trace_append(buf, size, off, "%02d/%02d,%02d:%02d:%02d.%06llu,%-10p: %*s", tm.tm_mon + 1, tm.tm_mday,
+			tm.tm_hour, tm.tm_min, tm.tm_sec, rec->ts % 1000000000ULL / 1000, rec->hdl, rec->indent, "");
+	for (p = rec->fmt; *p && off < size; ) {
+		if (*p != '%' || p[1] == '%') {
+			buf[off++] = *p;
+			p += (*p == '%') ? 2 : 1;
+			continue;
+		}
+		start = p;
+		p = qc_trace_skip_spec(p + 1, &width_arg, &prec_arg, &has_prec, &prec);
+		qc_trace_length(&p);
+		if (!*p || n + width_arg + prec_arg >= rec->nargs || p - start + 1 >= (long)sizeof(spec) - 24) {
+			qc_trace_append(buf, size, off, "%s", start);
+			break;
+		}
+		// rebuild the conversion without length modifier and with '*' resolved
+		q = spec;
+		*q++ = '%';
+		for (++start; strchr("-+ #0'", *start) && *start; )
+			*q++ = *start++;
+		if (width_arg) {
+			q += sprintf(q, "%d", (int)rec->args[n++].i);
+			++start;
+		} else
+			while (*start >= '0' && *start <= '9')
+				*q++ = *start++;
+		if (has_prec) {
+			*q++ = *start++;
+			if (prec_arg) {
+				q += sprintf(q, "%d", (int)rec->args[n++].i);
+				++start;
+			} else
+				while (*start >= '0' && *start <= '9')
+					*q++ = *start++;
+		}
+		switch (*p) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			*q++ = 'l';
+			*q++ = 'l';
+			*q++ = *p;
+			*q = '\0';
+			qc_trace_append(buf, size, off, spec, rec->args[n].i);
+			break;
+		case 'c':
+			*q++ = 'c';
+			*q = '\0';
+			qc_trace_append(buf, size, off, spec, (int)rec->args[n].i);
+			break;
+		case 's':
+			*q++ = 's';
+			*q = '\0';
+			qc_trace_append(buf, size, off, spec, rec->strs + rec->args[n].s);
+			break;
+		case 'p':
+			*q++ = 'p';
+			*q = '\0';
+			qc_trace_append(buf, size, off, spec, rec->args[n].p);
+			break;
+		default:
+			*q++ = *p;
+			*q = '\0';
+			qc_trace_append(buf, size, off, spec, rec->args[n].f);
+			break;
+		}
+		++n;
+		++p;
+	}
+	if (off >= size) {
+		off = size - 1;
+		buf[off - 1] = '\n';
+	}
+
+	return off;
+}
+
+// Appends up to 'len' characters of 's' to 'buf', truncating if necessary
+static void qc_trace_raw_str(char *buf, int size, int *off, const char *s, int len) {
+	while (len-- > 0 && *s && *off < size)
+		buf[(*off)++] = *s++;
+}
+
+// Appends 'v' in 'base' with at least 'digits' digits, preceded by a '-' if 'neg' is set
+static void qc_trace_raw_num(char *buf, int size, int *off, unsigned long long v, int base, int digits, int neg) {
+	char tmp[24];
+	int i = sizeof(tmp);
+
+	do {
+		tmp[--i] = "0123456789abcdef"[v % base];
+		v /= base;
+	} while ((v || (int)sizeof(tmp) - i < digits) && i > 1);
+	if (neg)
+		tmp[--i] = '-';
+	qc_trace_raw_str(buf, size, off, tmp + i, sizeof(tmp) - i);
+}
+
+/* Formats record 'rec' into 'buf' like qc_trace_format(), but using async-signal-safe means only: The timestamp is
+   in seconds since the epoch, flags, field widths and precisions are ignored, and floating point values are
+   truncated to integers. Returns the length. */
+static int qc_trace_format_raw(const struct qc_trace_rec *rec, char *buf, int size) {
+	int width_arg, prec_arg, has_prec, prec, i, n = 0, off = 0;
+	unsigned long long t = rec->ts + qc_trace_wall_offset * 1000000000ULL;
+	const char *p, *start;
+	long long v;
+
+	qc_trace_raw_num(buf, size, &off, t / 1000000000ULL, 10, 1, 0);
+	qc_trace_raw_str(buf, size, &off, ".", 1);
+	qc_trace_raw_num(buf, size, &off, t % 1000000000ULL / 1000, 10, 6, 0);
+	qc_trace_raw_str(buf, size, &off, ",0x", 3);
+	qc_trace_raw_num(buf, size, &off, (unsigned long)rec->hdl, 16, 1, 0);
+	qc_trace_raw_str(buf, size, &off, ": ", 2);
+	for (i = 0; i < rec->indent; ++i)
+		qc_trace_raw_str(buf, size, &off, " ", 1);
+	for (p = rec->fmt; *p && off < size; ) {
+		if (*p != '%' || p[1] == '%') {
+			buf[off++] = *p;
+			p += (*p == '%') ? 2 : 1;
+			continue;
+		}
+		start = p;
+		p = qc_trace_skip_spec(p + 1, &width_arg, &prec_arg, &has_prec, &prec);
+		qc_trace_length(&p);
+		n += width_arg + prec_arg;
+		if (!*p || n >= rec->nargs) {
+			qc_trace_raw_str(buf, size, &off, start, size);
+			break;
+		}
+		switch (*p) {
+		case 'd':
+		case 'i':
+			v = rec->args[n].i;
+			qc_trace_raw_num(buf, size, &off, v < 0 ? -(unsigned long long)v : (unsigned long long)v, 10, 1, v < 0);
+			break;
+		case 'u':
+			qc_trace_raw_num(buf, size, &off, rec->args[n].i, 10, 1, 0);
+			break;
+		case 'o':
+			qc_trace_raw_num(buf, size, &off, rec->args[n].i, 8, 1, 0);
+			break;
+		case 'x':
+		case 'X':
+			qc_trace_raw_num(buf, size, &off, rec->args[n].i, 16, 1, 0);
+			break;
+		case 'c':
+			if (off < size)
+				buf[off++] = (char)rec->args[n].i;
+			break;
+		case 's':
+			qc_trace_raw_str(buf, size, &off, rec->strs + rec->args[n].s, QC_TRACE_STRLEN);
+			break;
+		case 'p':
+			qc_trace_raw_str(buf, size, &off, "0x", 2);
+			qc_trace_raw_num(buf, size, &off, (unsigned long)rec->args[n].p, 16, 1, 0);
+			break;
+		default:
+			v = rec->args[n].f;
+			qc_trace_raw_num(buf, size, &off, v < 0 ? -(unsigned long long)v : (unsigned long long)v, 10, 1, v < 0);
+			break;
+		}
+		++n;
+		++p;
+	}
+	if (off >= size) {
+		off = size - 1;
+		buf[off - 1] = '\n';
+	}
+
+	return off;
+}
+
+/* Writes all records from position 'from' on to 'fd', formatted by 'format'. Returns the number of records
+   written. */
+static int qc_trace_write(int fd, unsigned long from, int (*format)(const struct qc_trace_rec *, char *, int)) {
+	unsigned long pos, end = __atomic_load_n(&qc_trace_pos, __ATOMIC_ACQUIRE);
+	struct qc_trace_rec rec;
+	int len, num = 0;
+	char buf[512];
+
+	if (end - from > qc_trace_mask + 1)
+		from = end - qc_trace_mask - 1;
+	for (pos = from; pos != end; ++pos) {
+		// copy the record and verify that it wasn't overwritten in the meantime
+		if (__atomic_load_n(&qc_trace_ring[pos & qc_trace_mask].seq, __ATOMIC_ACQUIRE) != pos + 1)
+			continue;
+		memcpy(&rec, &qc_trace_ring[pos & qc_trace_mask], sizeof(rec));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&qc_trace_ring[pos & qc_trace_mask].seq, __ATOMIC_RELAXED) != pos + 1)
+			continue;
+		len = format(&rec, buf, sizeof(buf));
+		if (write(fd, buf, len) != len)
+			return -EIO;
+		++num;
+	}
+
+	return num;
+}
+
+// Must be async-signal-safe, hence no localtime_r() or snprintf() in the formatting
+static void qc_trace_signal_handler(int sig) {
+	int err = errno;
+
+	qc_trace_write(qc_dbg_file ? fileno(qc_dbg_file) : STDERR_FILENO, 0, qc_trace_format_raw);
+	errno = err;
+}
+
+/* Enables the trace ring with 'num' records, or the default size if 'num' is 1, and disables it for 'num' <=0.
+   The ring is kept once allocated, as other threads might still be writing to it. */
+int qc_trace_init(long num, int sig) {
+	struct timespec ts;
+	unsigned long size;
+
+	if (num <= 0) {
+		qc_trace_enabled = 0;
+		return 0;
+	}
+	if (!qc_trace_ring) {
+		if (num == 1)
+			num = QC_TRACE_DEFAULT;
+		for (size = 1; size < (unsigned long)num; size <<= 1);
+		if ((qc_trace_ring = calloc(size, sizeof(struct qc_trace_rec))) == NULL)
+			return -1;
+		qc_trace_mask = size - 1;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		qc_trace_wall_offset = ts.tv_sec - (long long)(qc_stats_now() / 1000000000ULL);
+	}
+	if (sig > 0 && sig != qc_trace_signal && signal(sig, qc_trace_signal_handler) != SIG_ERR)
+		qc_trace_signal = sig;
+	qc_trace_enabled = 1;
+
+	return 0;
+}
+
+// Writes all records that were not written yet to the log file, if any
+void qc_trace_flush(void) {
+	unsigned long end;
+
+	if (!qc_trace_ring || !qc_dbg_file)
+		return;
+	end = __atomic_load_n(&qc_trace_pos, __ATOMIC_ACQUIRE);
+	fflush(qc_dbg_file);
+	if (qc_trace_write(fileno(qc_dbg_file), qc_trace_flushed, qc_trace_format) >= 0)
+		qc_trace_flushed = end;
+}
+
+__attribute__ ((visibility ("default"))) int qc_trace_dump(int fd) {
+	if (!qc_trace_ring)
+		return 0;
+
+	return qc_trace_write(fd, 0, qc_trace_format);
+}
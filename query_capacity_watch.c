@@ -0,0 +1,218 @@
+/* Copyright IBM Corp. 2026 */
+
+#include <pthread.h>
+
+#include "query_capacity_int.h"
+
+
+#define QC_WATCH_QUEUE_LEN	256
+#define QC_WATCH_EVENTS_MAX	64	// events reported per poll
+
+
+struct qc_watch {
+	pthread_mutex_t	  poll_lock;	// serializes polls
+	pthread_mutex_t	  lock;		// protects the queue and 'stop'
+	pthread_cond_t	  cond;		// signals 'stop' to the polling thread
+	pthread_t	  thread;
+	int		  has_thread;
+	int		  stop;
+	unsigned int	  interval;	// in milliseconds
+	int		  mask;
+	qc_watch_callback cb;
+	void		 *arg;
+	int		  efd;
+	void		 *cfg;		// configuration as of the last poll
+	char		 *sysinfo;	// content of /proc/sysinfo as of the last poll
+	struct qc_event	  queue[QC_WATCH_QUEUE_LEN];
+	int		  head;		// index of the oldest queued event
+	int		  num;		// number of queued events
+};
+
+static void qc_watch_queue(struct qc_watch *w, struct qc_event *events, int num) {
+	unsigned long long cnt = 0;
+	int i;
+
+	pthread_mutex_lock(&w->lock);
+	for (i = 0; i < num && w->num < QC_WATCH_QUEUE_LEN; ++i, ++cnt)
+		w->queue[(w->head + w->num++) % QC_WATCH_QUEUE_LEN] = events[i];
+	pthread_mutex_unlock(&w->lock);
+	if (cnt && write(w->efd, &cnt, sizeof(cnt)) != sizeof(cnt))
+		qc_debug(w->cfg, "Error: Failed to notify eventfd %d: %s\n", w->efd, strerror(errno));
+	if (i < num)
+		qc_debug(w->cfg, "Warning: Event queue full, dropped %d event(s)\n", num - i);
+}
+
+// Reads the configuration, and reports all changes since the last call. Must be called with 'poll_lock' held.
+static int qc_watch_poll_locked(struct qc_watch *w) {
+	struct qc_event events[QC_WATCH_EVENTS_MAX];
+	struct qc_stats stats;
+	int rc, i, num = 0;
+	void *cfg;
+
+	// data in /proc/sysinfo is sufficient to detect capacity changes and migrations
+	if (!(w->mask & ~(QC_EVENT_CAPACITY | QC_EVENT_LGM)) && qc_sysinfo_changed(&w->sysinfo) == 0 && w->cfg)
+		return 0;
+	cfg = qc_open(&rc);
+	if (rc) {
+		qc_close(cfg);
+		return rc < 0 ? rc : -EAGAIN;
+	}
+	qc_debug(cfg, "Watch %p polled\n", w);
+	if (w->cfg) {
+		// qc_open() retries if a migration took place while gathering the data
+		if ((w->mask & QC_EVENT_LGM) && qc_get_stats(cfg, &stats) == 0 && stats.lgm_detections) {
+			events[0].type = QC_EVENT_LGM;
+			events[0].layer = -1;
+			events[0].attr = -1;
+			events[0].old_value = 0;
+			events[0].new_value = 0;
+			num = 1;
+		}
+		if ((i = qc_diff(w->cfg, cfg, num ? w->mask & ~QC_EVENT_LGM : w->mask, events + num,
+				 QC_WATCH_EVENTS_MAX - num)) < 0) {
+			qc_close(cfg);
+			return i;
+		}
+		if (i > QC_WATCH_EVENTS_MAX - num)
+			qc_debug(cfg, "Warning: Too many changes, dropped %d event(s)\n", i - (QC_WATCH_EVENTS_MAX - num));
+		num = i + num < QC_WATCH_EVENTS_MAX ? i + num : QC_WATCH_EVENTS_MAX;
+		qc_close(w->cfg);
+	}
+	w->cfg = cfg;
+	if (w->cb) {
+		for (i = 0; i < num; ++i)
+			w->cb(w, &events[i], w->arg);
+	}
+	if (w->efd >= 0 && num)
+		qc_watch_queue(w, events, num);
+
+	return num;
+}
+
+static void *qc_watch_thread(void *arg) {
+	struct qc_watch *w = arg;
+	struct timespec ts;
+
+	pthread_mutex_lock(&w->lock);
+	while (!w->stop) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		ts.tv_sec += w->interval / 1000;
+		ts.tv_nsec += (w->interval % 1000) * 1000000L;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000L;
+		}
+		while (!w->stop && pthread_cond_timedwait(&w->cond, &w->lock, &ts) != ETIMEDOUT);
+		if (w->stop)
+			break;
+		pthread_mutex_unlock(&w->lock);
+		// errors are transient, e.g. while a migration is in progress, so keep polling
+		pthread_mutex_lock(&w->poll_lock);
+		qc_watch_poll_locked(w);
+		pthread_mutex_unlock(&w->poll_lock);
+		pthread_mutex_lock(&w->lock);
+	}
+	pthread_mutex_unlock(&w->lock);
+
+	return NULL;
+}
+
+static void qc_watch_free(struct qc_watch *w) {
+	qc_close(w->cfg);
+	free(w->sysinfo);
+	pthread_cond_destroy(&w->cond);
+	pthread_mutex_destroy(&w->lock);
+	pthread_mutex_destroy(&w->poll_lock);
+	free(w);
+}
+
+__attribute__ ((visibility ("default"))) void *qc_watch(unsigned int interval, int mask, qc_watch_callback cb, void *arg, int efd, int *rc) {
+	pthread_condattr_t attr;
+	struct qc_watch *w;
+
+	if (!(mask & QC_EVENT_ALL) || (!cb && efd < 0)) {
+		*rc = -EINVAL;
+		return NULL;
+	}
+	if ((w = calloc(1, sizeof(*w))) == NULL) {
+		*rc = -ENOMEM;
+		return NULL;
+	}
+	pthread_mutex_init(&w->poll_lock, NULL);
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&w->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	w->interval = interval;
+	w->mask = mask & QC_EVENT_ALL;
+	w->cb = cb;
+	w->arg = arg;
+	w->efd = efd;
+	// initial read, establishing the baseline
+	if ((*rc = qc_watch_poll_locked(w)) < 0)
+		goto fail;
+	qc_debug(w->cfg, "qc_watch(interval=%u, mask=0x%x, efd=%d)\n", interval, mask, efd);
+	if (interval) {
+		if ((*rc = -pthread_create(&w->thread, NULL, qc_watch_thread, w)) != 0) {
+			qc_debug(w->cfg, "Error: Failed to create polling thread: %s\n", strerror(-*rc));
+			goto fail;
+		}
+		w->has_thread = 1;
+	}
+	qc_debug(w->cfg, "Return %p\n", w);
+
+	return w;
+
+fail:
+	qc_watch_free(w);
+
+	return NULL;
+}
+
+__attribute__ ((visibility ("default"))) int qc_watch_poll(void *watch) {
+	struct qc_watch *w = watch;
+	int rc;
+
+	if (!w)
+		return -EFAULT;
+	pthread_mutex_lock(&w->poll_lock);
+	rc = qc_watch_poll_locked(w);
+	pthread_mutex_unlock(&w->poll_lock);
+
+	return rc;
+}
+
+__attribute__ ((visibility ("default"))) int qc_watch_read(void *watch, struct qc_event *out, int max) {
+	struct qc_watch *w = watch;
+	int num;
+
+	if (!w)
+		return -EFAULT;
+	if (max < 0 || (max > 0 && !out))
+		return -EINVAL;
+	pthread_mutex_lock(&w->lock);
+	for (num = 0; num < max && w->num > 0; ++num, --w->num) {
+		out[num] = w->queue[w->head];
+		w->head = (w->head + 1) % QC_WATCH_QUEUE_LEN;
+	}
+	pthread_mutex_unlock(&w->lock);
+
+	return num;
+}
+
+__attribute__ ((visibility ("default"))) void qc_unwatch(void *watch) {
+	struct qc_watch *w = watch;
+
+	if (!w)
+		return;
+	qc_debug(w->cfg, "qc_unwatch(%p)\n", w);
+	if (w->has_thread) {
+		pthread_mutex_lock(&w->lock);
+		w->stop = 1;
+		pthread_cond_signal(&w->cond);
+		pthread_mutex_unlock(&w->lock);
+		pthread_join(w->thread, NULL);
+	}
+	qc_watch_free(w);
+}